@@ -0,0 +1,325 @@
+/*
+   Filename : BufferArena.cpp
+   Version  : 1.0
+
+   Purpose  : Sub-allocates ranges of a few large buffer objects per context.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <BufferArena.h>
+#include <algorithm>
+#include <iostream>
+
+namespace gfx
+{
+
+namespace
+{
+
+GLintptr alignUp (GLintptr value, GLsizeiptr alignment)
+{
+	return (value + alignment - 1) & ~(GLintptr)(alignment - 1);
+}
+
+bool byOffset (const BufferArena::Range *a, const BufferArena::Range *b)
+{
+	return a->buffer != b->buffer ? a->buffer < b->buffer : a->offset < b->offset;
+}
+
+}
+
+BufferArena::BufferArena (GLsizeiptr block_size, GLenum target)
+	: m_pools (true),
+	  m_block_size (block_size),
+	  m_target (target)
+{
+}
+
+BufferArena::~BufferArena (void)
+{
+	gfx::ContextBuffer <Pool>::ContextBufferIterator iter;
+	for (iter = m_pools.begin (); iter != m_pools.end (); ++iter)
+	{
+		release (iter->second);
+	}
+}
+
+BufferArena::Range *BufferArena::allocate (GLsizeiptr size, int context_id, GLsizeiptr alignment)
+{
+	std::lock_guard <std::mutex> lock (m_mutex);
+	Pool &pool = m_pools[context_id];
+
+	// First fit over the free lists.
+	Block *block = NULL;
+	GLintptr offset = 0;
+	for (size_t i = 0; i < pool.blocks.size () && !block; ++i)
+	{
+		std::map <GLintptr, GLsizeiptr> &free = pool.blocks[i]->free;
+		for (std::map <GLintptr, GLsizeiptr>::iterator iter = free.begin (); iter != free.end (); ++iter)
+		{
+			GLintptr start = alignUp (iter->first, alignment);
+			if (start + size <= iter->first + iter->second)
+			{
+				block = pool.blocks[i];
+				offset = start;
+				break;
+			}
+		}
+	}
+
+	if (!block)
+	{
+		block = createBlock (pool, std::max (m_block_size, (GLsizeiptr)alignUp (size, alignment)));
+		if (!block)
+		{
+			return NULL;
+		}
+		offset = 0;
+	}
+
+	// Split the free range around the allocation.
+	std::map <GLintptr, GLsizeiptr>::iterator iter = block->free.upper_bound (offset);
+	--iter;
+	GLintptr free_start = iter->first;
+	GLintptr free_end = iter->first + iter->second;
+	block->free.erase (iter);
+	if (offset > free_start)
+	{
+		block->free[free_start] = offset - free_start;
+	}
+	if (offset + size < free_end)
+	{
+		block->free[offset + size] = free_end - (offset + size);
+	}
+	block->used += size;
+
+	Range *range = new Range;
+	range->buffer = block->buffer;
+	range->offset = offset;
+	range->size = size;
+	range->alignment = alignment;
+	pool.ranges.push_back (range);
+	return range;
+}
+
+void BufferArena::free (Range *range, int context_id)
+{
+	if (!range)
+	{
+		return;
+	}
+
+	std::lock_guard <std::mutex> lock (m_mutex);
+	Pool &pool = m_pools[context_id];
+	std::vector <Range *>::iterator found = std::find (pool.ranges.begin (), pool.ranges.end (), range);
+	if (found == pool.ranges.end ())
+	{
+		std::cout << "BufferArena::free () - Error: Range not allocated on context " << context_id << "." << std::endl;
+		return;
+	}
+	pool.ranges.erase (found);
+
+	// Give the range back, merged with the free ranges next to it.
+	Block *block = findBlock (pool, range->buffer);
+	GLintptr start = range->offset;
+	GLintptr end = range->offset + range->size;
+	std::map <GLintptr, GLsizeiptr>::iterator next = block->free.lower_bound (start);
+	if (next != block->free.begin ())
+	{
+		std::map <GLintptr, GLsizeiptr>::iterator previous = next;
+		--previous;
+		if (previous->first + previous->second == start)
+		{
+			start = previous->first;
+			block->free.erase (previous);
+		}
+	}
+	if (next != block->free.end () && next->first == end)
+	{
+		end = next->first + next->second;
+		block->free.erase (next);
+	}
+	block->free[start] = end - start;
+	block->used -= range->size;
+	delete range;
+
+	// Keep one buffer around for the next allocations; release the others
+	// once empty.
+	if (block->used == 0 && pool.blocks.size () > 1)
+	{
+		glDeleteBuffers (1, &block->buffer);
+		pool.blocks.erase (std::find (pool.blocks.begin (), pool.blocks.end (), block));
+		delete block;
+	}
+}
+
+void BufferArena::upload (const Range &range, const void *data, int /* context_id */)
+{
+	// The range names its buffer, so there is no pool to look up.
+	glBindBuffer (m_target, range.buffer);
+	glBufferSubData (m_target, range.offset, range.size, data);
+	glBindBuffer (m_target, 0);
+}
+
+GLsizeiptr BufferArena::defragment (int context_id)
+{
+	std::lock_guard <std::mutex> lock (m_mutex);
+	Pool &pool = m_pools[context_id];
+	if (pool.blocks.size () < 2 && (pool.blocks.empty () || pool.blocks[0]->free.size () < 2))
+	{
+		// Already one buffer with at most one free range.
+		return 0;
+	}
+
+	// Lay the ranges out back to back, keeping their order.
+	std::vector <Range *> ranges (pool.ranges);
+	std::sort (ranges.begin (), ranges.end (), byOffset);
+	std::vector <GLintptr> offsets (ranges.size ());
+	GLintptr end = 0;
+	for (size_t i = 0; i < ranges.size (); ++i)
+	{
+		offsets[i] = alignUp (end, ranges[i]->alignment);
+		end = offsets[i] + ranges[i]->size;
+	}
+
+	GLsizeiptr reserved = 0;
+	for (size_t i = 0; i < pool.blocks.size (); ++i)
+	{
+		reserved += pool.blocks[i]->size;
+	}
+
+	std::vector <Block *> old_blocks;
+	old_blocks.swap (pool.blocks);
+	Block *block = createBlock (pool, std::max (m_block_size, (GLsizeiptr)end));
+	if (!block)
+	{
+		pool.blocks.swap (old_blocks);
+		return 0;
+	}
+
+	glBindBuffer (GL_COPY_WRITE_BUFFER, block->buffer);
+	for (size_t i = 0; i < ranges.size (); ++i)
+	{
+		glBindBuffer (GL_COPY_READ_BUFFER, ranges[i]->buffer);
+		glCopyBufferSubData (GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, ranges[i]->offset, offsets[i], ranges[i]->size);
+		ranges[i]->buffer = block->buffer;
+		ranges[i]->offset = offsets[i];
+	}
+	glBindBuffer (GL_COPY_READ_BUFFER, 0);
+	glBindBuffer (GL_COPY_WRITE_BUFFER, 0);
+
+	block->free.clear ();
+	if (end < block->size)
+	{
+		block->free[end] = block->size - end;
+	}
+	for (size_t i = 0; i < ranges.size (); ++i)
+	{
+		block->used += ranges[i]->size;
+	}
+
+	for (size_t i = 0; i < old_blocks.size (); ++i)
+	{
+		glDeleteBuffers (1, &old_blocks[i]->buffer);
+		delete old_blocks[i];
+	}
+
+	return reserved - block->size;
+}
+
+void BufferArena::destroyContext (int context_id)
+{
+	std::lock_guard <std::mutex> lock (m_mutex);
+
+	// Contexts sharing the buffers may still be using them.
+	if (m_pools.isLastUser (context_id))
+	{
+		release (m_pools[context_id]);
+		m_pools.remove (context_id);
+	}
+}
+
+GLsizeiptr BufferArena::getUsedBytes (int context_id) const
+{
+	std::lock_guard <std::mutex> lock (m_mutex);
+	const Pool &pool = m_pools[context_id];
+	GLsizeiptr used = 0;
+	for (size_t i = 0; i < pool.blocks.size (); ++i)
+	{
+		used += pool.blocks[i]->used;
+	}
+	return used;
+}
+
+GLsizeiptr BufferArena::getFreeBytes (int context_id) const
+{
+	std::lock_guard <std::mutex> lock (m_mutex);
+	const Pool &pool = m_pools[context_id];
+	GLsizeiptr free = 0;
+	for (size_t i = 0; i < pool.blocks.size (); ++i)
+	{
+		free += pool.blocks[i]->size - pool.blocks[i]->used;
+	}
+	return free;
+}
+
+size_t BufferArena::getBufferCount (int context_id) const
+{
+	std::lock_guard <std::mutex> lock (m_mutex);
+	return m_pools[context_id].blocks.size ();
+}
+
+BufferArena::Block *BufferArena::createBlock (Pool &pool, GLsizeiptr size)
+{
+	GLuint buffer = 0;
+	glGenBuffers (1, &buffer);
+	if (buffer == 0)
+	{
+		std::cout << "BufferArena::createBlock () - Error: Unable to generate buffer!" << std::endl;
+		return NULL;
+	}
+
+	glBindBuffer (m_target, buffer);
+	glBufferData (m_target, size, NULL, GL_STATIC_DRAW);
+	glBindBuffer (m_target, 0);
+
+	Block *block = new Block;
+	block->buffer = buffer;
+	block->size = size;
+	block->used = 0;
+	block->free[0] = size;
+	pool.blocks.push_back (block);
+	return block;
+}
+
+BufferArena::Block *BufferArena::findBlock (Pool &pool, GLuint buffer)
+{
+	for (size_t i = 0; i < pool.blocks.size (); ++i)
+	{
+		if (pool.blocks[i]->buffer == buffer)
+		{
+			return pool.blocks[i];
+		}
+	}
+	return NULL;
+}
+
+void BufferArena::release (Pool &pool)
+{
+	for (size_t i = 0; i < pool.blocks.size (); ++i)
+	{
+		glDeleteBuffers (1, &pool.blocks[i]->buffer);
+		delete pool.blocks[i];
+	}
+	for (size_t i = 0; i < pool.ranges.size (); ++i)
+	{
+		delete pool.ranges[i];
+	}
+	pool.blocks.clear ();
+	pool.ranges.clear ();
+}
+
+}
@@ -0,0 +1,142 @@
+/*
+   Filename : BufferArena.h
+   Version  : 1.0
+
+   Purpose  : Sub-allocates ranges of a few large buffer objects per context,
+              so that meshes share buffers instead of owning one each.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+#include <ContextBuffer.h>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace gfx
+{
+
+/**
+  * Arena of vertex and index data.  Each context (or share group) gets
+  * buffers of a fixed size, and allocations are first-fit ranges of their
+  * free lists.  Ranges stay owned by the arena; defragment () moves them,
+  * so read buffer and offset from the range each time it is bound.
+  */
+class BufferArena
+{
+	public:
+
+		/**
+		  * An allocation.
+		  */
+		struct Range
+		{
+			GLuint 	   buffer;		// Buffer object holding the range.
+			GLintptr   offset;		// Offset in bytes of the range in buffer.
+			GLsizeiptr size;		// Size in bytes asked for.
+			GLsizeiptr alignment;
+		};
+
+		/**
+		  * @param block_size Size in bytes of the buffers reserved.  Larger
+		  *        allocations get a buffer of their own size.
+		  * @param target Target the buffers are bound to while filled.
+		  */
+		explicit BufferArena (GLsizeiptr block_size = 16 * 1024 * 1024, GLenum target = GL_ARRAY_BUFFER);
+
+		/**
+		  * Destructor.  Deletes the buffers of every context.
+		  */
+		~BufferArena (void);
+
+		/**
+		  * Allocate a range on a context, reserving a new buffer if none has
+		  * room.  The context must be current.
+		  * @param size Size in bytes.
+		  * @param alignment Alignment in bytes of the offset, a power of two.
+		  * @return The range, or NULL if no buffer could be created.
+		  */
+		Range *allocate (GLsizeiptr size, int context_id = 0, GLsizeiptr alignment = 16);
+
+		/**
+		  * Return a range to the free list of its buffer.
+		  */
+		void free (Range *range, int context_id = 0);
+
+		/**
+		  * Copy data to a range.  The context must be current.
+		  * @param data The data, range->size bytes of it.
+		  */
+		void upload (const Range &range, const void *data, int context_id = 0);
+
+		/**
+		  * Pack every range of a context into a single buffer, copying the
+		  * data on the GPU, and delete the old buffers.  The context must be
+		  * current.
+		  * @return Bytes freed.
+		  */
+		GLsizeiptr defragment (int context_id = 0);
+
+		/**
+		  * Delete the buffers and ranges of a context.  The context must be
+		  * current.
+		  */
+		void destroyContext (int context_id);
+
+		/**
+		  * Bytes held by the ranges of a context.
+		  */
+		GLsizeiptr getUsedBytes (int context_id = 0) const;
+
+		/**
+		  * Bytes reserved on a context but not allocated, including what
+		  * alignment leaves between ranges.
+		  */
+		GLsizeiptr getFreeBytes (int context_id = 0) const;
+
+		/**
+		  * Number of buffer objects reserved on a context.
+		  */
+		size_t getBufferCount (int context_id = 0) const;
+
+	private:
+
+		BufferArena (const BufferArena &);
+		BufferArena &operator= (const BufferArena &);
+
+		/**
+		  * One buffer object and its free ranges.
+		  */
+		struct Block
+		{
+			GLuint 	   					   buffer;
+			GLsizeiptr 					   size;
+			GLsizeiptr 					   used;
+			std::map <GLintptr, GLsizeiptr> free;		// Offset to size of each free range.
+		};
+
+		/**
+		  * Everything allocated on a context, or a share group.
+		  */
+		struct Pool
+		{
+			std::vector <Block *> blocks;
+			std::vector <Range *> ranges;
+		};
+
+		Block *createBlock (Pool &pool, GLsizeiptr size);
+		Block *findBlock (Pool &pool, GLuint buffer);
+		static void release (Pool &pool);
+
+		gfx::ContextBuffer <Pool> m_pools;
+		GLsizeiptr 				  m_block_size;
+		GLenum 					  m_target;
+		mutable std::mutex 		  m_mutex;		// Contexts of a share group allocate from one pool.
+};
+
+}
@@ -15,6 +15,7 @@
 */
 
 #include <Camera.h>
+#include <Constants.h>
 #include <iostream>
 using namespace std;
 
@@ -52,8 +53,7 @@ const math::vec3f Camera::getPosition (void) const
 void Camera::apply (void) const 
 {
 	// Apply the modelview matrix.
-	glLoadMatrixf (m_view_matrix.data ());
-	glTranslatef (-m_position.x (), -m_position.y (), -m_position.z ());
+	glLoadMatrixf (getViewMatrix ().data ());
 }
 
 // Move the camera along its local axis.
@@ -83,28 +83,28 @@ void Camera::strafe (float x_distance)
 void Camera::pitch (float angle)
 {
 	//math::quatf tmp (angle, m_orientation.getXAxis (), true);
-	math::quatf tmp (angle, math::vec3f (1.0f, 0.0f, 0.0f), true);
+	math::quatf tmp (angle, math::constants::x_axis, true);
 	rotateLocal (tmp);
 }
 
 // Change the yaw of the camera (about the y-axis).
 void Camera::yaw (float angle)
 {
-	math::quatf tmp (angle, math::vec3f (0.0f, 1.0f, 0.0f), true);
+	math::quatf tmp (angle, math::constants::y_axis, true);
 	rotateWorld (tmp);
 }
 
 // Change the roll of the camera (about the z-axis).
 void Camera::roll (float angle)
 {
-	math::quatf tmp (angle, math::vec3f (0.0f, 0.0f, 1.0f), true);
+	math::quatf tmp (angle, math::constants::z_axis, true);
 	rotateLocal (tmp);
 }
 
 // Rotate about the world y axis. value is in radians.
 void Camera::turn (float angle)
 {
-	math::quatf tmp (angle, math::vec3f (0.0f, 1.0f, 0.0f), true);
+	math::quatf tmp (angle, math::constants::y_axis, true);
 	rotateWorld (tmp);
 }
 
@@ -174,32 +174,8 @@ void Camera::setPerspective (float fov, float aspect_ratio, float z_near, float
 	GLfloat left = bottom * aspect_ratio;
 	GLfloat right = top * aspect_ratio;  // End of what gluPerspective does
 
-	// Helper variables
-	GLfloat right_minus_left = 1.0f / (right - left);
-	GLfloat top_minus_bottom = 1.0f / (top - bottom);
-	GLfloat far_minus_near 	 = 1.0f / (z_far - z_near);
-	GLfloat two_times_near   = 2.0f * z_near;
-
 	// Populate the projection matrix.
-	m_projection_matrix(0, 0) = two_times_near * right_minus_left;
-	m_projection_matrix(0, 1) = 0.0f;
-	m_projection_matrix(0, 2) = 0.0f; 
-	m_projection_matrix(0, 3) = 0.0f;
-
-	m_projection_matrix(1, 0) = 0.0f;
-	m_projection_matrix(1, 1) = two_times_near * top_minus_bottom;
-	m_projection_matrix(1, 2) = 0.0f;
-	m_projection_matrix(1, 3) = 0.0f;
-
-	m_projection_matrix(2, 0) = (right + left) * right_minus_left;
-	m_projection_matrix(2, 1) = (top + bottom) * top_minus_bottom;
-	m_projection_matrix(2, 2) = -((z_far + z_near) * far_minus_near);
-	m_projection_matrix(2, 3) = -1.0f;
-
-	m_projection_matrix(3, 0) = 0.0f;
-	m_projection_matrix(3, 1) = 0.0f;
-	m_projection_matrix(3, 2) = (-two_times_near * z_far) * far_minus_near;
-	m_projection_matrix(3, 3) = 0.0f;
+	m_projection_matrix = math::frustum (left, right, bottom, top, z_near, z_far);
 
 	// Apply the projection matrix.
 	glMatrixMode (GL_PROJECTION);	
@@ -218,6 +194,30 @@ math::Matrixf Camera::getModelViewMatrix (void)
 	return m_view_matrix;
 }
 
+// Get the full view matrix, the orientation followed by the translation to the camera position.
+math::Matrixf Camera::getViewMatrix (void) const
+{
+	math::Matrixf translation (1.0f, 0.0f, 0.0f, -m_position.x (),
+	                           0.0f, 1.0f, 0.0f, -m_position.y (),
+	                           0.0f, 0.0f, 1.0f, -m_position.z (),
+	                           0.0f, 0.0f, 0.0f, 1.0f);
+
+	// Matrix::operator* multiplies the stored arrays, so this is view * translation in OpenGL terms.
+	return translation * m_view_matrix;
+}
+
+// Get the inverse of the full view matrix (camera to world).
+math::Matrixf Camera::getInverseViewMatrix (void) const
+{
+	return math::affineInverse (getViewMatrix ());
+}
+
+// Get the combined projection and view matrix.
+math::Matrixf Camera::getViewProjectionMatrix (void) const
+{
+	return getViewMatrix () * m_projection_matrix;
+}
+
 }
 
 
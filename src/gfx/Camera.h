@@ -141,6 +141,22 @@ class Camera
 		  */
 		math::Matrixf getProjectionMatrix (void);
 
+		/**
+		  * Get the view matrix including the translation to the camera position.
+		  */
+		math::Matrixf getViewMatrix (void) const;
+
+		/**
+		  * Get the inverse of the view matrix (camera space to world space).
+		  */
+		math::Matrixf getInverseViewMatrix (void) const;
+
+		/**
+		  * Get the projection matrix multiplied by the view matrix, ready for
+		  * extracting frustum planes.
+		  */
+		math::Matrixf getViewProjectionMatrix (void) const;
+
 	protected:
 
 		/**
@@ -1,11 +1,165 @@
 #pragma once
 
+#include <atomic>
 #include <map>
+#include <new>
 #include <pthread.h>
+#include <stddef.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace gfx
 {
 
+/**
+ * Groups of contexts created to share OpenGL objects with each other (a
+ * share list passed to glXCreateContext, or the same GPU context reused by
+ * several windows).
+ *
+ * Joining a group is how a context opts in to sharing: a ContextBuffer
+ * created as shared stores one entry per group instead of one per context,
+ * so the object in it is created and uploaded once and every context of
+ * the group resolves to it.  Contexts outside any group keep their own
+ * entries.
+ */
+class ShareGroup
+{
+public:
+	/**
+	 * Put a context in a group.  Must be called before anything is created
+	 * on the context.
+	 * @param context_id Context to add.
+	 * @param group Any non-negative number naming the group.
+	 */
+	static inline void join(int context_id, int group);
+
+	/**
+	 * Take a context out of its group, once its resources are destroyed.
+	 */
+	static inline void leave(int context_id);
+
+	/**
+	 * Returns true when context_id has joined a group.
+	 */
+	static inline bool isMember(int context_id);
+
+	/**
+	 * Key a shared ContextBuffer stores the data of context_id under: the
+	 * group's key (negative, so it never collides with a context id) or
+	 * context_id itself.
+	 */
+	static inline int key(int context_id);
+
+	/**
+	 * Returns true unless other contexts of context_id's group are still
+	 * using the shared objects.
+	 */
+	static inline bool isLastMember(int context_id);
+
+private:
+	// Contexts below this id are also looked up without the mutex.
+	static const int FAST_CONTEXTS = 64;
+
+	struct Registry
+	{
+		Registry()
+		{
+			pthread_mutex_init(&mutex, 0);
+			for (int i = 0; i < FAST_CONTEXTS; ++i)
+			{
+				fast[i].store(0, std::memory_order_relaxed);
+			}
+		}
+		~Registry() { pthread_mutex_destroy(&mutex); }
+
+		pthread_mutex_t mutex;
+		std::map<int, int> groups;	// Context id to group.
+		std::map<int, int> members;	// Group to number of contexts in it.
+		std::atomic<int> fast[FAST_CONTEXTS];	// Group + 1 of the first contexts, or 0.
+	};
+
+	static inline Registry& registry();
+};
+
+inline ShareGroup::Registry& ShareGroup::registry()
+{
+	static Registry instance;
+	return instance;
+}
+
+inline void ShareGroup::join(int context_id, int group)
+{
+	Registry& r = registry();
+	pthread_mutex_lock(&r.mutex);
+	std::map<int, int>::iterator iter = r.groups.find(context_id);
+	if (iter == r.groups.end())
+	{
+		r.groups[context_id] = group;
+		++r.members[group];
+		if (context_id >= 0 && context_id < FAST_CONTEXTS)
+		{
+			r.fast[context_id].store(group + 1, std::memory_order_release);
+		}
+	}
+	pthread_mutex_unlock(&r.mutex);
+}
+
+inline void ShareGroup::leave(int context_id)
+{
+	Registry& r = registry();
+	pthread_mutex_lock(&r.mutex);
+	std::map<int, int>::iterator iter = r.groups.find(context_id);
+	if (iter != r.groups.end())
+	{
+		if (--r.members[iter->second] == 0)
+		{
+			r.members.erase(iter->second);
+		}
+		r.groups.erase(iter);
+		if (context_id >= 0 && context_id < FAST_CONTEXTS)
+		{
+			r.fast[context_id].store(0, std::memory_order_release);
+		}
+	}
+	pthread_mutex_unlock(&r.mutex);
+}
+
+inline bool ShareGroup::isMember(int context_id)
+{
+	return key(context_id) != context_id;
+}
+
+inline int ShareGroup::key(int context_id)
+{
+	// Shared buffers resolve every lookup through here, so the usual
+	// context ids must not take the mutex.
+	Registry& r = registry();
+	if (context_id >= 0 && context_id < FAST_CONTEXTS)
+	{
+		int group = r.fast[context_id].load(std::memory_order_acquire);
+		return group ? -group : context_id;
+	}
+
+	pthread_mutex_lock(&r.mutex);
+	std::map<int, int>::const_iterator iter = r.groups.find(context_id);
+	int result = iter != r.groups.end() ? -1 - iter->second : context_id;
+	pthread_mutex_unlock(&r.mutex);
+
+	return result;
+}
+
+inline bool ShareGroup::isLastMember(int context_id)
+{
+	Registry& r = registry();
+	pthread_mutex_lock(&r.mutex);
+	std::map<int, int>::const_iterator iter = r.groups.find(context_id);
+	bool result = iter == r.groups.end() || r.members[iter->second] <= 1;
+	pthread_mutex_unlock(&r.mutex);
+
+	return result;
+}
+
 /**
  * Thread-safe buffer for data associated with multiple rendering contexts.
  *
@@ -17,14 +171,33 @@ namespace gfx
  * The template parameter T defines the type of data stored per context ID.
  * This can be anything from a built-in type (i.e. int, float) to a struct
  * or class.
+ *
+ * Entries live in slots indexed by context ID, in chunks that double in
+ * size and are never moved, so a reference stays valid until its entry is
+ * removed.  Finding an existing entry is wait-free; only creating or
+ * removing one takes the mutex.  Chunks and entries are published with
+ * release stores, so a reader either sees an entry completely constructed
+ * or not at all.  IDs too far from zero for the slots (beyond +/-16K) go
+ * to a map behind the mutex instead.
  */
 template <class T>
 class ContextBuffer
 {
 public:
-	ContextBuffer();
+	typedef std::pair<const int, T> value_type;
+
+	/**
+	 * @param shared Resolve contexts through their ShareGroup.  Only for
+	 *        data the contexts of a group can share, such as the names of
+	 *        textures and buffer objects; not for framebuffer objects or
+	 *        per-window state.
+	 */
+	explicit ContextBuffer(bool shared = false);
+	ContextBuffer(const ContextBuffer& other);
 	~ContextBuffer();
 
+	ContextBuffer& operator=(const ContextBuffer& other);
+
 	/**
 	 * Return a reference to context data corresponding to the context ID.
 	 * If the ID does not exist, a new context is created and a reference
@@ -35,7 +208,8 @@ public:
 	/**
 	 * const version of operator[].
 	 * The same functionality is provided, except that a new context is
-	 * NOT created when the search fails.
+	 * NOT created when the search fails; a value initialized T is returned
+	 * instead.
 	 */
 	inline const T& operator[](int id) const;
 
@@ -45,25 +219,138 @@ public:
 	inline const size_t size (void);
 
 	/**
-	  * Remove an element from the context buffer.
+	  * Remove an element from the context buffer.  In a shared buffer this
+	  * removes the entry of id's group.
 	  */
 	inline void remove (int id);
 
+	/**
+	  * Returns true when the entry of id is no longer used by any other
+	  * context, so the object in it may be deleted when id is destroyed.
+	  * Always true for buffers that are not shared.
+	  */
+	inline bool isLastUser (int id) const;
+
+	bool isShared (void) const { return _shared; }
+
+	/**
+	  * Returns true when there is an entry for id.
+	  */
+	inline bool contains (int id) const;
+
 	/**
 	  * Clear the context buffer.
 	  */
 	inline void clear (void);
 
-	// ContextBuffer iterator.
-	typedef typename std::map <int, T>::iterator 	   ContextBufferIterator;
-	typedef typename std::map <int, T>::const_iterator ConstContextBufferIterator;
+private:
+	// Slot i of chunk c holds index FIRST_CHUNK * (2^c - 1) + i, and chunk c
+	// has FIRST_CHUNK * 2^c slots.
+	static const size_t FIRST_CHUNK = 8;
+	static const unsigned int CHUNKS = 12;
+
+	struct Slot
+	{
+		Slot() : present(false) {}
+
+		value_type& value() { return *reinterpret_cast<value_type*>(&storage); }
+
+		std::atomic<bool> present;
+		typename std::aligned_storage<sizeof(value_type), std::alignment_of<value_type>::value>::type storage;
+	};
+
+public:
+	/**
+	  * Iterates over the entries in order of slot.  Entries created while
+	  * iterating may or may not be visited.
+	  */
+	template <class Buffer, class Value, class MapIterator>
+	class Iterator
+	{
+	public:
+		Iterator() : _buffer(NULL), _chunk(CHUNKS), _slot(0) {}
+
+		Value& operator*() const { return *operator->(); }
+		Value* operator->() const
+		{
+			return _chunk < CHUNKS ? &_buffer->slot(_chunk, _slot).value() : &*_overflow;
+		}
+
+		Iterator& operator++()
+		{
+			if (_chunk < CHUNKS)
+			{
+				++_slot;
+				skip();
+			}
+			else
+			{
+				++_overflow;
+			}
+			return *this;
+		}
+
+		bool operator==(const Iterator& other) const
+		{
+			return _chunk == other._chunk && _slot == other._slot && (_chunk < CHUNKS || _overflow == other._overflow);
+		}
+		bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+	private:
+		friend class ContextBuffer;
+
+		// First entry.
+		explicit Iterator(Buffer* buffer)
+			: _buffer(buffer), _chunk(0), _slot(0)
+		{
+			skip();
+		}
+
+		// End.
+		Iterator(Buffer* buffer, MapIterator end)
+			: _buffer(buffer), _chunk(CHUNKS), _slot(0), _overflow(end)
+		{
+		}
+
+		// Move to the first present entry at or after the current slot, and
+		// on to the overflow map after the last chunk.
+		void skip()
+		{
+			while (_chunk < CHUNKS)
+			{
+				Slot* chunk = _buffer->_chunks[_chunk].load(std::memory_order_acquire);
+				if (chunk)
+				{
+					for (; _slot < (FIRST_CHUNK << _chunk); ++_slot)
+					{
+						if (chunk[_slot].present.load(std::memory_order_acquire))
+						{
+							return;
+						}
+					}
+				}
+				++_chunk;
+				_slot = 0;
+			}
+			_overflow = _buffer->_overflow.begin();
+		}
+
+		Buffer* _buffer;
+		unsigned int _chunk;
+		size_t _slot;
+		MapIterator _overflow;
+	};
+
+	// ContextBuffer iterator.  Entries are (context ID, data) pairs.
+	typedef Iterator<ContextBuffer, value_type, typename std::map<int, T>::iterator> ContextBufferIterator;
+	typedef Iterator<const ContextBuffer, const value_type, typename std::map<int, T>::const_iterator> ConstContextBufferIterator;
 
 	/**
 	  * Get the beginning iterator to the data in the context buffer.
 	  */
 	ContextBufferIterator begin (void)
 	{
-		return _data.begin ();
+		return ContextBufferIterator (this);
 	}
 
 	/**
@@ -71,41 +358,208 @@ public:
 	  */
 	ContextBufferIterator end (void)
 	{
-		return _data.end ();
+		return ContextBufferIterator (this, _overflow.end ());
 	}
 
 	ConstContextBufferIterator begin (void) const
 	{
-		return _data.begin ();
+		return ConstContextBufferIterator (this);
 	}
 
 	ConstContextBufferIterator end (void) const
 	{
-		return _data.end ();
+		return ConstContextBufferIterator (this, _overflow.end ());
 	}
 
 private:
+	inline int key(int id) const { return _shared ? ShareGroup::key(id) : id; }
+
+	/**
+	 * Find the chunk and slot of a key, or return false when the key
+	 * belongs in the overflow map.  Negative keys (share groups) are
+	 * interleaved with the others: 0, -1, 1, -2, 2...
+	 */
+	static inline bool locate(int key, unsigned int& chunk, size_t& slot)
+	{
+		size_t index = key >= 0 ? 2 * (size_t)key : 2 * (size_t)(-(key + 1)) + 1;
+		size_t blocks = index / FIRST_CHUNK + 1;
+		chunk = 0;
+		while (blocks >>= 1)
+		{
+			++chunk;
+		}
+		slot = index - FIRST_CHUNK * (((size_t)1 << chunk) - 1);
+		return chunk < CHUNKS;
+	}
+
+	Slot& slot(unsigned int chunk, size_t slot) const
+	{
+		return _chunks[chunk].load(std::memory_order_acquire)[slot];
+	}
+
+	/**
+	 * Look up the data of key; NULL when it has no entry.  Wait-free
+	 * unless the key is in the overflow map.
+	 */
+	inline T* find(int key) const;
+
+	/**
+	 * Find or create the entry of key.  Called with the mutex held.
+	 */
+	inline T& insert(int key);
+
+	/**
+	 * Destroy every entry and free the chunks.  Called with the mutex held.
+	 */
+	inline void destroy();
+
 	mutable pthread_mutex_t _mutex;
-	std::map<int, T> _data;
+	mutable std::atomic<Slot*> _chunks[CHUNKS];
+	mutable std::map<int, T> _overflow;
+	std::atomic<size_t> _size;
+	bool _shared;
 };
 
 template <class T>
-ContextBuffer<T>::ContextBuffer()
+ContextBuffer<T>::ContextBuffer(bool shared)
+	: _size(0), _shared(shared)
+{
+	pthread_mutex_init(&_mutex, 0);
+	for (unsigned int i = 0; i < CHUNKS; ++i)
+	{
+		_chunks[i].store(NULL, std::memory_order_relaxed);
+	}
+}
+
+template <class T>
+ContextBuffer<T>::ContextBuffer(const ContextBuffer& other)
+	: _size(0), _shared(other._shared)
 {
 	pthread_mutex_init(&_mutex, 0);
+	for (unsigned int i = 0; i < CHUNKS; ++i)
+	{
+		_chunks[i].store(NULL, std::memory_order_relaxed);
+	}
+	*this = other;
 }
 
 template <class T>
 ContextBuffer<T>::~ContextBuffer()
 {
+	destroy();
 	pthread_mutex_destroy(&_mutex);
 }
 
+template <class T>
+ContextBuffer<T>& ContextBuffer<T>::operator=(const ContextBuffer& other)
+{
+	if (this != &other)
+	{
+		pthread_mutex_lock(&_mutex);
+		pthread_mutex_lock(&other._mutex);
+		destroy();
+		_shared = other._shared;
+		for (ConstContextBufferIterator iter = other.begin(); iter != other.end(); ++iter)
+		{
+			insert(iter->first) = iter->second;
+		}
+		pthread_mutex_unlock(&other._mutex);
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	return *this;
+}
+
+template <class T>
+inline T* ContextBuffer<T>::find(int key) const
+{
+	unsigned int chunk;
+	size_t index;
+	if (!locate(key, chunk, index))
+	{
+		pthread_mutex_lock(&_mutex);
+		typename std::map<int, T>::iterator iter = _overflow.find(key);
+		T* result = iter != _overflow.end() ? &iter->second : NULL;
+		pthread_mutex_unlock(&_mutex);
+
+		return result;
+	}
+
+	Slot* slots = _chunks[chunk].load(std::memory_order_acquire);
+	if (slots && slots[index].present.load(std::memory_order_acquire))
+	{
+		return &slots[index].value().second;
+	}
+
+	return NULL;
+}
+
+template <class T>
+inline T& ContextBuffer<T>::insert(int key)
+{
+	unsigned int chunk;
+	size_t index;
+	if (!locate(key, chunk, index))
+	{
+		size_t count = _overflow.size();
+		T& result = _overflow[key];
+		_size.fetch_add(_overflow.size() - count, std::memory_order_relaxed);
+		return result;
+	}
+
+	Slot* slots = _chunks[chunk].load(std::memory_order_relaxed);
+	if (!slots)
+	{
+		slots = new Slot[FIRST_CHUNK << chunk];
+		_chunks[chunk].store(slots, std::memory_order_release);
+	}
+
+	Slot& slot = slots[index];
+	if (!slot.present.load(std::memory_order_relaxed))
+	{
+		new (&slot.storage) value_type(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple());
+		slot.present.store(true, std::memory_order_release);
+		_size.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return slot.value().second;
+}
+
+template <class T>
+inline void ContextBuffer<T>::destroy()
+{
+	for (unsigned int i = 0; i < CHUNKS; ++i)
+	{
+		Slot* slots = _chunks[i].load(std::memory_order_relaxed);
+		if (slots)
+		{
+			for (size_t j = 0; j < (FIRST_CHUNK << i); ++j)
+			{
+				if (slots[j].present.load(std::memory_order_relaxed))
+				{
+					slots[j].value().~value_type();
+				}
+			}
+			delete [] slots;
+			_chunks[i].store(NULL, std::memory_order_relaxed);
+		}
+	}
+	_overflow.clear();
+	_size.store(0, std::memory_order_relaxed);
+}
+
 template <class T>
 inline T& ContextBuffer<T>::operator[](int id)
 {
+	int k = key(id);
+	T* data = find(k);
+	if (data)
+	{
+		return *data;
+	}
+
 	pthread_mutex_lock(&_mutex);
-	T& result = _data[id];
+	T& result = insert(k);
 	pthread_mutex_unlock(&_mutex);
 
 	return result;
@@ -114,38 +568,64 @@ inline T& ContextBuffer<T>::operator[](int id)
 template <class T>
 inline const T& ContextBuffer<T>::operator[](int id) const 
 {
-	pthread_mutex_lock(&_mutex);
-	const T& result = _data.find(id)->second;
-	pthread_mutex_unlock(&_mutex);
+	static const T empty{};
 
-	return result;
+	const T* data = find(key(id));
+	return data ? *data : empty;
 }
 
 template <class T>
 inline void ContextBuffer<T>::remove (int id)
 {
+	int k = key (id);
+	unsigned int chunk;
+	size_t index;
 	pthread_mutex_lock (&_mutex);
-	ContextBufferIterator iter = _data.find (id);
-	_data.erase (iter);
+	if (!locate (k, chunk, index))
+	{
+		if (_overflow.erase (k))
+		{
+			_size.fetch_sub (1, std::memory_order_relaxed);
+		}
+	}
+	else
+	{
+		Slot* slots = _chunks[chunk].load (std::memory_order_relaxed);
+		if (slots && slots[index].present.load (std::memory_order_relaxed))
+		{
+			slots[index].present.store (false, std::memory_order_release);
+			slots[index].value ().~value_type ();
+			_size.fetch_sub (1, std::memory_order_relaxed);
+		}
+	}
 	pthread_mutex_unlock (&_mutex);
 }
 
 
 template <class T>
-inline const size_t ContextBuffer<T>::size (void)
+inline bool ContextBuffer<T>::isLastUser (int id) const
 {
-	size_t tmp = 0;
-	pthread_mutex_lock (&_mutex);
-	tmp = _data.size ();
-	pthread_mutex_unlock (&_mutex);
+	return !_shared || ShareGroup::isLastMember (id);
+}
+
+template <class T>
+inline bool ContextBuffer<T>::contains (int id) const
+{
+	return find (key (id)) != NULL;
+}
 
-	return tmp;
+template <class T>
+inline const size_t ContextBuffer<T>::size (void)
+{
+	return _size.load (std::memory_order_relaxed);
 }
 
 template <class T>
 inline void ContextBuffer<T>::clear (void)
 {
-	_data.clear ();
+	pthread_mutex_lock (&_mutex);
+	destroy ();
+	pthread_mutex_unlock (&_mutex);
 }
 
 }
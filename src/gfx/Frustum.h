@@ -1,13 +1,25 @@
 #pragma once
 #include <stdio.h>
 #include <stdlib.h>
-#include <glew.h>
-#include <gl.h>
-#include <math/Matrix.h>
+#include <string.h>
+#include <algorithm>
+#include <GL/glew.h>
+#include <Matrix.h>
 
 namespace gfx
 {
 
+/**
+  * View frustum for culling.  The six planes are extracted from the combined
+  * projection and modelview matrices, so bounds are tested in the space the
+  * modelview matrix maps from (world space when it only holds the view).
+  *
+  * Boxes are tested as center and half extent and spheres as center and
+  * radius.  Both tests take a plane mask, one bit per plane (see Plane): on
+  * entry only the set planes are considered, and on return the planes the
+  * bounds are completely inside have been cleared.  Passing a node's mask on
+  * to its children lets whole subtrees skip the planes they cannot cross.
+  */
 class Frustum
 {
 public:
@@ -19,77 +31,256 @@ public:
 		NONE
 	};
 
+	/**
+	  * Plane bits for the masks.
+	  */
+	enum Plane
+	{
+		RIGHT_PLANE  = 1 << 0,
+		LEFT_PLANE   = 1 << 1,
+		TOP_PLANE    = 1 << 2,
+		BOTTOM_PLANE = 1 << 3,
+		FAR_PLANE    = 1 << 4,
+		NEAR_PLANE   = 1 << 5,
+		ALL_PLANES   = 0x3f
+	};
+
+	/**
+	  * Read the current OpenGL projection and modelview matrices.
+	  */
 	inline void update()
 	{
-		glGetDoublev(GL_PROJECTION_MATRIX, projection.v);
-		glGetDoublev(GL_MODELVIEW_MATRIX, modelview.v);
-		modelviewProjection = projection * modelview;
-		_planes[0] = modelviewProjection.row(3) - modelviewProjection.row(0); //Right
-		_planes[1] = modelviewProjection.row(3) + modelviewProjection.row(0); //Left
-		_planes[2] = modelviewProjection.row(3) - modelviewProjection.row(1); //Top
-		_planes[3] = modelviewProjection.row(3) + modelviewProjection.row(1); //Bottom
-		_planes[4] = modelviewProjection.row(3) - modelviewProjection.row(2); //Far
-		_planes[5] = modelviewProjection.row(3) + modelviewProjection.row(2); //Near
+		glGetFloatv(GL_PROJECTION_MATRIX, projection.data());
+		glGetFloatv(GL_MODELVIEW_MATRIX, modelview.data());
+		_extractPlanes();
+	}
+
+	/**
+	  * Use the given matrices, for instance the camera's.
+	  */
+	inline void update(const math::Matrixf &view, const math::Matrixf &proj)
+	{
+		modelview = view;
+		projection = proj;
+		_extractPlanes();
+	}
+
+	/**
+	  * Use matrices laid out as OpenGL expects them (column major), such as
+	  * cavr::gfx::getView ().v and cavr::gfx::getProjection ().v.
+	  */
+	inline void update(const float *view, const float *proj)
+	{
+		memcpy(modelview.data(), view, 16 * sizeof(float));
+		memcpy(projection.data(), proj, 16 * sizeof(float));
+		_extractPlanes();
+	}
+
+	/**
+	  * Use view * model as the modelview matrix (in OpenGL terms), so bounds
+	  * are tested in the model's own space.
+	  */
+	inline void update(const math::Matrixf &model, const math::Matrixf &view, const math::Matrixf &proj)
+	{
+		update(model * view, proj);
+	}
+
+	/**
+	  * Make this a frustum containing both a and b, such as the two eyes of a
+	  * stereo pair, so that one culling pass serves both.  Each plane takes
+	  * the average direction of the two matching planes and is pushed out
+	  * until all eight corners of both frustums are inside it.  Only the
+	  * planes and the eye (half way between the two) are set; the matrices
+	  * are a's.
+	  */
+	inline void combine(const Frustum &a, const Frustum &b)
+	{
+		math::vec3f corners[16];
+		a._corners(corners);
+		b._corners(corners + 8);
+
 		for (int i = 0; i < 6; ++i)
 		{
-			float length = sqrt(_planes[i].x() * _planes[i].x() +
-			                    _planes[i].y() * _planes[i].y() +
-								_planes[i].z() * _planes[i].z());
-			_planes[i] /= length;
+			math::vec3f normal = math::vec3f(a._planes[i].x(), a._planes[i].y(), a._planes[i].z()) +
+			                     math::vec3f(b._planes[i].x(), b._planes[i].y(), b._planes[i].z());
+			normal = math::normalize(normal);
+
+			float w = -math::dot(normal, corners[0]);
+			for (int j = 1; j < 16; ++j)
+				w = std::max(w, -math::dot(normal, corners[j]));
+			_planes[i] = math::vec4f(normal.x(), normal.y(), normal.z(), w);
 		}
+		_updatePlaneArrays();
 
-		float inv[16];
-
-		inv[0] = modelview.v[0];
-		inv[1] = modelview.v[4];
-		inv[2] = modelview.v[8];
-		inv[4] = modelview.v[1];
-		inv[5] = modelview.v[5];
-		inv[6] = modelview.v[9];
-		inv[8] = modelview.v[2];
-		inv[9] = modelview.v[6];
-		inv[10] = modelview.v[10];
-
-		inv[12] = inv[0]*-modelview.v[12]+inv[4]*-modelview.v[13]+inv[8]*-modelview.v[14];
-		inv[13] = inv[1]*-modelview.v[12]+inv[5]*-modelview.v[13]+inv[9]*-modelview.v[14];
-		inv[14] = inv[2]*-modelview.v[12]+inv[6]*-modelview.v[13]+inv[10]*-modelview.v[14];
-
-		inv[3] = 0.0f;
-		inv[7] = 0.0f;
-		inv[11] = 0.0f;
-		inv[15] = 1.0f;
-		_eyePosition = hydra::Vec3(inv[12], inv[13], inv[14]);
-	}
-
-	inline Visibility isVisible(float xmin, float xmax, float ymin, float ymax, float zmin, float zmax)
-	{
-		hydra::Vec4 points[8];
-		points[0] = hydra::Vec4(xmin, ymin, zmin, 1.0f);
-		points[1] = hydra::Vec4(xmin, ymin, zmax, 1.0f);
-		points[2] = hydra::Vec4(xmin, ymax, zmin, 1.0f);
-		points[3] = hydra::Vec4(xmin, ymax, zmax, 1.0f);
-		points[4] = hydra::Vec4(xmax, ymin, zmin, 1.0f);
-		points[5] = hydra::Vec4(xmax, ymin, zmax, 1.0f);
-		points[6] = hydra::Vec4(xmax, ymax, zmin, 1.0f);
-		points[7] = hydra::Vec4(xmax, ymax, zmax, 1.0f);
-		int planesContaining = 0;
-		for (int i = 0; i < 6; ++i)
+		projection = a.projection;
+		modelview = a.modelview;
+		modelviewProjection = a.modelviewProjection;
+		_eyePosition = (a._eyePosition + b._eyePosition) * 0.5f;
+		_near = a._near;
+		_far = a._far;
+	}
+
+	/**
+	  * Test an axis aligned box given by its center and half extent against
+	  * the planes in mask, and clear the planes the box is inside.
+	  */
+	inline Visibility isVisible(const math::vec3f &center, const math::vec3f &extent, unsigned int &mask) const
+	{
+		if (mask == 0)
+			return COMPLETE;
+
+		unsigned int outside, inside;
+		_testBox(center, extent, outside, inside);
+		return _classify(outside, inside, mask);
+	}
+
+	inline Visibility isVisible(const math::vec3f &center, const math::vec3f &extent) const
+	{
+		unsigned int mask = ALL_PLANES;
+		return isVisible(center, extent, mask);
+	}
+
+	inline Visibility isVisible(float xmin, float xmax, float ymin, float ymax, float zmin, float zmax) const
+	{
+		math::vec3f center((xmin + xmax) * 0.5f, (ymin + ymax) * 0.5f, (zmin + zmax) * 0.5f);
+		math::vec3f extent((xmax - xmin) * 0.5f, (ymax - ymin) * 0.5f, (zmax - zmin) * 0.5f);
+		return isVisible(center, extent);
+	}
+
+	/**
+	  * Test a sphere against the planes in mask, and clear the planes the
+	  * sphere is inside.
+	  */
+	inline Visibility isSphereVisible(const math::vec3f &center, float radius, unsigned int &mask) const
+	{
+		if (mask == 0)
+			return COMPLETE;
+
+		unsigned int outside, inside;
+		_testSphere(center, radius, outside, inside);
+		return _classify(outside, inside, mask);
+	}
+
+	inline Visibility isSphereVisible(const math::vec3f &center, float radius) const
+	{
+		unsigned int mask = ALL_PLANES;
+		return isSphereVisible(center, radius, mask);
+	}
+
+	/**
+	  * Test count boxes against all planes, four at a time, writing each
+	  * result to visibility.  Returns how many are at least partially visible.
+	  */
+	inline size_t cullBoxes(const math::vec3f *centers, const math::vec3f *extents, size_t count, Visibility *visibility) const
+	{
+		size_t visible = 0;
+		size_t i = 0;
+#ifdef MATH_USE_SSE
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4)
 		{
-			int pointsInFront = 0;
-			for (int j = 0; j < 8; ++j)
+			const math::vec3f *c = centers + i;
+			const math::vec3f *e = extents + i;
+			__m128 cx = _mm_set_ps(c[3][0], c[2][0], c[1][0], c[0][0]);
+			__m128 cy = _mm_set_ps(c[3][1], c[2][1], c[1][1], c[0][1]);
+			__m128 cz = _mm_set_ps(c[3][2], c[2][2], c[1][2], c[0][2]);
+			__m128 ex = _mm_set_ps(e[3][0], e[2][0], e[1][0], e[0][0]);
+			__m128 ey = _mm_set_ps(e[3][1], e[2][1], e[1][1], e[0][1]);
+			__m128 ez = _mm_set_ps(e[3][2], e[2][2], e[1][2], e[0][2]);
+
+			__m128 outside = zero;
+			__m128 inside = _mm_cmpeq_ps(zero, zero);
+			for (int p = 0; p < 6; ++p)
 			{
-				if (_pointInFront(points[j], _planes[i]))
-					++pointsInFront;
+				__m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(_plane_x[p]), cx),
+				                                            _mm_mul_ps(_mm_set1_ps(_plane_y[p]), cy)),
+				                                 _mm_mul_ps(_mm_set1_ps(_plane_z[p]), cz)),
+				                      _mm_set1_ps(_plane_w[p]));
+				__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(_abs_x[p]), ex),
+				                                 _mm_mul_ps(_mm_set1_ps(_abs_y[p]), ey)),
+				                      _mm_mul_ps(_mm_set1_ps(_abs_z[p]), ez));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(d, r), zero));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_sub_ps(d, r), zero));
+			}
+
+			int out_bits = _mm_movemask_ps(outside);
+			int in_bits = _mm_movemask_ps(inside);
+			for (int j = 0; j < 4; ++j)
+			{
+				if (out_bits & (1 << j))
+				{
+					visibility[i + j] = NONE;
+				}
+				else
+				{
+					visibility[i + j] = (in_bits & (1 << j)) ? COMPLETE : PARTIAL;
+					++visible;
+				}
 			}
-			if (pointsInFront == 0)
-				return NONE;
-			if (pointsInFront == 8)
-				++planesContaining;
 		}
-		if (planesContaining == 6)
-			return COMPLETE;
-		else
-			return PARTIAL;
+#endif
+		for (; i < count; ++i)
+		{
+			visibility[i] = isVisible(centers[i], extents[i]);
+			if (visibility[i] != NONE)
+				++visible;
+		}
+		return visible;
+	}
+
+	/**
+	  * Test count spheres against all planes, writing each result to
+	  * visibility.  Returns how many are at least partially visible.
+	  */
+	inline size_t cullSpheres(const math::vec3f *centers, const float *radii, size_t count, Visibility *visibility) const
+	{
+		size_t visible = 0;
+		size_t i = 0;
+#ifdef MATH_USE_SSE
+		const __m128 zero = _mm_setzero_ps();
+		for (; i + 4 <= count; i += 4)
+		{
+			const math::vec3f *c = centers + i;
+			__m128 cx = _mm_set_ps(c[3][0], c[2][0], c[1][0], c[0][0]);
+			__m128 cy = _mm_set_ps(c[3][1], c[2][1], c[1][1], c[0][1]);
+			__m128 cz = _mm_set_ps(c[3][2], c[2][2], c[1][2], c[0][2]);
+			__m128 r = _mm_loadu_ps(radii + i);
+
+			__m128 outside = zero;
+			__m128 inside = _mm_cmpeq_ps(zero, zero);
+			for (int p = 0; p < 6; ++p)
+			{
+				__m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(_plane_x[p]), cx),
+				                                            _mm_mul_ps(_mm_set1_ps(_plane_y[p]), cy)),
+				                                 _mm_mul_ps(_mm_set1_ps(_plane_z[p]), cz)),
+				                      _mm_set1_ps(_plane_w[p]));
+				outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(d, r), zero));
+				inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_sub_ps(d, r), zero));
+			}
+
+			int out_bits = _mm_movemask_ps(outside);
+			int in_bits = _mm_movemask_ps(inside);
+			for (int j = 0; j < 4; ++j)
+			{
+				if (out_bits & (1 << j))
+				{
+					visibility[i + j] = NONE;
+				}
+				else
+				{
+					visibility[i + j] = (in_bits & (1 << j)) ? COMPLETE : PARTIAL;
+					++visible;
+				}
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			visibility[i] = isSphereVisible(centers[i], radii[i]);
+			if (visibility[i] != NONE)
+				++visible;
+		}
+		return visible;
 	}
 
 	inline void computeCorners()
@@ -100,44 +291,182 @@ public:
 		_farRightTop = _intersectPlanes(_planes[4], _planes[0], _planes[2]);
 	}
 
-	inline hydra::Vec3 eye() { return _eyePosition; }
-	inline hydra::Vec3 farLeftBottom() { return _farLeftBottom; }
-	inline hydra::Vec3 farLeftTop() { return _farLeftTop; }
-	inline hydra::Vec3 farRightBottom() { return _farRightBottom; }
-	inline hydra::Vec3 farRightTop() { return _farRightTop; }
+	inline math::vec3f eye() { return _eyePosition; }
+	inline math::vec3f farLeftBottom() { return _farLeftBottom; }
+	inline math::vec3f farLeftTop() { return _farLeftTop; }
+	inline math::vec3f farRightBottom() { return _farRightBottom; }
+	inline math::vec3f farRightTop() { return _farRightTop; }
 
 	inline float& near() { return _near; }
 	inline float& far() { return _far; }
 
-	hydra::Mat4 projection;
-	hydra::Mat4 modelview;
-	hydra::Mat4 modelviewProjection;
+	math::Matrixf projection;
+	math::Matrixf modelview;
+	math::Matrixf modelviewProjection;
 protected:
-	hydra::Vec4 _planes[6];
-	hydra::Vec3 _eyePosition;
-	hydra::Vec3 _farLeftBottom;
-	hydra::Vec3 _farLeftTop;
-	hydra::Vec3 _farRightBottom;
-	hydra::Vec3 _farRightTop;
+	math::vec4f _planes[6];
+	math::vec3f _eyePosition;
+	math::vec3f _farLeftBottom;
+	math::vec3f _farLeftTop;
+	math::vec3f _farRightBottom;
+	math::vec3f _farRightTop;
 	float _near;
 	float _far;
 
-	inline bool _pointInFront(hydra::Vec4& point, hydra::Vec4& plane)
+	// The planes again as separate arrays for the SIMD tests, padded to
+	// eight with planes every point is inside of, and the absolute values
+	// of the normals for the box extents.
+	float _plane_x[8];
+	float _plane_y[8];
+	float _plane_z[8];
+	float _plane_w[8];
+	float _abs_x[8];
+	float _abs_y[8];
+	float _abs_z[8];
+
+	inline void _extractPlanes()
+	{
+		// Matrix::operator* multiplies the stored (column major) arrays, so
+		// this is projection * modelview in OpenGL terms and the OpenGL rows
+		// of the result are the Matrix columns.
+		modelviewProjection = modelview * projection;
+		math::vec4f row0 = modelviewProjection.col(0);
+		math::vec4f row1 = modelviewProjection.col(1);
+		math::vec4f row2 = modelviewProjection.col(2);
+		math::vec4f row3 = modelviewProjection.col(3);
+		_planes[0] = row3 - row0; //Right
+		_planes[1] = row3 + row0; //Left
+		_planes[2] = row3 - row1; //Top
+		_planes[3] = row3 + row1; //Bottom
+		_planes[4] = row3 - row2; //Far
+		_planes[5] = row3 + row2; //Near
+		for (int i = 0; i < 6; ++i)
+		{
+			float length = sqrt(_planes[i].x() * _planes[i].x() +
+			                    _planes[i].y() * _planes[i].y() +
+								_planes[i].z() * _planes[i].z());
+			_planes[i] /= length;
+		}
+		_updatePlaneArrays();
+
+		math::Matrixf inv = math::affineInverse(modelview);
+		_eyePosition = math::vec3f(inv(12), inv(13), inv(14));
+	}
+
+	inline void _updatePlaneArrays()
+	{
+		for (int i = 0; i < 8; ++i)
+		{
+			math::vec4f plane = i < 6 ? _planes[i] : math::vec4f(0.0f, 0.0f, 0.0f, 1.0f);
+			_plane_x[i] = plane.x();
+			_plane_y[i] = plane.y();
+			_plane_z[i] = plane.z();
+			_plane_w[i] = plane.w();
+			_abs_x[i] = fabsf(plane.x());
+			_abs_y[i] = fabsf(plane.y());
+			_abs_z[i] = fabsf(plane.z());
+		}
+	}
+
+	/**
+	  * The eight corners where the near and far planes meet the sides.
+	  */
+	inline void _corners(math::vec3f *corners) const
+	{
+		for (int i = 0; i < 8; ++i)
+		{
+			const math::vec4f &depth = (i & 4) ? _planes[4] : _planes[5];
+			const math::vec4f &side = (i & 2) ? _planes[0] : _planes[1];
+			const math::vec4f &height = (i & 1) ? _planes[2] : _planes[3];
+			corners[i] = _intersectPlanes(depth, side, height);
+		}
+	}
+
+	/**
+	  * Set bit i of outside if the bounds are completely behind plane i and
+	  * bit i of inside if they are completely in front of it.
+	  */
+	inline void _testBox(const math::vec3f &center, const math::vec3f &extent, unsigned int &outside, unsigned int &inside) const
+	{
+#ifdef MATH_USE_SSE
+		const __m128 zero = _mm_setzero_ps();
+		__m128 cx = _mm_set1_ps(center[0]), cy = _mm_set1_ps(center[1]), cz = _mm_set1_ps(center[2]);
+		__m128 ex = _mm_set1_ps(extent[0]), ey = _mm_set1_ps(extent[1]), ez = _mm_set1_ps(extent[2]);
+		outside = inside = 0;
+		for (int g = 0; g < 8; g += 4)
+		{
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(_plane_x + g), cx),
+			                                            _mm_mul_ps(_mm_loadu_ps(_plane_y + g), cy)),
+			                                 _mm_mul_ps(_mm_loadu_ps(_plane_z + g), cz)),
+			                      _mm_loadu_ps(_plane_w + g));
+			__m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(_abs_x + g), ex),
+			                                 _mm_mul_ps(_mm_loadu_ps(_abs_y + g), ey)),
+			                      _mm_mul_ps(_mm_loadu_ps(_abs_z + g), ez));
+			outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(d, r), zero)) << g;
+			inside |= _mm_movemask_ps(_mm_cmpge_ps(_mm_sub_ps(d, r), zero)) << g;
+		}
+#else
+		outside = inside = 0;
+		for (int i = 0; i < 6; ++i)
+		{
+			float d = ((_plane_x[i] * center[0] + _plane_y[i] * center[1]) + _plane_z[i] * center[2]) + _plane_w[i];
+			float r = (_abs_x[i] * extent[0] + _abs_y[i] * extent[1]) + _abs_z[i] * extent[2];
+			if (d + r < 0.0f)
+				outside |= 1u << i;
+			if (d - r >= 0.0f)
+				inside |= 1u << i;
+		}
+#endif
+	}
+
+	inline void _testSphere(const math::vec3f &center, float radius, unsigned int &outside, unsigned int &inside) const
+	{
+#ifdef MATH_USE_SSE
+		const __m128 zero = _mm_setzero_ps();
+		__m128 cx = _mm_set1_ps(center[0]), cy = _mm_set1_ps(center[1]), cz = _mm_set1_ps(center[2]);
+		__m128 r = _mm_set1_ps(radius);
+		outside = inside = 0;
+		for (int g = 0; g < 8; g += 4)
+		{
+			__m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(_plane_x + g), cx),
+			                                            _mm_mul_ps(_mm_loadu_ps(_plane_y + g), cy)),
+			                                 _mm_mul_ps(_mm_loadu_ps(_plane_z + g), cz)),
+			                      _mm_loadu_ps(_plane_w + g));
+			outside |= _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(d, r), zero)) << g;
+			inside |= _mm_movemask_ps(_mm_cmpge_ps(_mm_sub_ps(d, r), zero)) << g;
+		}
+#else
+		outside = inside = 0;
+		for (int i = 0; i < 6; ++i)
+		{
+			float d = ((_plane_x[i] * center[0] + _plane_y[i] * center[1]) + _plane_z[i] * center[2]) + _plane_w[i];
+			if (d + radius < 0.0f)
+				outside |= 1u << i;
+			if (d - radius >= 0.0f)
+				inside |= 1u << i;
+		}
+#endif
+	}
+
+	static inline Visibility _classify(unsigned int outside, unsigned int inside, unsigned int &mask)
 	{
-		return point.dot(plane) > 0;
+		if (outside & mask)
+			return NONE;
+		mask &= ~inside;
+		return mask == 0 ? COMPLETE : PARTIAL;
 	}
 
-	inline hydra::Vec3 _intersectPlanes(hydra::Vec4 p1, hydra::Vec4 p2, hydra::Vec4 p3)
+	inline math::vec3f _intersectPlanes(math::vec4f p1, math::vec4f p2, math::vec4f p3) const
 	{
-		hydra::Vec3 result;
-		hydra::Vec3 n1 = hydra::Vec3(p1.x(),p1.y(),p1.z());
-		hydra::Vec3 n2 = hydra::Vec3(p2.x(),p2.y(),p2.z());
-		hydra::Vec3 n3 = hydra::Vec3(p3.x(),p3.y(),p3.z());
+		math::vec3f result;
+		math::vec3f n1 = math::vec3f(p1.x(),p1.y(),p1.z());
+		math::vec3f n2 = math::vec3f(p2.x(),p2.y(),p2.z());
+		math::vec3f n3 = math::vec3f(p3.x(),p3.y(),p3.z());
 		float d1 = -p1.w();
 		float d2 = -p2.w();
 		float d3 = -p3.w();
-		float denom = n1.dot(n2.cross(n3));
-		result = n2.cross(n3) * d1 + n3.cross(n1) * d2 + n1.cross(n2) * d3;
+		float denom = math::dot(n1, math::cross(n2, n3));
+		result = math::cross(n2, n3) * d1 + math::cross(n3, n1) * d2 + math::cross(n1, n2) * d3;
 		result /= denom;
 		return result;
 	}
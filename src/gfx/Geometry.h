@@ -0,0 +1,146 @@
+/*
+   Filename : Geometry.h
+   Version  : 1.0
+
+   Purpose  : Constant vertex tables for the built-in shapes (unit cube and
+              skybox).  The tables are constexpr so they are baked into the
+              binary instead of being built every time a shape is drawn.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#pragma once
+
+#include <Vector.h>
+
+namespace gfx
+{
+
+namespace geometry
+{
+
+/**
+  * One corner of a textured, lit quad.
+  */
+struct QuadVertex
+{
+	math::vec2f texture;
+	math::vec3f normal;
+	math::vec3f position;
+};
+
+/**
+  * One corner of a skybox quad.  The skybox is unlit.
+  */
+struct SkyboxVertex
+{
+	math::vec2f texture;
+	math::vec3f position;
+};
+
+/**
+  * A unit cube centered at the origin as 6 quads of 4 corners (GL_QUADS),
+  * in the order and winding renderCube has always used.
+  */
+constexpr QuadVertex unit_cube[24] =
+{
+	// Back
+	{ math::vec2f (0.0f, 1.0f), math::vec3f (0.0f, 0.0f, -1.0f), math::vec3f (-0.5f, -0.5f,  0.5f) },
+	{ math::vec2f (1.0f, 1.0f), math::vec3f (0.0f, 0.0f, -1.0f), math::vec3f (-0.5f,  0.5f,  0.5f) },
+	{ math::vec2f (1.0f, 0.0f), math::vec3f (0.0f, 0.0f, -1.0f), math::vec3f (-0.5f,  0.5f, -0.5f) },
+	{ math::vec2f (0.0f, 0.0f), math::vec3f (0.0f, 0.0f, -1.0f), math::vec3f (-0.5f, -0.5f, -0.5f) },
+
+	// Right
+	{ math::vec2f (0.0f, 1.0f), math::vec3f (1.0f, 0.0f, 0.0f), math::vec3f ( 0.5f, -0.5f, -0.5f) },
+	{ math::vec2f (1.0f, 1.0f), math::vec3f (1.0f, 0.0f, 0.0f), math::vec3f ( 0.5f,  0.5f, -0.5f) },
+	{ math::vec2f (1.0f, 0.0f), math::vec3f (1.0f, 0.0f, 0.0f), math::vec3f ( 0.5f,  0.5f,  0.5f) },
+	{ math::vec2f (0.0f, 0.0f), math::vec3f (1.0f, 0.0f, 0.0f), math::vec3f ( 0.5f, -0.5f,  0.5f) },
+
+	// Bottom
+	{ math::vec2f (0.0f, 1.0f), math::vec3f (0.0f, -1.0f, 0.0f), math::vec3f (-0.5f, -0.5f,  0.5f) },
+	{ math::vec2f (1.0f, 1.0f), math::vec3f (0.0f, -1.0f, 0.0f), math::vec3f (-0.5f, -0.5f, -0.5f) },
+	{ math::vec2f (1.0f, 0.0f), math::vec3f (0.0f, -1.0f, 0.0f), math::vec3f ( 0.5f, -0.5f, -0.5f) },
+	{ math::vec2f (0.0f, 0.0f), math::vec3f (0.0f, -1.0f, 0.0f), math::vec3f ( 0.5f, -0.5f,  0.5f) },
+
+	// Top
+	{ math::vec2f (0.0f, 1.0f), math::vec3f (0.0f, 1.0f, 0.0f), math::vec3f (-0.5f,  0.5f,  0.5f) },
+	{ math::vec2f (1.0f, 1.0f), math::vec3f (0.0f, 1.0f, 0.0f), math::vec3f ( 0.5f,  0.5f,  0.5f) },
+	{ math::vec2f (1.0f, 0.0f), math::vec3f (0.0f, 1.0f, 0.0f), math::vec3f ( 0.5f,  0.5f, -0.5f) },
+	{ math::vec2f (0.0f, 0.0f), math::vec3f (0.0f, 1.0f, 0.0f), math::vec3f (-0.5f,  0.5f, -0.5f) },
+
+	// Left
+	{ math::vec2f (0.0f, 1.0f), math::vec3f (-1.0f, 0.0f, 0.0f), math::vec3f (-0.5f, -0.5f, -0.5f) },
+	{ math::vec2f (1.0f, 1.0f), math::vec3f (-1.0f, 0.0f, 0.0f), math::vec3f (-0.5f,  0.5f, -0.5f) },
+	{ math::vec2f (1.0f, 0.0f), math::vec3f (-1.0f, 0.0f, 0.0f), math::vec3f ( 0.5f,  0.5f, -0.5f) },
+	{ math::vec2f (0.0f, 0.0f), math::vec3f (-1.0f, 0.0f, 0.0f), math::vec3f ( 0.5f, -0.5f, -0.5f) },
+
+	// Front
+	{ math::vec2f (0.0f, 1.0f), math::vec3f (0.0f, 0.0f, 1.0f), math::vec3f ( 0.5f, -0.5f,  0.5f) },
+	{ math::vec2f (1.0f, 1.0f), math::vec3f (0.0f, 0.0f, 1.0f), math::vec3f ( 0.5f,  0.5f,  0.5f) },
+	{ math::vec2f (1.0f, 0.0f), math::vec3f (0.0f, 0.0f, 1.0f), math::vec3f (-0.5f,  0.5f,  0.5f) },
+	{ math::vec2f (0.0f, 0.0f), math::vec3f (0.0f, 0.0f, 1.0f), math::vec3f (-0.5f, -0.5f,  0.5f) }
+};
+
+/**
+  * The skybox faces in image order (posx, negx, posy, negy, posz, negz), 4
+  * corners each, with respect to the default OpenGL camera looking down -z.
+  */
+constexpr SkyboxVertex skybox_faces[6][4] =
+{
+	// posx
+	{
+		{ math::vec2f (0.0f, 0.0f), math::vec3f ( 0.5f, -0.5f, -0.5f) },
+		{ math::vec2f (1.0f, 0.0f), math::vec3f ( 0.5f, -0.5f,  0.5f) },
+		{ math::vec2f (1.0f, 1.0f), math::vec3f ( 0.5f,  0.5f,  0.5f) },
+		{ math::vec2f (0.0f, 1.0f), math::vec3f ( 0.5f,  0.5f, -0.5f) }
+	},
+
+	// negx
+	{
+		{ math::vec2f (0.0f, 0.0f), math::vec3f (-0.5f, -0.5f,  0.5f) },
+		{ math::vec2f (1.0f, 0.0f), math::vec3f (-0.5f, -0.5f, -0.5f) },
+		{ math::vec2f (1.0f, 1.0f), math::vec3f (-0.5f,  0.5f, -0.5f) },
+		{ math::vec2f (0.0f, 1.0f), math::vec3f (-0.5f,  0.5f,  0.5f) }
+	},
+
+	// posy
+	{
+		{ math::vec2f (0.0f, 0.0f), math::vec3f ( 0.5f,  0.5f, -0.5f) },
+		{ math::vec2f (1.0f, 0.0f), math::vec3f ( 0.5f,  0.5f,  0.5f) },
+		{ math::vec2f (1.0f, 1.0f), math::vec3f (-0.5f,  0.5f,  0.5f) },
+		{ math::vec2f (0.0f, 1.0f), math::vec3f (-0.5f,  0.5f, -0.5f) }
+	},
+
+	// negy
+	{
+		{ math::vec2f (0.0f, 0.0f), math::vec3f (-0.5f, -0.5f, -0.5f) },
+		{ math::vec2f (1.0f, 0.0f), math::vec3f (-0.5f, -0.5f,  0.5f) },
+		{ math::vec2f (1.0f, 1.0f), math::vec3f ( 0.5f, -0.5f,  0.5f) },
+		{ math::vec2f (0.0f, 1.0f), math::vec3f ( 0.5f, -0.5f, -0.5f) }
+	},
+
+	// posz
+	{
+		{ math::vec2f (0.0f, 0.0f), math::vec3f ( 0.5f, -0.5f,  0.5f) },
+		{ math::vec2f (1.0f, 0.0f), math::vec3f (-0.5f, -0.5f,  0.5f) },
+		{ math::vec2f (1.0f, 1.0f), math::vec3f (-0.5f,  0.5f,  0.5f) },
+		{ math::vec2f (0.0f, 1.0f), math::vec3f ( 0.5f,  0.5f,  0.5f) }
+	},
+
+	// negz
+	{
+		{ math::vec2f (0.0f, 0.0f), math::vec3f (-0.5f, -0.5f, -0.5f) },
+		{ math::vec2f (1.0f, 0.0f), math::vec3f ( 0.5f, -0.5f, -0.5f) },
+		{ math::vec2f (1.0f, 1.0f), math::vec3f ( 0.5f,  0.5f, -0.5f) },
+		{ math::vec2f (0.0f, 1.0f), math::vec3f (-0.5f,  0.5f, -0.5f) }
+	}
+};
+
+static_assert (sizeof (unit_cube) == 24 * sizeof (QuadVertex), "unit_cube must hold 6 quads");
+static_assert (unit_cube[20].position[0] == 0.5f, "unit_cube is evaluated at compile time");
+
+}
+
+}
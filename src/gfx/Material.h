@@ -13,7 +13,8 @@
 #pragma once
 
 #include <Vector.h>
-#include <Texture.h>
+#include <TextureCache.h>
+#include <future>
 #include <string>
 
 namespace gfx
@@ -24,7 +25,7 @@ struct Material
 	Material (void)
 	{
 		name = "";
-		texture.texture_name = "";
+		texture_name = "";
 		diffuse.zero ();
 		specular.zero ();
 		transmissive.zero ();
@@ -40,7 +41,9 @@ struct Material
 	float specular_exponent;	// Specular exponent.
 	float alpha;				// Alpha value for this material.
 	float index_of_refraction;	// Index of refraction for this material.
-	gfx::Texture texture;		// Texture which is bound to this material.
+	std::string texture_name;	// Image of the texture, if any.
+	gfx::TextureCache::Handle texture;			// Texture which is bound to this material, shared by every material using the image.
+	std::shared_future <void> texture_loaded;	// Ready once the texture is decoded.
 };
 
 }
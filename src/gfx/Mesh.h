@@ -17,13 +17,22 @@
 #include <Triangle.h>
 #include <Vector.h>
 #include <VertexBuffer.h>
+#include <BufferArena.h>
 #include <Material.h>
 #include <ContextBuffer.h>
+#include <UploadQueue.h>
+#include <TextureAtlas.h>
+#include <TextureCache.h>
+#include <TextureLoader.h>
+#include <ThreadPool.h>
+#include <future>
 #include <map>
+#include <mutex>
 #include <list>
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <algorithm>
 
 namespace gfx
 {
@@ -48,6 +57,8 @@ class Mesh
 			m_use_texture 	= false;
 			m_use_materials = false;
 			m_use_tangents 	= false;
+			m_use_atlas		= false;
+			m_arena			= NULL;
 		}
 
 		/** 
@@ -65,6 +76,21 @@ class Mesh
 		  */
 		void useTangents (bool useTangents) { m_use_tangents = useTangents; }
 
+		/**
+		  * Allocate the VBOs from an arena shared with other meshes instead
+		  * of a buffer object each, so that drawing them needs fewer binds.
+		  * Call before the VBOs are created; NULL (the default) goes back to
+		  * a buffer object each.
+		  */
+		void useArena (BufferArena *arena) { m_arena = arena; }
+
+		/**
+		  * Pack the small textures of the materials into atlases when
+		  * loading, and draw the materials that then look the same as one
+		  * VBO.  Call before load ().  Default is false.
+		  */
+		void useAtlas (bool use_atlas) { m_use_atlas = use_atlas; }
+
 		/**
 		  * Sets the attribute location of the tangent attribute in the GLSL program.
 		  */
@@ -74,8 +100,10 @@ class Mesh
 		  * Load a mesh from a filename, must be .obj.
 		  * @param filename Path to the .obj file.
 		  * @param create_vbo Flag to create a vbo after loading the file.
+		  * @param pool Pool to decode the textures on, all at once, or NULL to
+		  *        decode them before returning.  See Material::texture_loaded.
 		  */
-		bool load (const char *filename, bool create_vbo = false)
+		bool load (const char *filename, bool create_vbo = false, util::ThreadPool *pool = NULL)
 		{
 			std::ifstream fin;
 			std::string path = filename;
@@ -187,7 +215,7 @@ class Mesh
 
 						else if (material_line == "map_Kd")
 						{
-							mat_fin >> material_iter->second.texture.texture_name;
+							mat_fin >> material_iter->second.texture_name;
 						}
 
 						else if (material_line == "illum")
@@ -327,15 +355,29 @@ class Mesh
 
 			fin.close ();
 
-			// Load any textures.
+			// Load any textures, once per image however many materials and
+			// meshes use it.  Diffuse maps load as RGB, so BC1 costs them
+			// only precision.
+			Texture::Params params;
+			params.compressedFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+			std::unique_ptr <TextureLoader> loader (pool ? new TextureLoader (*pool) : NULL);
+			if (m_use_atlas && m_use_texture)
+			{
+				packTextures (params, loader.get ());
+			}
 			std::map <std::string, Material>::iterator iter;
 			for (iter = m_materials.begin (); iter != m_materials.end (); ++iter)
 			{
-				if (iter->second.texture.texture_name.length ())
+				if (iter->second.texture_name.length () && !iter->second.texture)
 				{
-					iter->second.texture.load (iter->second.texture.texture_name.c_str ());
+					iter->second.texture = TextureCache::getInstance ().load (iter->second.texture_name, params,
+					                                                          loader.get (), &iter->second.texture_loaded);
 				}
-			}	
+			}
+			if (m_use_atlas)
+			{
+				batchMaterials ();
+			}
 
 			std::cout << "Loaded " << num_tris << " triangles" << std::endl;
 			std::cout << "Loaded " << m_normals.size () << " normals" << std::endl;
@@ -348,6 +390,21 @@ class Mesh
 				createVBO ();
 			}
 
+			// Bounding box of the vertices, for culling.
+			if (m_vertices.size ())
+			{
+				m_bounds_min = m_vertices[0];
+				m_bounds_max = m_vertices[0];
+				for (size_t i = 1; i < m_vertices.size (); ++i)
+				{
+					for (int j = 0; j < 3; ++j)
+					{
+						m_bounds_min[j] = std::min (m_bounds_min[j], m_vertices[i][j]);
+						m_bounds_max[j] = std::max (m_bounds_max[j], m_vertices[i][j]);
+					}
+				}
+			}
+
 			m_vertices.clear ();
 			m_normals.clear ();
 			m_texture_coords.clear ();
@@ -365,9 +422,17 @@ class Mesh
 			std::map <std::string, Material>::iterator iter;
 			for (iter = m_materials.begin (); iter != m_materials.end (); ++iter)
 			{
-				if (iter->second.texture.hasData ())
+				if (!iter->second.texture)
+				{
+					continue;
+				}
+				if (iter->second.texture_loaded.valid ())
+				{
+					iter->second.texture_loaded.get ();
+				}
+				if (iter->second.texture->hasData ())
 				{
-					iter->second.texture.createTextureObject (context_id);
+					iter->second.texture->createTextureObject (context_id);
 				}
 			}
 		}
@@ -378,20 +443,153 @@ class Mesh
 		  */
 		void createVBO (int context_id = 0)
 		{
-			// Allocate a VBO for each material found.
+			// Another context of the share group may be creating them right now.
+			std::lock_guard <std::mutex> lock (m_vbo_mutex);
+			if (m_vbos.size () && isLoaded (0, context_id) && ShareGroup::isMember (context_id))
+			{
+				// Already created by a context of the same share group.
+				return;
+			}
+
+			prepareVBOs ();
+			if (m_staged.size () != m_vbos.size ())
+			{
+				stageVBOData ();
+			}
+
+			for (size_t i = 0; i < m_vbos.size (); ++i)
+			{
+				loadVBO (i, context_id);
+			}
+		}
+
+		/**
+		  * Allocate a VBO for each material found.  Must run before
+		  * stageVBOData () and queueVBOs ().
+		  */
+		void prepareVBOs (void)
+		{
+			m_sizeof_render_data = m_use_tangents ? sizeof (RenderData2) : sizeof (RenderData);
 			m_vbos.resize (m_triangles.size ());
+			m_draw_order.resize (m_triangles.size ());
+			int vbo_count = 0;
+			for (TriangleIterator iter = m_triangles.begin (); iter != m_triangles.end (); ++iter, ++vbo_count)
+			{
+				m_vbos[vbo_count].num_vertices = iter->second.size () * 3;
+				m_vbos[vbo_count].material = iter->first;
+				m_draw_order[vbo_count] = vbo_count;
+			}
+
+			// Draw the VBOs of a texture one after another, so that it is
+			// bound once.
+			std::stable_sort (m_draw_order.begin (), m_draw_order.end (), [this] (size_t a, size_t b)
+			{
+				return m_vbos[a].material->texture.get () < m_vbos[b].material->texture.get ();
+			});
+		}
+
+		/**
+		  * Interleave the triangles into the layout of the VBOs, once for every
+		  * context.  No GL calls are made, so this may run on a worker thread;
+		  * the data is kept for contexts created later, until clearCPUData ().
+		  */
+		void stageVBOData (void)
+		{
+			std::vector <std::vector <char> > staged (m_triangles.size ());
 			int vbo_count = 0;
 			for (TriangleIterator iter = m_triangles.begin (); iter != m_triangles.end (); ++iter, ++vbo_count)
 			{
 				if (m_use_tangents)
 				{
-					populateVBO2(iter, vbo_count, context_id);
+					populateVBO2 (iter, staged[vbo_count]);
 				}
 				else
 				{
-					populateVBO(iter, vbo_count, context_id);
+					populateVBO (iter, staged[vbo_count]);
+				}
+			}
+			m_staged.swap (staged);
+		}
+
+		/**
+		  * Queue the VBO uploads of a context instead of creating them at once
+		  * as createVBO () does.  Call prepareVBOs () first.
+		  * @param queue Upload queue of the context.
+		  * @param context_id ID of the context.
+		  * @param staged Ready once stageVBOData () has run, if it runs on
+		  *        another thread.
+		  */
+		void queueVBOs (UploadQueue &queue, int context_id, std::shared_future <void> staged = std::shared_future <void> ())
+		{
+			for (size_t i = 0; i < m_vbos.size (); ++i)
+			{
+				queue.push (m_vbos[i].num_vertices * m_sizeof_render_data, [this, i, context_id] ()
+				{
+					std::lock_guard <std::mutex> lock (m_vbo_mutex);
+					if (isLoaded (i, context_id) && ShareGroup::isMember (context_id))
+					{
+						// Already loaded by a context of the same share group.
+						return;
+					}
+					if (m_staged.size () != m_vbos.size ())
+					{
+						stageVBOData ();
+					}
+					loadVBO (i, context_id);
+				}, staged);
+			}
+		}
+
+		/**
+		  * Queue the uploads of the textures loaded from the model file, the
+		  * queued version of initializeTextures ().
+		  */
+		void queueTextures (UploadQueue &queue, int context_id)
+		{
+			std::map <std::string, Material>::iterator iter;
+			for (iter = m_materials.begin (); iter != m_materials.end (); ++iter)
+			{
+				// Decoding may still be under way; the jobs wait for it.
+				if (iter->second.texture)
+				{
+					queue.push (new TextureUpload (*iter->second.texture, context_id, iter->second.texture_loaded));
+				}
+			}
+		}
+
+		/**
+		  * Returns true once the VBOs and textures of the mesh are all on the
+		  * context.
+		  */
+		bool isResident (int context_id)
+		{
+			for (size_t i = 0; i < m_vbos.size (); ++i)
+			{
+				if (!isLoaded (i, context_id))
+				{
+					return false;
+				}
+			}
+
+			std::map <std::string, Material>::iterator iter;
+			for (iter = m_materials.begin (); iter != m_materials.end (); ++iter)
+			{
+				const Material &material = iter->second;
+				if (!material.texture)
+				{
+					continue;
+				}
+				if (material.texture_loaded.valid () && material.texture_loaded.wait_for (std::chrono::seconds (0)) != std::future_status::ready)
+				{
+					return false;
+				}
+				if (material.texture->hasData () && !material.texture->valid (context_id))
+				{
+					return false;
 				}
 			}
+
+			return true;
 		}
 
 		/**
@@ -403,6 +601,11 @@ class Mesh
 			for (size_t i = 0; i < m_vbos.size (); ++i)
 			{
 				m_vbos[i].vbo.destroyContext (context_id);
+				if (m_arena && m_vbos[i].range.isLastUser (context_id))
+				{
+					m_arena->free (m_vbos[i].range[context_id], context_id);
+					m_vbos[i].range.remove (context_id);
+				}
 			}
 		}
 
@@ -413,6 +616,8 @@ class Mesh
 		void render (int context_id = 0)  
 		{
 			bool bind_texture = false;
+			GLuint bound = 0;
+			Texture *bound_texture = NULL;
 			if (m_vbos.size ())
 			{
 				// A VBO has been created for this mesh, so use it.
@@ -425,40 +630,75 @@ class Mesh
 					glEnableVertexAttribArrayARB(m_tangent_loc[context_id]);
 				}
 
-				for (size_t i = 0; i < m_vbos.size (); ++i)
+				for (size_t n = 0; n < m_draw_order.size (); ++n)
 				{
+					const size_t i = m_draw_order[n];
+
+					// Still queued for upload on this context.
+					if (!isLoaded (i, context_id))
+					{
+						continue;
+					}
+
 					if (m_use_materials)
 					{
 						applyMaterial ((const gfx::Material *)m_vbos[i].material);
 					}
 
-					// Apply any texture that this material might have.
-					bind_texture = m_vbos[i].material->texture.valid (context_id);
-
-					if (bind_texture)
+					// Apply any texture that this material might have, unless
+					// it is bound already.
+					bind_texture = m_vbos[i].material->texture && m_vbos[i].material->texture->valid (context_id);
+					Texture *texture = bind_texture ? m_vbos[i].material->texture.get () : NULL;
+					if (texture != bound_texture)
 					{
-						m_vbos[i].material->texture.bind (context_id);
+						if (texture)
+						{
+							texture->bind (context_id);
+						}
+						else
+						{
+							bound_texture->unbind ();
+						}
+						bound_texture = texture;
 					}
 
-					m_vbos[i].vbo.bind (context_id);
-					glVertexPointer (3, GL_FLOAT, m_sizeof_render_data, (char *)NULL);
-					glNormalPointer (GL_FLOAT, m_sizeof_render_data, (char*)NULL + sizeof (math::vec3f));
-					glTexCoordPointer (2, GL_FLOAT, m_sizeof_render_data, (char *)NULL + (2 * sizeof (math::vec3f)));
+					// VBOs of an arena share buffers; only bind when it changes.
+					char *base = NULL;
+					if (m_arena)
+					{
+						const BufferArena::Range *range = m_vbos[i].range[context_id];
+						if (range->buffer != bound)
+						{
+							glBindBuffer (GL_ARRAY_BUFFER, range->buffer);
+							bound = range->buffer;
+						}
+						base += range->offset;
+					}
+					else
+					{
+						m_vbos[i].vbo.bind (context_id);
+					}
+					glVertexPointer (3, GL_FLOAT, m_sizeof_render_data, base);
+					glNormalPointer (GL_FLOAT, m_sizeof_render_data, base + sizeof (math::vec3f));
+					glTexCoordPointer (2, GL_FLOAT, m_sizeof_render_data, base + (2 * sizeof (math::vec3f)));
 
 					if (m_use_tangents)
 					{
-						glVertexAttribPointerARB (m_tangent_loc[context_id], 4, GL_FLOAT, false, m_sizeof_render_data, (char *)NULL + (2 * sizeof (math::vec3f)) + sizeof (math::vec2f));
+						glVertexAttribPointerARB (m_tangent_loc[context_id], 4, GL_FLOAT, false, m_sizeof_render_data, base + (2 * sizeof (math::vec3f)) + sizeof (math::vec2f));
 					}
 
 					glDrawArrays (GL_TRIANGLES, 0, m_vbos[i].num_vertices);
-					m_vbos[i].vbo.unbind ();
-
-					if (bind_texture)
+					if (!m_arena)
 					{
-						m_vbos[i].material->texture.unbind ();
+						m_vbos[i].vbo.unbind ();
 					}
 				}
 
+				if (bound_texture)
+				{
+					bound_texture->unbind ();
+				}
+				glBindBuffer (GL_ARRAY_BUFFER, 0);
 				glDisableClientState(GL_VERTEX_ARRAY);
 				glDisableClientState(GL_NORMAL_ARRAY);
 				glDisableClientState (GL_TEXTURE_COORD_ARRAY);
@@ -477,11 +717,11 @@ class Mesh
 			{
 				applyMaterial ((const gfx::Material *)iter->first);
 				// Apply any texture that this material might have.
-				bind_texture = iter->first->texture.valid (context_id);
+				bind_texture = iter->first->texture && iter->first->texture->valid (context_id);
 
 				if (bind_texture)
 				{
-					iter->first->texture.bind (context_id);
+					iter->first->texture->bind (context_id);
 				}
 
 				glBegin (GL_TRIANGLES);
@@ -511,7 +751,7 @@ class Mesh
 
 				if (bind_texture)
 				{
-					iter->first->texture.unbind ();
+					iter->first->texture->unbind ();
 				}
 			}
 		}
@@ -522,13 +762,26 @@ class Mesh
 		  */
 		void clearCPUData (void)
 		{
+			// Textures may be shared with other meshes: the TextureCache
+			// frees their data once every context has them.
 			m_triangles.clear ();
-			
-			std::map <std::string, Material>::iterator iter;
-			for (iter = m_materials.begin (); iter != m_materials.end (); ++iter)
-			{
-				iter->second.texture.clearCPUData ();
-			}
+			m_staged.clear ();
+		}
+
+		/**
+		  * Get the minimum corner of the mesh's bounding box.
+		  */
+		const math::Vector <T, 3> &getBoundsMin (void) const
+		{
+			return m_bounds_min;
+		}
+
+		/**
+		  * Get the maximum corner of the mesh's bounding box.
+		  */
+		const math::Vector <T, 3> &getBoundsMax (void) const
+		{
+			return m_bounds_max;
 		}
 
 		/**
@@ -553,18 +806,214 @@ class Mesh
 	private:
 
 		/**
-		  * Copy triangles to a VBO using RenderData1.
-		  * @param iter Current VBO list to populate.
-		  * @param vbo_count Index of VBO being populated.
-		  * @param context_id Context Id for the current graphics context.
+		  * Pack the textures of the materials into atlases and point the
+		  * materials and their texture coordinates at them.  Only images up
+		  * to 512 texels on a side are packed, and only for materials whose
+		  * coordinates stay within [0, 1]: the atlas cannot repeat an image.
+		  * The rest, and images that fail to decode, are left to load on
+		  * their own; an image alone in its atlas keeps the uncompressed
+		  * texture it was decoded to.
+		  * @param params Parameters of the textures; the atlases are
+		  *        clamped and keep fewer mipmap levels.
 		  */
-		void populateVBO (TriangleIterator &iter, int &vbo_count, int context_id)
+		void packTextures (const Texture::Params &params, TextureLoader *loader)
 		{
-			m_sizeof_render_data = sizeof (RenderData);
+			const GLsizei max_image_size = 512;
+
+			// Images of the materials that may use an atlas.
+			std::map <std::string, std::vector <Material *> > users;
+			for (TriangleIterator iter = m_triangles.begin (); iter != m_triangles.end (); ++iter)
+			{
+				const std::string &name = iter->first->texture_name;
+				if (name.empty () || compression::isCompressedFile (name))
+				{
+					continue;
+				}
+
+				bool inside = true;
+				for (size_t i = 0; i < iter->second.size () && inside; ++i)
+				{
+					for (int j = 0; j < 3; ++j)
+					{
+						const math::Vector <T, 2> &coord = iter->second[i].m_texture_coords[j];
+						inside = inside && coord[0] >= 0 && coord[0] <= 1 && coord[1] >= 0 && coord[1] <= 1;
+					}
+				}
+				if (inside)
+				{
+					users[name].push_back (iter->first);
+				}
+			}
+
+			// Decode them all, uncompressed, on the loader if there is one.
+			// Through the cache, so that an image left on its own is not
+			// decoded again, and other meshes share the decodes.
+			Texture::Params decode_params = params;
+			decode_params.compressedFormat = 0;
+			std::vector <std::string> names;
+			std::vector <TextureCache::Handle> images;
+			std::vector <std::shared_future <void> > decoded;
+			std::map <std::string, std::vector <Material *> >::iterator user;
+			for (user = users.begin (); user != users.end (); ++user)
+			{
+				std::shared_future <void> image_loaded;
+				TextureCache::Handle image;
+				try
+				{
+					image = TextureCache::getInstance ().load (user->first, decode_params, loader, &image_loaded);
+				}
+				catch (std::exception &)
+				{
+					continue;
+				}
+				names.push_back (user->first);
+				images.push_back (image);
+				decoded.push_back (image_loaded);
+			}
+
+			// Fill an atlas at a time.
+			struct Packed
+			{
+				size_t atlas;
+				int index;
+				size_t image;
+			};
+			std::vector <std::shared_ptr <TextureAtlas> > atlases;
+			std::vector <Packed> packed;
+			for (size_t i = 0; i < images.size (); ++i)
+			{
+				try
+				{
+					decoded[i].get ();
+				}
+				catch (std::exception &)
+				{
+					continue;
+				}
+				if (images[i]->width () > max_image_size || images[i]->height () > max_image_size)
+				{
+					continue;
+				}
+
+				int index = atlases.empty () ? -1 : atlases.back ()->add (names[i], *images[i]);
+				if (index < 0)
+				{
+					atlases.push_back (std::make_shared <TextureAtlas> ());
+					index = atlases.back ()->add (names[i], *images[i]);
+				}
+				if (index >= 0)
+				{
+					Packed image = { atlases.size () - 1, index, i };
+					packed.push_back (image);
+				}
+			}
 
-			std::vector<RenderData> data;
+			// An atlas of one image would save nothing: its materials keep
+			// the image as decoded.
+			std::vector <TextureCache::Handle> textures (atlases.size ());
+			std::vector <std::shared_future <void> > loaded (atlases.size ());
+			for (size_t i = 0; i < atlases.size (); ++i)
+			{
+				std::shared_ptr <TextureAtlas> atlas = atlases[i];
+				if (atlas->getImageCount () > 1)
+				{
+					Texture::Params atlas_params = params;
+					atlas->applyParams (atlas_params);
+					textures[i] = TextureCache::getInstance ().build (atlas->getName (), atlas_params,
+					                                                  [atlas] (Texture &texture) { atlas->fill (texture); },
+					                                                  loader, &loaded[i]);
+				}
+			}
+
+			for (size_t i = 0; i < packed.size (); ++i)
+			{
+				std::vector <Material *> &materials = users[names[packed[i].image]];
+				if (!textures[packed[i].atlas])
+				{
+					for (size_t j = 0; j < materials.size (); ++j)
+					{
+						materials[j]->texture = images[packed[i].image];
+						materials[j]->texture_loaded = decoded[packed[i].image];
+					}
+					continue;
+				}
+
+				const TextureAtlas::Region &region = atlases[packed[i].atlas]->getRegion (packed[i].index);
+				for (size_t j = 0; j < materials.size (); ++j)
+				{
+					materials[j]->texture = textures[packed[i].atlas];
+					materials[j]->texture_loaded = loaded[packed[i].atlas];
+					std::vector <gfx::Triangle <T> > &triangles = m_triangles[materials[j]];
+					for (size_t k = 0; k < triangles.size (); ++k)
+					{
+						for (int l = 0; l < 3; ++l)
+						{
+							math::Vector <T, 2> &coord = triangles[k].m_texture_coords[l];
+							coord[0] = (T)(region.offset[0] + coord[0] * region.scale[0]);
+							coord[1] = (T)(region.offset[1] + coord[1] * region.scale[1]);
+						}
+					}
+				}
+			}
+		}
+
+		/**
+		  * Move the triangles of materials that look the same, as those
+		  * sharing an atlas may, to one of them so that they make one VBO.
+		  */
+		void batchMaterials (void)
+		{
+			std::map <Material *, std::vector <gfx::Triangle <T> > > batched;
+			for (TriangleIterator iter = m_triangles.begin (); iter != m_triangles.end (); ++iter)
+			{
+				TriangleIterator batch = batched.begin ();
+				while (batch != batched.end () && !looksSame (*batch->first, *iter->first))
+				{
+					++batch;
+				}
+				if (batch == batched.end ())
+				{
+					batched[iter->first].swap (iter->second);
+					continue;
+				}
+
+				for (size_t i = 0; i < iter->second.size (); ++i)
+				{
+					iter->second[i].m_material = batch->first;
+				}
+				batch->second.insert (batch->second.end (), iter->second.begin (), iter->second.end ());
+			}
+			m_triangles.swap (batched);
+		}
+
+		/**
+		  * Returns true if a and b render alike.
+		  */
+		bool looksSame (const Material &a, const Material &b) const
+		{
+			if (a.texture != b.texture)
+			{
+				return false;
+			}
+			if (!m_use_materials)
+			{
+				return true;
+			}
+			return a.diffuse == b.diffuse && a.specular == b.specular && a.transmissive == b.transmissive &&
+			       a.specular_exponent == b.specular_exponent && a.alpha == b.alpha &&
+			       a.index_of_refraction == b.index_of_refraction;
+		}
+
+		/**
+		  * Copy triangles to VBO data using RenderData1.
+		  * @param iter Current VBO list to populate.
+		  * @param bytes Data of the VBO.
+		  */
+		void populateVBO (TriangleIterator &iter, std::vector <char> &bytes)
+		{
+			bytes.resize (sizeof (RenderData) * iter->second.size () * 3);
+			RenderData *data = (RenderData *)bytes.data ();
 
-			data.resize (iter->second.size () * 3);
 			int data_counter = 0;
 			for (size_t i = 0; i < iter->second.size (); ++i)
 			{
@@ -576,25 +1025,18 @@ class Mesh
 					data_counter++;
 				}
 			}
-
-			m_vbos[vbo_count].num_vertices = iter->second.size () * 3;
-			m_vbos[vbo_count].material = iter->first;
-			m_vbos[vbo_count].vbo.load ((void *)&data[0], m_sizeof_render_data * iter->second.size () * 3, context_id);
 		}
 
 		/**
-		  * Copy triangles to a VBO using RenderData2 which uses tangents for each triangle.
+		  * Copy triangles to VBO data using RenderData2 which uses tangents for each triangle.
 		  * @param iter Current VBO list to populate.
-		  * @param vbo_count Index of VBO being populated.
-		  * @param context_id Context Id for the current graphics context.
+		  * @param bytes Data of the VBO.
 		  */
-		void populateVBO2 (TriangleIterator &iter, int &vbo_count, int context_id)
+		void populateVBO2 (TriangleIterator &iter, std::vector <char> &bytes)
 		{
-			m_sizeof_render_data = sizeof (RenderData2); // different
-
-			std::vector<RenderData2> data; // different
+			bytes.resize (sizeof (RenderData2) * iter->second.size () * 3); // different
+			RenderData2 *data = (RenderData2 *)bytes.data (); // different
 
-			data.resize (iter->second.size () * 3);
 			int data_counter = 0;
 			for (size_t i = 0; i < iter->second.size (); ++i)
 			{
@@ -610,10 +1052,46 @@ class Mesh
 					data_counter++;
 				}
 			}
+		}
 
-			m_vbos[vbo_count].num_vertices = iter->second.size () * 3;
-			m_vbos[vbo_count].material = iter->first;
-			m_vbos[vbo_count].vbo.load ((void *)&data[0], m_sizeof_render_data * iter->second.size () * 3, context_id);
+		/**
+		  * Returns true if VBO i is on the context.
+		  */
+		bool isLoaded (size_t i, int context_id) const
+		{
+			if (m_arena)
+			{
+				return m_vbos[i].range.contains (context_id) && m_vbos[i].range[context_id] != NULL;
+			}
+			return m_vbos[i].vbo.valid (context_id);
+		}
+
+		/**
+		  * Upload the staged data of VBO i to the context, in the arena if
+		  * there is one.
+		  */
+		void loadVBO (size_t i, int context_id)
+		{
+			if (!m_arena)
+			{
+				m_vbos[i].vbo.load (m_staged[i].data (), m_staged[i].size (), context_id);
+				return;
+			}
+
+			BufferArena::Range *&range = m_vbos[i].range[context_id];
+			if (range && range->size != (GLsizeiptr)m_staged[i].size ())
+			{
+				m_arena->free (range, context_id);
+				range = NULL;
+			}
+			if (!range)
+			{
+				range = m_arena->allocate (m_staged[i].size (), context_id);
+			}
+			if (range)
+			{
+				m_arena->upload (*range, m_staged[i].data (), context_id);
+			}
 		}
 
 		/**
@@ -669,7 +1147,10 @@ class Mesh
 		// Data stored per vbo.
 		struct VBOData
 		{
+			VBOData (void) : range (true), num_vertices (0), material (NULL) {}
+
 			gfx::VertexBuffer vbo;	// VBO to render.
+			gfx::ContextBuffer <BufferArena::Range *> range;	// Or its range of the arena.
 			size_t num_vertices;	// Number of vertices in the VBO to render.
 			Material *material;		// Material attached to this VBO.
 		};
@@ -679,12 +1160,19 @@ class Mesh
 		std::vector <math::Vector <T, 3> >	m_vertices; 		  // Vertices read from the file.
 		std::vector <math::Vector <T, 3> >	m_normals;	 	      // Normals read from the file.
 		std::vector <math::Vector <T, 2> >	m_texture_coords;	  // Texture coordinates of the mesh.
+		math::Vector <T, 3>                 m_bounds_min;         // Minimum corner of the bounding box.
+		math::Vector <T, 3>                 m_bounds_max;         // Maximum corner of the bounding box.
 		size_t                              m_sizeof_render_data; // Size of the render data structure being used (either RenderData or RenderData2)
 		bool							 	m_use_normals;		  // Flag to determine if normals should be used or not;
 		bool							 	m_use_texture;		  // Flag to determine if tex coords should be used or not;
 		bool                                m_use_materials;      // Set GL state to use materials when rendering
 		bool                                m_use_tangents;       // Calculate and include tangents in the VBOs
+		bool                                m_use_atlas;          // Pack the textures into atlases and batch the materials
 		std::vector <VBOData> 				m_vbos;				  // VBOs created for this model.  Each material spawns a new VBO.
+		std::vector <size_t>				m_draw_order;		  // Indices of the VBOs, grouped by texture.
+		std::vector <std::vector <char> >	m_staged;			  // Interleaved data of each VBO, shared by the contexts.
+		std::mutex							m_vbo_mutex;		  // Held while a context checks for and creates its VBOs.
+		BufferArena							*m_arena;			  // Arena the VBOs are allocated from, if any.
 		gfx::ContextBuffer<GLint>			m_tangent_loc;        // Location of the attribute for tangents in a GLSL program
 
 };
@@ -0,0 +1,368 @@
+/*
+   Filename : Mipmap.cpp
+   Version  : 1.0
+
+   Purpose  : Resampling of BGRA images on the CPU: mipmap chains and
+              downscaling to the texture size limit.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <Mipmap.h>
+#include <ThreadPool.h>
+#include <VectorOps.h>
+#include <algorithm>
+#include <math.h>
+#include <thread>
+
+namespace gfx
+{
+
+namespace mipmap
+{
+
+namespace
+{
+
+const float PI = 3.14159265358979f;
+
+/**
+  * Lookup tables between 8 bit sRGB and linear values.
+  */
+struct Tables
+{
+	Tables (void)
+	{
+		for (int i = 0; i < 256; ++i)
+		{
+			float c = i / 255.0f;
+			to_linear[i] = c <= 0.04045f ? c / 12.92f : powf ((c + 0.055f) / 1.055f, 2.4f);
+		}
+		for (int i = 0; i < LINEAR_STEPS; ++i)
+		{
+			float c = i / (float)(LINEAR_STEPS - 1);
+			float s = c <= 0.0031308f ? c * 12.92f : 1.055f * powf (c, 1.0f / 2.4f) - 0.055f;
+			to_srgb[i] = (unsigned char)(s * 255.0f + 0.5f);
+		}
+	}
+
+	static const int LINEAR_STEPS = 4096;
+	float to_linear[256];
+	unsigned char to_srgb[LINEAR_STEPS];
+};
+
+const Tables &tables (void)
+{
+	static Tables instance;
+	return instance;
+}
+
+float sinc (float x)
+{
+	if (fabsf (x) < 1.0e-5f)
+	{
+		return 1.0f;
+	}
+	x *= PI;
+	return sinf (x) / x;
+}
+
+// Modified Bessel function of the first kind, order 0.
+float besselI0 (float x)
+{
+	float sum = 1.0f;
+	float term = 1.0f;
+	for (int k = 1; k < 16; ++k)
+	{
+		term *= (x / (2.0f * k)) * (x / (2.0f * k));
+		sum += term;
+	}
+	return sum;
+}
+
+float support (Filter filter)
+{
+	return filter == BOX ? 0.5f : 3.0f;
+}
+
+float weight (Filter filter, float x)
+{
+	x = fabsf (x);
+	switch (filter)
+	{
+		case BOX:
+			return x <= 0.5f ? 1.0f : 0.0f;
+		case KAISER:
+		{
+			const float alpha = 4.0f;
+			if (x >= 3.0f)
+			{
+				return 0.0f;
+			}
+			float t = x / 3.0f;
+			return sinc (x) * besselI0 (alpha * sqrtf (1.0f - t * t)) / besselI0 (alpha);
+		}
+		case LANCZOS:
+			return x < 3.0f ? sinc (x) * sinc (x / 3.0f) : 0.0f;
+	}
+	return 0.0f;
+}
+
+/**
+  * Taps of one axis: the source texels each output texel blends.
+  */
+struct Taps
+{
+	std::vector <int> 	first;		// First source texel of each output texel.
+	std::vector <int> 	count;
+	std::vector <float> weights;	// count weights per output texel, max_count apart.
+	int 				max_count;
+};
+
+void makeTaps (int size, int out_size, Filter filter, Taps &taps)
+{
+	// Downscaling widens the filter to cover the texels merged; upscaling
+	// keeps its width.
+	const float scale = (float)size / out_size;
+	const float filter_scale = std::max (scale, 1.0f);
+	const float radius = support (filter) * filter_scale;
+	taps.max_count = (int)ceilf (radius * 2.0f) + 1;
+	taps.first.resize (out_size);
+	taps.count.resize (out_size);
+	taps.weights.assign ((size_t)out_size * taps.max_count, 0.0f);
+
+	for (int i = 0; i < out_size; ++i)
+	{
+		float center = (i + 0.5f) * scale - 0.5f;
+		int first = (int)ceilf (center - radius);
+		int last = (int)floorf (center + radius);
+		float *weights = &taps.weights[(size_t)i * taps.max_count];
+		float total = 0.0f;
+		int count = 0;
+		for (int j = first; j <= last && count < taps.max_count; ++j, ++count)
+		{
+			weights[count] = weight (filter, (j - center) / filter_scale);
+			total += weights[count];
+		}
+
+		// Texels past the edges repeat the edge; fold them in so that the
+		// taps stay within the image.
+		int start = std::max (first, 0);
+		int end = std::min (first + count, size);
+		if (end <= start)
+		{
+			start = std::min (std::max (first, 0), size - 1);
+			end = start + 1;
+		}
+		std::vector <float> folded (end - start, 0.0f);
+		for (int k = 0; k < count; ++k)
+		{
+			int j = std::min (std::max (first + k, start), end - 1);
+			folded[j - start] += weights[k];
+		}
+		if (total == 0.0f)
+		{
+			folded.assign (end - start, 0.0f);
+			folded[0] = total = 1.0f;
+		}
+
+		std::fill (weights, weights + taps.max_count, 0.0f);
+		for (int k = 0; k < end - start; ++k)
+		{
+			weights[k] = folded[k] / total;
+		}
+		taps.first[i] = start;
+		taps.count[i] = end - start;
+	}
+}
+
+/**
+  * Filter a source row of width texels horizontally into float texels, one
+  * per tap.
+  */
+void filterRow (const unsigned char *row, GLsizei width, const Taps &taps, bool srgb, float *linear, float *out)
+{
+	const Tables &t = tables ();
+
+	// Convert the row once, rather than per tap.
+	for (int x = 0; x < width; ++x)
+	{
+		const unsigned char *texel = row + x * 4;
+		for (int c = 0; c < 3; ++c)
+		{
+			linear[x * 4 + c] = srgb ? t.to_linear[texel[c]] : texel[c] / 255.0f;
+		}
+		linear[x * 4 + 3] = texel[3] / 255.0f;
+	}
+
+	for (size_t i = 0; i < taps.first.size (); ++i)
+	{
+		const float *weights = &taps.weights[i * taps.max_count];
+		const float *source = linear + taps.first[i] * 4;
+#ifdef MATH_USE_SSE
+		__m128 sum = _mm_setzero_ps ();
+		for (int k = 0; k < taps.count[i]; ++k)
+		{
+			sum = _mm_add_ps (sum, _mm_mul_ps (_mm_set1_ps (weights[k]), _mm_loadu_ps (source + k * 4)));
+		}
+		_mm_storeu_ps (out + i * 4, sum);
+#else
+		float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		for (int k = 0; k < taps.count[i]; ++k)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				sum[c] += weights[k] * source[k * 4 + c];
+			}
+		}
+		for (int c = 0; c < 4; ++c)
+		{
+			out[i * 4 + c] = sum[c];
+		}
+#endif
+	}
+}
+
+inline unsigned char toByte (float value, bool srgb)
+{
+	value = std::min (std::max (value, 0.0f), 1.0f);
+	if (srgb)
+	{
+		return tables ().to_srgb[(int)(value * (Tables::LINEAR_STEPS - 1) + 0.5f)];
+	}
+	return (unsigned char)(value * 255.0f + 0.5f);
+}
+
+/**
+  * Produce output rows [first, last).  Horizontally filtered source rows
+  * are kept in a ring, as consecutive output rows share most of them.
+  */
+void resampleRows (const unsigned char *bits, GLsizei width, size_t pitch,
+                   unsigned char *out, GLsizei out_width,
+                   const Taps *x_taps, const Taps *y_taps, bool srgb, int first, int last)
+{
+	const int ring_size = y_taps->max_count + 1;
+	std::vector <float> ring ((size_t)ring_size * out_width * 4);
+	std::vector <int> ring_rows (ring_size, -1);
+	std::vector <float> linear ((size_t)width * 4);
+	std::vector <const float *> rows (y_taps->max_count);
+
+	for (int y = first; y < last; ++y)
+	{
+		const int count = y_taps->count[y];
+		for (int k = 0; k < count; ++k)
+		{
+			int source = y_taps->first[y] + k;
+			int slot = source % ring_size;
+			float *filtered = &ring[(size_t)slot * out_width * 4];
+			if (ring_rows[slot] != source)
+			{
+				filterRow (bits + source * pitch, width, *x_taps, srgb, &linear[0], filtered);
+				ring_rows[slot] = source;
+			}
+			rows[k] = filtered;
+		}
+
+		const float *weights = &y_taps->weights[(size_t)y * y_taps->max_count];
+		unsigned char *row_out = out + (size_t)y * out_width * 4;
+		for (GLsizei x = 0; x < out_width; ++x)
+		{
+			float sum[4];
+#ifdef MATH_USE_SSE
+			__m128 total = _mm_setzero_ps ();
+			for (int k = 0; k < count; ++k)
+			{
+				total = _mm_add_ps (total, _mm_mul_ps (_mm_set1_ps (weights[k]), _mm_loadu_ps (rows[k] + x * 4)));
+			}
+			_mm_storeu_ps (sum, total);
+#else
+			sum[0] = sum[1] = sum[2] = sum[3] = 0.0f;
+			for (int k = 0; k < count; ++k)
+			{
+				for (int c = 0; c < 4; ++c)
+				{
+					sum[c] += weights[k] * rows[k][x * 4 + c];
+				}
+			}
+#endif
+			for (int c = 0; c < 3; ++c)
+			{
+				row_out[x * 4 + c] = toByte (sum[c], srgb);
+			}
+			row_out[x * 4 + 3] = toByte (sum[3], false);
+		}
+	}
+}
+
+}
+
+void resample (const unsigned char *bits, GLsizei width, GLsizei height, size_t pitch,
+               unsigned char *out, GLsizei out_width, GLsizei out_height,
+               Filter filter, bool srgb, unsigned int threads)
+{
+	Taps x_taps, y_taps;
+	makeTaps (width, out_width, filter, x_taps);
+	makeTaps (height, out_height, filter, y_taps);
+
+	// Small images are not worth a thread, and neither is a pool job: the
+	// loader builds one chain per worker already.
+	if (threads == 0)
+	{
+		threads = util::ThreadPool::isWorker () ? 1 : std::max (std::thread::hardware_concurrency (), 1u);
+	}
+	threads = std::min (threads, (unsigned int)std::max (out_height / 64, 1));
+	if (threads == 1)
+	{
+		resampleRows (bits, width, pitch, out, out_width, &x_taps, &y_taps, srgb, 0, out_height);
+		return;
+	}
+
+	std::vector <std::thread> workers;
+	for (unsigned int i = 0; i < threads; ++i)
+	{
+		int first = out_height * i / threads;
+		int last = out_height * (i + 1) / threads;
+		workers.push_back (std::thread (resampleRows, bits, width, pitch, out, out_width, &x_taps, &y_taps, srgb, first, last));
+	}
+	for (size_t i = 0; i < workers.size (); ++i)
+	{
+		workers[i].join ();
+	}
+}
+
+void buildChain (const unsigned char *bits, GLsizei width, GLsizei height, size_t pitch,
+                 std::vector <std::vector <unsigned char> > &levels,
+                 Filter filter, bool srgb, unsigned int threads)
+{
+	levels.clear ();
+	while (width > 1 || height > 1)
+	{
+		GLsizei level_width = std::max (width / 2, 1);
+		GLsizei level_height = std::max (height / 2, 1);
+		levels.push_back (std::vector <unsigned char> ((size_t)level_width * level_height * 4));
+		resample (bits, width, height, pitch, &levels.back ()[0], level_width, level_height, filter, srgb, threads);
+
+		bits = &levels.back ()[0];
+		pitch = level_width * 4;
+		width = level_width;
+		height = level_height;
+	}
+}
+
+void fitSize (GLsizei width, GLsizei height, GLint max_size, GLsizei &out_width, GLsizei &out_height)
+{
+	out_width = width;
+	out_height = height;
+	if (width > max_size || height > max_size)
+	{
+		double scale = (double)max_size / std::max (width, height);
+		out_width = std::min (std::max ((GLsizei)(width * scale + 0.5), 1), (GLsizei)max_size);
+		out_height = std::min (std::max ((GLsizei)(height * scale + 0.5), 1), (GLsizei)max_size);
+	}
+}
+
+}
+
+}
@@ -0,0 +1,67 @@
+/*
+   Filename : Mipmap.h
+   Version  : 1.0
+
+   Purpose  : Resampling of BGRA images on the CPU: mipmap chains and
+              downscaling to the texture size limit.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+#include <stddef.h>
+#include <vector>
+
+namespace gfx
+{
+
+namespace mipmap
+{
+
+/**
+  * Filters to resample with.  BOX averages the texels a texel covers, as
+  * glGenerateMipmap does; KAISER and LANCZOS are windowed sincs three
+  * texels wide, sharper at the cost of some ringing (LANCZOS more so).
+  */
+enum Filter
+{
+	BOX,
+	KAISER,
+	LANCZOS
+};
+
+/**
+  * Resample a 32 bit BGRA image, as FreeImage lays it out, to another size.
+  * Rows are split between threads.
+  * @param pitch Bytes from one row of bits to the next.
+  * @param out Receives out_width x out_height texels, tightly packed.
+  * @param srgb Filter the color channels in linear space, for images
+  *        stored in sRGB; alpha is always linear.
+  * @param threads Threads to use; 0 for one per hardware thread, or just
+  *        the caller's on a util::ThreadPool worker.
+  */
+void resample (const unsigned char *bits, GLsizei width, GLsizei height, size_t pitch,
+               unsigned char *out, GLsizei out_width, GLsizei out_height,
+               Filter filter, bool srgb, unsigned int threads = 0);
+
+/**
+  * Build the mipmap chain of an image, each level from the one before.
+  * @param levels Receives levels 1 and up, tightly packed.
+  */
+void buildChain (const unsigned char *bits, GLsizei width, GLsizei height, size_t pitch,
+                 std::vector <std::vector <unsigned char> > &levels,
+                 Filter filter, bool srgb, unsigned int threads = 0);
+
+/**
+  * Size of an image scaled down, keeping its aspect, to fit max_size.
+  * Images that already fit keep their size.
+  */
+void fitSize (GLsizei width, GLsizei height, GLint max_size, GLsizei &out_width, GLsizei &out_height);
+
+}
+
+}
@@ -0,0 +1,347 @@
+/*
+   Filename : OcclusionCuller.cpp
+   Version  : 1.0
+
+   Purpose  : Software occlusion culling with a hierarchical depth buffer.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <OcclusionCuller.h>
+#include <math.h>
+
+namespace gfx
+{
+
+namespace
+{
+
+// Clip space w below which a vertex counts as behind the eye.
+const float min_w = 1.0e-5f;
+
+/**
+  * Transform p by the OpenGL layout matrix m (m * p in OpenGL terms).
+  */
+inline math::vec4f toClip (const float *m, float x, float y, float z)
+{
+	return math::vec4f (m[0] * x + m[4] * y + m[8]  * z + m[12],
+	                    m[1] * x + m[5] * y + m[9]  * z + m[13],
+	                    m[2] * x + m[6] * y + m[10] * z + m[14],
+	                    m[3] * x + m[7] * y + m[11] * z + m[15]);
+}
+
+}
+
+OcclusionCuller::OcclusionCuller (int width, int height)
+	: m_tested (0),
+	  m_culled (0)
+{
+	resize (width, height);
+}
+
+OcclusionCuller::~OcclusionCuller (void)
+{
+	wait ();
+}
+
+void OcclusionCuller::resize (int width, int height)
+{
+	m_width = std::max (4, (width + 3) & ~3);
+	m_height = std::max (1, height);
+
+	m_levels.clear ();
+	m_level_width.clear ();
+	m_level_height.clear ();
+
+	int w = m_width;
+	int h = m_height;
+	for (;;)
+	{
+		m_levels.push_back (std::vector <float> (w * h, 1.0f));
+		m_level_width.push_back (w);
+		m_level_height.push_back (h);
+		if (w == 1 && h == 1)
+		{
+			break;
+		}
+		w = (w + 1) / 2;
+		h = (h + 1) / 2;
+	}
+}
+
+void OcclusionCuller::begin (const math::Matrixf &view_projection, const std::vector <const Occluder *> &occluders, util::ThreadPool &pool)
+{
+	setup (view_projection, occluders);
+
+	// One band of rows per worker.  The bands share nothing but the
+	// transformed vertices, which are only read.
+	int bands = std::max (1, std::min ((int)pool.size (), m_height));
+	for (int i = 0; i < bands; ++i)
+	{
+		int y_begin = m_height * i / bands;
+		int y_end = m_height * (i + 1) / bands;
+		m_jobs.push_back (pool.submit (std::bind (&OcclusionCuller::rasterizeBand, this, y_begin, y_end)));
+	}
+}
+
+void OcclusionCuller::rasterize (const math::Matrixf &view_projection, const std::vector <const Occluder *> &occluders)
+{
+	setup (view_projection, occluders);
+	rasterizeBand (0, m_height);
+	buildPyramid ();
+}
+
+void OcclusionCuller::finish (void)
+{
+	wait ();
+	buildPyramid ();
+}
+
+bool OcclusionCuller::isOccluded (const math::vec3f &min, const math::vec3f &max) const
+{
+	++m_tested;
+
+	const float *m = m_view_projection.data ();
+	float x0 = 1.0e30f, y0 = 1.0e30f, x1 = -1.0e30f, y1 = -1.0e30f;
+	float nearest = 1.0e30f;
+	for (int i = 0; i < 8; ++i)
+	{
+		math::vec4f clip = toClip (m, (i & 1) ? max[0] : min[0], (i & 2) ? max[1] : min[1], (i & 4) ? max[2] : min[2]);
+		if (clip[3] < min_w)
+		{
+			return false;
+		}
+
+		float inv_w = 1.0f / clip[3];
+		float x = (clip[0] * inv_w * 0.5f + 0.5f) * m_width;
+		float y = (clip[1] * inv_w * 0.5f + 0.5f) * m_height;
+		x0 = std::min (x0, x);
+		x1 = std::max (x1, x);
+		y0 = std::min (y0, y);
+		y1 = std::max (y1, y);
+		nearest = std::min (nearest, clip[2] * inv_w);
+	}
+
+	// Off screen is the frustum's business.
+	if (x1 < 0.0f || y1 < 0.0f || x0 >= m_width || y0 >= m_height)
+	{
+		return false;
+	}
+
+	int px0 = std::max (0, (int)x0);
+	int py0 = std::max (0, (int)y0);
+	int px1 = std::min (m_width - 1, (int)x1);
+	int py1 = std::min (m_height - 1, (int)y1);
+
+	// Go up the pyramid until the box covers at most 2x2 texels.
+	int level = 0;
+	while (level + 1 < (int)m_levels.size () &&
+	       ((px1 >> level) - (px0 >> level) > 1 || (py1 >> level) - (py0 >> level) > 1))
+	{
+		++level;
+	}
+
+	const std::vector <float> &depth = m_levels[level];
+	int width = m_level_width[level];
+	float farthest = -1.0f;
+	for (int y = py0 >> level; y <= (py1 >> level); ++y)
+	{
+		for (int x = px0 >> level; x <= (px1 >> level); ++x)
+		{
+			farthest = std::max (farthest, depth[y * width + x]);
+		}
+	}
+
+	if (nearest > farthest)
+	{
+		++m_culled;
+		return true;
+	}
+	return false;
+}
+
+void OcclusionCuller::setup (const math::Matrixf &view_projection, const std::vector <const Occluder *> &occluders)
+{
+	// A previous begin () must be finished before the vertices change.
+	wait ();
+
+	m_view_projection = view_projection;
+	m_screen.clear ();
+	for (size_t i = 0; i < occluders.size (); ++i)
+	{
+		const Occluder &occluder = *occluders[i];
+
+		// Matrix::operator* multiplies the stored arrays, so this is
+		// view_projection * transform in OpenGL terms.
+		math::Matrixf matrix = occluder.transform ? *occluder.transform * view_projection : view_projection;
+		const float *m = matrix.data ();
+
+		for (size_t j = 0; j < occluder.triangles.size (); ++j)
+		{
+			const math::vec3f &v = occluder.triangles[j];
+			math::vec4f clip = toClip (m, v[0], v[1], v[2]);
+			if (clip[3] < min_w)
+			{
+				m_screen.push_back (math::vec4f (0.0f, 0.0f, 0.0f, 0.0f));
+				continue;
+			}
+
+			float inv_w = 1.0f / clip[3];
+			m_screen.push_back (math::vec4f ((clip[0] * inv_w * 0.5f + 0.5f) * m_width,
+			                                 (clip[1] * inv_w * 0.5f + 0.5f) * m_height,
+			                                 clip[2] * inv_w,
+			                                 1.0f));
+		}
+	}
+}
+
+void OcclusionCuller::wait (void)
+{
+	for (size_t i = 0; i < m_jobs.size (); ++i)
+	{
+		m_jobs[i].wait ();
+	}
+	m_jobs.clear ();
+}
+
+/**
+  * Rasterize every occluder triangle into rows [y_begin, y_end) of the
+  * depth buffer, keeping the nearest depth at each pixel center.
+  */
+void OcclusionCuller::rasterizeBand (int y_begin, int y_end)
+{
+	float *depth = &m_levels[0][0];
+	std::fill (depth + y_begin * m_width, depth + y_end * m_width, 1.0f);
+
+	for (size_t t = 0; t + 2 < m_screen.size (); t += 3)
+	{
+		math::vec4f v0 = m_screen[t];
+		math::vec4f v1 = m_screen[t + 1];
+		math::vec4f v2 = m_screen[t + 2];
+
+		// Triangles reaching behind the eye are skipped: an occluder left out
+		// only hides less.
+		if (v0[3] == 0.0f || v1[3] == 0.0f || v2[3] == 0.0f)
+		{
+			continue;
+		}
+
+		float area = (v1[0] - v0[0]) * (v2[1] - v0[1]) - (v2[0] - v0[0]) * (v1[1] - v0[1]);
+		if (area == 0.0f)
+		{
+			continue;
+		}
+		if (area < 0.0f)
+		{
+			std::swap (v1, v2);
+			area = -area;
+		}
+
+		int x_min = std::max (0, (int)floorf (std::min (v0[0], std::min (v1[0], v2[0]))));
+		int x_max = std::min (m_width - 1, (int)ceilf (std::max (v0[0], std::max (v1[0], v2[0]))));
+		int y_min = std::max (y_begin, (int)floorf (std::min (v0[1], std::min (v1[1], v2[1]))));
+		int y_max = std::min (y_end - 1, (int)ceilf (std::max (v0[1], std::max (v1[1], v2[1]))));
+		if (x_min > x_max || y_min > y_max)
+		{
+			continue;
+		}
+
+		// Edge functions e = a * x + b * y + c, non-negative inside, and the
+		// depth plane z = z0 + dzdx * (x - x0) + dzdy * (y - y0).
+		const math::vec4f *v[3] = { &v0, &v1, &v2 };
+		float a[3], b[3], c[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			const math::vec4f &p = *v[i];
+			const math::vec4f &q = *v[(i + 1) % 3];
+			a[i] = p[1] - q[1];
+			b[i] = q[0] - p[0];
+			c[i] = -a[i] * p[0] - b[i] * p[1];
+		}
+		float inv_area = 1.0f / area;
+		float dzdx = ((v1[2] - v0[2]) * (v2[1] - v0[1]) - (v2[2] - v0[2]) * (v1[1] - v0[1])) * inv_area;
+		float dzdy = ((v2[2] - v0[2]) * (v1[0] - v0[0]) - (v1[2] - v0[2]) * (v2[0] - v0[0])) * inv_area;
+		float z_c = v0[2] - dzdx * v0[0] - dzdy * v0[1];
+
+		// Rows are processed four pixels at a time from a multiple of 4; the
+		// buffer width is a multiple of 4, so no store leaves the row.
+		int x_start = x_min & ~3;
+		for (int y = y_min; y <= y_max; ++y)
+		{
+			float py = y + 0.5f;
+			float *row = depth + y * m_width;
+#ifdef MATH_USE_SSE
+			__m128 px = _mm_add_ps (_mm_set1_ps (x_start + 0.5f), _mm_set_ps (3.0f, 2.0f, 1.0f, 0.0f));
+			__m128 e0 = _mm_add_ps (_mm_mul_ps (_mm_set1_ps (a[0]), px), _mm_set1_ps (b[0] * py + c[0]));
+			__m128 e1 = _mm_add_ps (_mm_mul_ps (_mm_set1_ps (a[1]), px), _mm_set1_ps (b[1] * py + c[1]));
+			__m128 e2 = _mm_add_ps (_mm_mul_ps (_mm_set1_ps (a[2]), px), _mm_set1_ps (b[2] * py + c[2]));
+			__m128 z = _mm_add_ps (_mm_mul_ps (_mm_set1_ps (dzdx), px), _mm_set1_ps (dzdy * py + z_c));
+			__m128 step0 = _mm_set1_ps (a[0] * 4.0f);
+			__m128 step1 = _mm_set1_ps (a[1] * 4.0f);
+			__m128 step2 = _mm_set1_ps (a[2] * 4.0f);
+			__m128 step_z = _mm_set1_ps (dzdx * 4.0f);
+			const __m128 zero = _mm_setzero_ps ();
+
+			for (int x = x_start; x <= x_max; x += 4)
+			{
+				__m128 inside = _mm_and_ps (_mm_and_ps (_mm_cmpge_ps (e0, zero), _mm_cmpge_ps (e1, zero)), _mm_cmpge_ps (e2, zero));
+				if (_mm_movemask_ps (inside))
+				{
+					__m128 old = _mm_loadu_ps (row + x);
+					__m128 nearer = _mm_min_ps (old, z);
+					_mm_storeu_ps (row + x, _mm_or_ps (_mm_and_ps (inside, nearer), _mm_andnot_ps (inside, old)));
+				}
+				e0 = _mm_add_ps (e0, step0);
+				e1 = _mm_add_ps (e1, step1);
+				e2 = _mm_add_ps (e2, step2);
+				z = _mm_add_ps (z, step_z);
+			}
+#else
+			for (int x = x_start; x <= x_max; ++x)
+			{
+				float px = x + 0.5f;
+				if (a[0] * px + b[0] * py + c[0] >= 0.0f &&
+				    a[1] * px + b[1] * py + c[1] >= 0.0f &&
+				    a[2] * px + b[2] * py + c[2] >= 0.0f)
+				{
+					row[x] = std::min (row[x], dzdx * px + dzdy * py + z_c);
+				}
+			}
+#endif
+		}
+	}
+}
+
+/**
+  * Each texel of a level is the farthest depth of the (up to) 2x2 texels
+  * below it.
+  */
+void OcclusionCuller::buildPyramid (void)
+{
+	for (size_t level = 1; level < m_levels.size (); ++level)
+	{
+		const std::vector <float> &below = m_levels[level - 1];
+		std::vector <float> &current = m_levels[level];
+		int below_width = m_level_width[level - 1];
+		int below_height = m_level_height[level - 1];
+		int width = m_level_width[level];
+		int height = m_level_height[level];
+
+		for (int y = 0; y < height; ++y)
+		{
+			int y0 = y * 2;
+			int y1 = std::min (y0 + 1, below_height - 1);
+			for (int x = 0; x < width; ++x)
+			{
+				int x0 = x * 2;
+				int x1 = std::min (x0 + 1, below_width - 1);
+				current[y * width + x] = std::max (std::max (below[y0 * below_width + x0], below[y0 * below_width + x1]),
+				                                   std::max (below[y1 * below_width + x0], below[y1 * below_width + x1]));
+			}
+		}
+	}
+}
+
+}
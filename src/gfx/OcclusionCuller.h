@@ -0,0 +1,175 @@
+/*
+   Filename : OcclusionCuller.h
+   Version  : 1.0
+
+   Purpose  : Software occlusion culling.  A few occluder meshes are
+              rasterized on the CPU into a small depth buffer, a max-depth
+              pyramid (hierarchical Z) is built from it, and bounding boxes
+              are tested against the pyramid before anything is submitted
+              to OpenGL.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#pragma once
+
+#include <Vector.h>
+#include <Matrix.h>
+#include <Mesh.h>
+#include <ThreadPool.h>
+#include <algorithm>
+#include <functional>
+#include <future>
+#include <vector>
+
+namespace gfx
+{
+
+/**
+  * Occluder geometry: triangles, three vertices each, in the space of
+  * transform.  Occluders only ever hide things, so a simplified occluder
+  * must lie inside the object it stands for.
+  */
+struct Occluder
+{
+	Occluder (void) : transform (NULL) {}
+
+	std::vector <math::vec3f> triangles;
+	const math::Matrixf *transform;		// OpenGL layout, or NULL for world space.
+};
+
+/**
+  * Culls boxes hidden behind occluders, for one context.
+  */
+class OcclusionCuller
+{
+	public:
+
+		/**
+		  * Constructor.
+		  * @param width Width of the depth buffer, rounded up to a multiple of 4.
+		  * @param height Height of the depth buffer.
+		  */
+		OcclusionCuller (int width = 256, int height = 128);
+
+		/**
+		  * Destructor.  Waits for unfinished rasterization.
+		  */
+		~OcclusionCuller (void);
+
+		/**
+		  * Change the size of the depth buffer.
+		  */
+		void resize (int width, int height);
+
+		/**
+		  * Start rasterizing occluders as seen through view_projection (the
+		  * stored product modelview * projection, see Frustum), split into
+		  * horizontal bands over the pool's workers.  The occluders must stay
+		  * alive until finish ().
+		  */
+		void begin (const math::Matrixf &view_projection, const std::vector <const Occluder *> &occluders, util::ThreadPool &pool);
+
+		/**
+		  * Rasterize on the calling thread.
+		  */
+		void rasterize (const math::Matrixf &view_projection, const std::vector <const Occluder *> &occluders);
+
+		/**
+		  * Wait for the rasterization started by begin () and build the
+		  * depth pyramid.
+		  */
+		void finish (void);
+
+		/**
+		  * Test a world space box.  Returns true when the box is completely
+		  * behind the occluders.  Boxes crossing the near plane are never
+		  * occluded.
+		  */
+		bool isOccluded (const math::vec3f &min, const math::vec3f &max) const;
+
+		/**
+		  * Number of boxes tested and found occluded since resetStats ().
+		  */
+		size_t getTestedCount (void) const { return m_tested; }
+		size_t getCulledCount (void) const { return m_culled; }
+		void resetStats (void) { m_tested = 0; m_culled = 0; }
+
+		int getWidth (void) const { return m_width; }
+		int getHeight (void) const { return m_height; }
+
+		/**
+		  * Depth buffer (level 0) or a pyramid level, row major, normalized
+		  * device depth.
+		  */
+		const float *getLevel (int level) const { return &m_levels[level][0]; }
+		int getLevelCount (void) const { return (int)m_levels.size (); }
+
+	private:
+
+		OcclusionCuller (const OcclusionCuller &);
+		OcclusionCuller &operator= (const OcclusionCuller &);
+
+		void wait (void);
+		void setup (const math::Matrixf &view_projection, const std::vector <const Occluder *> &occluders);
+		void rasterizeBand (int y_begin, int y_end);
+		void buildPyramid (void);
+
+		int 							   m_width;
+		int 							   m_height;
+		std::vector <std::vector <float> > m_levels;		// Max-depth pyramid, level 0 is the depth buffer.
+		std::vector <int> 				   m_level_width;
+		std::vector <int> 				   m_level_height;
+		std::vector <math::vec4f> 		   m_screen;		// Occluder vertices in pixels and depth; w is 0 behind the eye.
+		math::Matrixf 					   m_view_projection;
+		std::vector <std::future <void> >  m_jobs;
+		mutable size_t 					   m_tested;
+		mutable size_t 					   m_culled;
+};
+
+/**
+  * Build an occluder from the largest triangles of a mesh.  A subset of the
+  * mesh's own surface never hides anything the mesh does not.
+  * @param mesh Mesh whose triangles are still in memory.
+  * @param max_triangles Number of triangles to keep.
+  * @param transform Transform of the mesh, or NULL.
+  */
+template <class T>
+Occluder makeOccluder (Mesh <T> &mesh, size_t max_triangles, const math::Matrixf *transform)
+{
+	std::vector <std::pair <float, const Triangle <T> *> > triangles;
+	for (typename Mesh <T>::TriangleIterator iter = mesh.begin (); iter != mesh.end (); ++iter)
+	{
+		for (size_t i = 0; i < iter->second.size (); ++i)
+		{
+			const Triangle <T> &triangle = iter->second[i];
+			math::Vector <T, 3> normal = math::cross (triangle.m_vertices[1] - triangle.m_vertices[0],
+			                                          triangle.m_vertices[2] - triangle.m_vertices[0]);
+			triangles.push_back (std::make_pair ((float)math::length2 (normal), &triangle));
+		}
+	}
+
+	if (triangles.size () > max_triangles)
+	{
+		std::nth_element (triangles.begin (), triangles.begin () + max_triangles, triangles.end (),
+		                  std::greater <std::pair <float, const Triangle <T> *> > ());
+		triangles.resize (max_triangles);
+	}
+
+	Occluder occluder;
+	occluder.transform = transform;
+	occluder.triangles.reserve (triangles.size () * 3);
+	for (size_t i = 0; i < triangles.size (); ++i)
+	{
+		for (int j = 0; j < 3; ++j)
+		{
+			const math::Vector <T, 3> &v = triangles[i].second->m_vertices[j];
+			occluder.triangles.push_back (math::vec3f ((float)v[0], (float)v[1], (float)v[2]));
+		}
+	}
+	return occluder;
+}
+
+}
@@ -96,6 +96,19 @@ void Program::set1f(const char* name, float f) const
 	}
 }
 
+void Program::set2fv(const char* name, const float *f) const
+{
+	CacheIterator iter = _uniformCache.find (name);
+	if (iter != _uniformCache.end())
+	{
+		glUniform2fv(iter->second, 1, f);
+	}
+	else
+	{
+		//cout << "set2fv error: " << name << endl;
+	}
+}
+
 void Program::set3dv(const char* name, double *d) const
 {
 	CacheIterator iter = _uniformCache.find (name);
@@ -72,6 +72,13 @@ class Program
 		  */
 		void set1f(const char* name, float f) const;
 
+		/**
+		  * Set a 2 component float uniform in the program.
+		  * @param name Name of the uniform.
+		  * @param f Value of the uniform.
+		  */
+		void set2fv(const char* name, const float *f) const;
+
 		/**
 		  * Set 3 component double uniform in the program.
 		  * @param name Name of the uniform.
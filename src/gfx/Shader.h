@@ -44,6 +44,11 @@ class Shader
 		 */
 		void load(const char* filename);
 
+		/**
+		 * Use source as the shader code, in place of a file.
+		 */
+		void setSource(const std::string& source) { _source = source; }
+
 		/**
 		  * Initialize the shader for use.
 		  */
@@ -14,6 +14,8 @@
 #include <iostream>
 
 #include <Skybox.h>
+#include <TextureLoader.h>
+#include <Geometry.h>
 #include <file.h>
 #include <cavr/gfx/renderer.h>
 
@@ -25,8 +27,12 @@ using util::fileExists;
 namespace gfx
 {
 
+// File names of the images, in the order of _images.
+static const char* face_names[6] = { "posx", "negx", "posy", "negy", "posz", "negz" };
+
 // Default constructor
 Skybox::Skybox (void)
+	: _lists(true)
 {
 	//_position		 = math::vec3f (0.0f, 0.0f, 0.0f);
 	_scale           = 1.0f;
@@ -39,6 +45,34 @@ Skybox::~Skybox (void)
 
 // Initilize the skybox with a directory to load image files from.
 void Skybox::load (const std::string& dir)
+{
+	std::string suffix;
+	std::string prefix = findImages(dir, suffix);
+
+	// Load the images.
+	for (int i = 0; i < 6; ++i)
+	{
+		_images[i].load((prefix + face_names[i] + suffix).c_str());
+	}
+}
+
+// Load the images on the pool, all at once.
+std::shared_future<void> Skybox::load (const std::string& dir, util::ThreadPool& pool)
+{
+	std::string suffix;
+	std::string prefix = findImages(dir, suffix);
+
+	TextureLoader loader(pool);
+	for (int i = 0; i < 6; ++i)
+	{
+		loader.load(_images[i], prefix + face_names[i] + suffix);
+	}
+
+	return loader.finish();
+}
+
+// Find the image type and set the image parameters.
+std::string Skybox::findImages (const std::string& dir, std::string& suffix)
 {
 	std::string type;
 
@@ -66,24 +100,18 @@ void Skybox::load (const std::string& dir)
 		exit(1);
 	}
 
-	std::string prefix = dir + "/";
-	std::string suffix = "." + type;
+	suffix = "." + type;
 
 	gfx::Texture::Params p;
 	p.wrapS = GL_CLAMP; // removes seams
 	p.wrapT = GL_CLAMP;
 	p.envMode = GL_DECAL;
+	p.compressedFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
 	//p.minFilter = GL_LINEAR; // experiment with these
 	//p.magFilter = GL_LINEAR;
 	for (int i = 0; i < 6; ++i) _images[i].setParams(p);
 
-	// Load the images.
-	_images[0].load((prefix + "posx" + suffix).c_str());
-	_images[1].load((prefix + "negx" + suffix).c_str());
-	_images[2].load((prefix + "posy" + suffix).c_str());
-	_images[3].load((prefix + "negy" + suffix).c_str());
-	_images[4].load((prefix + "posz" + suffix).c_str());
-	_images[5].load((prefix + "negz" + suffix).c_str());
+	return dir + "/";
 }
 
 // Create the new graphics context.
@@ -95,6 +123,38 @@ void Skybox::initContext(int context_id)
 	_images[3].createTextureObject(context_id);
 	_images[4].createTextureObject(context_id);
 	_images[5].createTextureObject(context_id);
+
+	createList(context_id);
+}
+
+// Queue the texture uploads; render () creates the list once they are done.
+void Skybox::queueUploads (UploadQueue& queue, int context_id, std::shared_future<void> decoded)
+{
+	for (int i = 0; i < 6; ++i)
+	{
+		queue.push(new TextureUpload(_images[i], context_id, decoded));
+	}
+}
+
+// Compile the box into a display list.
+void Skybox::createList (int context_id)
+{
+	// Nothing in the box changes but its position, so the faces and their
+	// state are submitted once and replayed for every eye and frame.
+	std::lock_guard<std::mutex> lock(_list_mutex);
+	if (_lists[context_id] != 0 && ShareGroup::isMember(context_id))
+	{
+		return;
+	}
+
+	GLuint list = glGenLists(1);
+	if (list != 0)
+	{
+		glNewList(list, GL_COMPILE);
+		drawBox(context_id);
+		glEndList();
+	}
+	_lists[context_id] = list;
 }
 
 // Remove the created graphics context.
@@ -106,11 +166,37 @@ void Skybox::destroyContext (int context_id)
 	_images[3].destroyContext(context_id);
 	_images[4].destroyContext(context_id);
 	_images[5].destroyContext(context_id);
+
+	if (_lists.isLastUser(context_id))
+	{
+		GLuint list = _lists[context_id];
+		if (list != 0)
+		{
+			glDeleteLists(list, 1);
+		}
+		_lists.remove(context_id);
+	}
 }
 
 // Render the skybox around the camera.
 void Skybox::render (int context_id)
 {
+	GLuint list = _lists[context_id];
+	if (list == 0)
+	{
+		// Draw nothing until every face is uploaded.
+		for (int i = 0; i < 6; ++i)
+		{
+			if (!_images[i].valid(context_id))
+			{
+				return;
+			}
+		}
+
+		createList(context_id);
+		list = _lists[context_id];
+	}
+
 	vec3f& pos = _positions[context_id];
 
 	// Based on http://sidvind.com/wiki/Skybox_tutorial
@@ -120,6 +206,21 @@ void Skybox::render (int context_id)
 	glTranslatef(pos[0], pos[1], pos[2]);
 	glScalef(_scale, _scale, _scale);
 
+	if (list != 0)
+	{
+		glCallList(list);
+	}
+	else
+	{
+		drawBox(context_id);
+	}
+
+	glPopMatrix();	
+}
+
+// Issue the state changes and faces of the box.
+void Skybox::drawBox (int context_id)
+{
 	glPushAttrib(GL_ENABLE_BIT);
 
 	glActiveTexture(GL_TEXTURE0);
@@ -140,65 +241,24 @@ void Skybox::render (int context_id)
 
 	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_DECAL);
 
-	// Render the right quad (posx)
-	_images[0].bind(context_id);
-	glBegin(GL_QUADS);
-		glTexCoord2f(0, 0); glVertex3f(  0.5f, -0.5f, -0.5f );
-		glTexCoord2f(1, 0); glVertex3f(  0.5f, -0.5f,  0.5f );
-		glTexCoord2f(1, 1); glVertex3f(  0.5f,  0.5f,  0.5f );
-		glTexCoord2f(0, 1); glVertex3f(  0.5f,  0.5f, -0.5f );
-	glEnd();
-
-	// Render the left quad (negx)
-	_images[1].bind(context_id);
-	glBegin(GL_QUADS);
-		glTexCoord2f(0, 0); glVertex3f( -0.5f, -0.5f,  0.5f );
-		glTexCoord2f(1, 0); glVertex3f( -0.5f, -0.5f, -0.5f );
-		glTexCoord2f(1, 1); glVertex3f( -0.5f,  0.5f, -0.5f );
-		glTexCoord2f(0, 1); glVertex3f( -0.5f,  0.5f,  0.5f );
-	glEnd();
-	
-	// Render the top quad (posy)
-	_images[2].bind(context_id);
-	glBegin(GL_QUADS);
-		glTexCoord2f(0, 0); glVertex3f(  0.5f,  0.5f, -0.5f );
-		glTexCoord2f(1, 0); glVertex3f(  0.5f,  0.5f,  0.5f );
-		glTexCoord2f(1, 1); glVertex3f( -0.5f,  0.5f,  0.5f );
-		glTexCoord2f(0, 1); glVertex3f( -0.5f,  0.5f, -0.5f );
-	glEnd();
-
-	// Render the bottom quad (negy)
-	_images[3].bind(context_id);
-	glBegin(GL_QUADS);
-		glTexCoord2f(0, 0); glVertex3f( -0.5f, -0.5f, -0.5f );
-		glTexCoord2f(1, 0); glVertex3f( -0.5f, -0.5f,  0.5f );
-		glTexCoord2f(1, 1); glVertex3f(  0.5f, -0.5f,  0.5f );
-		glTexCoord2f(0, 1); glVertex3f(  0.5f, -0.5f, -0.5f );
-	glEnd();
-
-	// Render the back quad (posz)
-	_images[4].bind(context_id);
-	glBegin(GL_QUADS);
-		glTexCoord2f(0, 0); glVertex3f(  0.5f, -0.5f,  0.5f );
-		glTexCoord2f(1, 0); glVertex3f( -0.5f, -0.5f,  0.5f );
-		glTexCoord2f(1, 1); glVertex3f( -0.5f,  0.5f,  0.5f );
-		glTexCoord2f(0, 1); glVertex3f(  0.5f,  0.5f,  0.5f );
-	glEnd();
-
-	// Render the front quad (negz)
-	_images[5].bind(context_id);
-	glBegin(GL_QUADS);
-		glTexCoord2f(0, 0); glVertex3f( -0.5f, -0.5f, -0.5f );
-		glTexCoord2f(1, 0); glVertex3f(  0.5f, -0.5f, -0.5f );
-		glTexCoord2f(1, 1); glVertex3f(  0.5f,  0.5f, -0.5f );
-		glTexCoord2f(0, 1); glVertex3f( -0.5f,  0.5f, -0.5f );
-	glEnd();
+	// Render the quads in image order: posx, negx, posy, negy, posz, negz.
+	for (int face = 0; face < 6; ++face)
+	{
+		_images[face].bind(context_id);
+		glBegin(GL_QUADS);
+		for (int i = 0; i < 4; ++i)
+		{
+			const geometry::SkyboxVertex &vertex = geometry::skybox_faces[face][i];
+			glTexCoord2fv(vertex.texture.v);
+			glVertex3fv(vertex.position.v);
+		}
+		glEnd();
+	}
 
 	glBindTexture(GL_TEXTURE_2D, 0);
 	glDisable(GL_TEXTURE_2D);
 
 	glPopAttrib();
-	glPopMatrix();	
 }
 
 // Determine if files of a given type exist in the passed-in directory.
@@ -14,9 +14,13 @@
 
 #include <GL/glew.h>
 #include <string>
+#include <future>
+#include <mutex>
 
 #include <Texture.h>
 #include <ContextBuffer.h>
+#include <UploadQueue.h>
+#include <ThreadPool.h>
 #include <Vector.h>
 
 namespace gfx
@@ -41,11 +45,25 @@ class Skybox
 		 */
 		void load(const std::string& dir);
 
+		/**
+		 * Load the skybox as above, decoding the six images on the pool.
+		 * @return Ready once every image is decoded.
+		 */
+		std::shared_future<void> load(const std::string& dir, util::ThreadPool& pool);
+
 		/**
 		 * Create the new graphics context.
 		 */
 		void initContext(int context_id);
 
+		/**
+		 * Queue the uploads of a context instead of making them in
+		 * initContext ().  Nothing is drawn on the context until they are done.
+		 * @param decoded Ready once the images are, as returned by load ().
+		 */
+		void queueUploads(UploadQueue& queue, int context_id,
+		                  std::shared_future<void> decoded = std::shared_future<void>());
+
 		/**
 		 * Destroy the created graphics context.
 		 */
@@ -77,6 +95,22 @@ class Skybox
 		  */
 		bool filesExist (const std::string& dir, const std::string& type);
 
+		/**
+		 * Find the image type in dir and set the parameters of the images.
+		 * @return Path of the images, without the face name and extension.
+		 */
+		std::string findImages (const std::string& dir, std::string& suffix);
+
+		/**
+		 * Compile drawBox () into a display list for the context.
+		 */
+		void createList(int context_id);
+
+		/**
+		  * Issue the state changes and faces of the box, around the origin.
+		  */
+		void drawBox(int context_id);
+
 		// The skybox images are organized as follows:
 		// 0 : looking down the positive x axis
 		// 1 : negative x
@@ -87,6 +121,8 @@ class Skybox
 		gfx::Texture _images[6];
 
 		gfx::ContextBuffer<math::vec3f> _positions;
+		gfx::ContextBuffer<GLuint> _lists;	// drawBox () compiled once per context.
+		std::mutex _list_mutex;				// Held while a context creates its list.
 		//math::vec3f _position;
 		float _scale;
 };
@@ -14,9 +14,17 @@
 
 #include <Texture.h>
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <sstream>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <util.h>
 
 using namespace std;
@@ -26,11 +34,45 @@ using namespace std;
 namespace gfx
 {
 
+std::string Texture::_cache_directory;
+
+namespace
+{
+
+/**
+ * Start of a decoded pixel cache file, followed by the levels of the mipmap
+ * chain, largest first, as tightly packed BGRA rows.
+ */
+struct PixelCacheHeader
+{
+	char magic[8];
+	uint64_t key;
+	uint32_t width, height, levels, reserved;
+};
+
+const char pixel_cache_magic[8] = { 'T', 'E', 'X', 'P', 'I', 'X', '0', '1' };
+
+// FNV-1a.
+void hash(uint64_t& key, const void* data, size_t size)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t i = 0; i < size; ++i)
+	{
+		key = (key ^ bytes[i]) * 1099511628211ull;
+	}
+}
+
+}
+
 Texture::Texture()
+	: _ids(true), _claimed(true)
 {
 	_width = 0;
 	_height = 0;
 	_data = NULL;
+	_mapped = NULL;
+	_mapped_size = 0;
+	_mapped_levels = 0;
 	texture_name = "";
 }
 
@@ -50,12 +92,64 @@ Texture::~Texture()
 
 void Texture::destroyContext (int context_id)
 {
-	glDeleteTextures (1, &_ids[context_id]);
-	_ids.remove (context_id);
+	// Contexts sharing the texture may still be using it.
+	std::lock_guard<std::mutex> lock (_create_mutex);
+	if (_ids.isLastUser (context_id))
+	{
+		glDeleteTextures (1, &_ids[context_id]);
+		_ids.remove (context_id);
+		_claimed.remove (context_id);
+	}
 }
 
 void Texture::load(const char* filename)
 {
+	clearCPUData();
+	if (compression::isCompressedFile(filename))
+	{
+		compression::load(filename, _compressed);
+		_width = _compressed.width;
+		_height = _compressed.height;
+		return;
+	}
+
+	// Read the encoding or the decoded pixels of an earlier load, unless
+	// the image changed since.
+	struct stat image;
+	bool cacheable = stat(filename, &image) == 0;
+	std::string cache_name;
+	uint64_t key = 0;
+	if (cacheable && _params.compressedFormat)
+	{
+		cache_name = getCacheName(filename);
+		struct stat cache;
+		if (stat(cache_name.c_str(), &cache) == 0 && cache.st_mtime >= image.st_mtime)
+		{
+			try
+			{
+				compression::load(cache_name, _compressed);
+				_compressed.format = _params.compressedFormat;
+				_width = _compressed.width;
+				_height = _compressed.height;
+				return;
+			}
+			catch (runtime_error&)
+			{
+				// Encode it again.
+				_compressed.levels.clear();
+			}
+		}
+	}
+	else if (cacheable && !_cache_directory.empty())
+	{
+		key = getPixelCacheKey(filename, image.st_mtime);
+		cache_name = getPixelCacheName(filename);
+		if (mapPixelCache(cache_name, key))
+		{
+			return;
+		}
+	}
+
 	FREE_IMAGE_FORMAT format = FreeImage_GetFileType(filename, 0);
 	FIBITMAP* unconvertedData = FreeImage_Load(format, filename);
 	if (unconvertedData == NULL)
@@ -69,12 +163,215 @@ void Texture::load(const char* filename)
 	FreeImage_Unload(unconvertedData);
 	_width = FreeImage_GetWidth(_data);
 	_height = FreeImage_GetHeight(_data);
+
+	// The caches only save time; a directory that cannot be written to
+	// means decoding again next time.
+	if (_params.compressedFormat)
+	{
+		buildMipmaps();
+		compress();
+		if (cacheable)
+		{
+			compression::saveDDS(cache_name, _compressed);
+		}
+	}
+	else if (cacheable && !_cache_directory.empty())
+	{
+		buildMipmaps();
+		savePixelCache(cache_name, key);
+	}
+}
+
+uint64_t Texture::getPixelCacheKey(const std::string& filename, time_t mtime) const
+{
+	uint64_t key = hashParams(filename);
+	int64_t time = mtime;
+	hash(key, &time, sizeof(time));
+	return key;
+}
+
+uint64_t Texture::hashParams(const std::string& filename) const
+{
+	uint64_t key = 14695981039346656037ull;
+	hash(key, filename.c_str(), filename.size());
+	hash(key, &_params.internalFormat, sizeof(_params.internalFormat));
+	hash(key, &_params.format, sizeof(_params.format));
+	hash(key, &_params.wrapS, sizeof(_params.wrapS));
+	hash(key, &_params.wrapT, sizeof(_params.wrapT));
+	hash(key, &_params.envMode, sizeof(_params.envMode));
+	hash(key, &_params.minFilter, sizeof(_params.minFilter));
+	hash(key, &_params.magFilter, sizeof(_params.magFilter));
+	hash(key, &_params.compressedFormat, sizeof(_params.compressedFormat));
+	hash(key, &_params.mipmapFilter, sizeof(_params.mipmapFilter));
+	hash(key, &_params.srgb, sizeof(_params.srgb));
+	hash(key, &_params.maxLevel, sizeof(_params.maxLevel));
+	return key;
+}
+
+std::string Texture::getPixelCacheName(const std::string& filename) const
+{
+	// Named without the modification time, so that the file of an edited
+	// image is replaced rather than left behind.
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.pix", (unsigned long long)hashParams(filename));
+	return _cache_directory + "/" + name;
+}
+
+bool Texture::mapPixelCache(const std::string& name, uint64_t key)
+{
+	int fd = open(name.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat cache;
+	void* address = MAP_FAILED;
+	if (fstat(fd, &cache) == 0 && (size_t)cache.st_size >= sizeof(PixelCacheHeader))
+	{
+		address = mmap(NULL, cache.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	}
+	close(fd);
+	if (address == MAP_FAILED)
+	{
+		return false;
+	}
+
+	// Check the file is whole, and is the one for this key: the image may
+	// have changed since it was written.
+	const PixelCacheHeader* header = (const PixelCacheHeader*)address;
+	size_t size = sizeof(PixelCacheHeader);
+	for (uint32_t level = 0; level < header->levels && level < 32; ++level)
+	{
+		size += (size_t)std::max(header->width >> level, 1u) * std::max(header->height >> level, 1u) * 4;
+	}
+	if (memcmp(header->magic, pixel_cache_magic, sizeof(header->magic)) != 0 || header->key != key ||
+	    header->levels == 0 || header->levels > 32 || size != (size_t)cache.st_size)
+	{
+		munmap(address, cache.st_size);
+		return false;
+	}
+
+	_mapped = (const unsigned char*)address;
+	_mapped_size = cache.st_size;
+	_mapped_levels = header->levels;
+	_width = header->width;
+	_height = header->height;
+	return true;
+}
+
+void Texture::savePixelCache(const std::string& name, uint64_t key) const
+{
+	PixelCacheHeader header;
+	memcpy(header.magic, pixel_cache_magic, sizeof(header.magic));
+	header.key = key;
+	header.width = _width;
+	header.height = _height;
+	header.levels = getLevelCount();
+	header.reserved = 0;
+
+	// Write to a name of our own and rename it into place, over the file of
+	// an older version of the image, so that a load never maps a file still
+	// being written.
+	stringstream temporary;
+	temporary << name << "." << getpid() << "." << this << ".tmp";
+	FILE* file = fopen(temporary.str().c_str(), "wb");
+	if (!file)
+	{
+		return;
+	}
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+	for (int i = 0; i < getLevelCount() && written; ++i)
+	{
+		Level level = getLevel(i);
+		for (int row = 0; row < level.rows && written; ++row)
+		{
+			written = fwrite(level.bits + row * level.pitch, level.rowBytes, 1, file) == 1;
+		}
+	}
+	written = fclose(file) == 0 && written;
+	if (!written || rename(temporary.str().c_str(), name.c_str()) != 0)
+	{
+		remove(temporary.str().c_str());
+	}
+}
+
+void Texture::load(const unsigned char* bits, GLsizei width, GLsizei height, size_t pitch)
+{
+	clearCPUData();
+	_data = FreeImage_Allocate(width, height, 32);
+	if (_data == NULL)
+	{
+		stringstream error;
+		error << "Texture::load(): Unable to allocate a " << width << "x" << height << " image.\n";
+		throw runtime_error(error.str ());
+	}
+
+	for (GLsizei y = 0; y < height; ++y)
+	{
+		memcpy(FreeImage_GetBits(_data) + y * FreeImage_GetPitch(_data), bits + y * pitch, (size_t)width * 4);
+	}
+	_width = width;
+	_height = height;
+
+	if (_params.compressedFormat)
+	{
+		buildMipmaps();
+		compress();
+	}
+}
+
+std::string Texture::getCacheName(const std::string& filename) const
+{
+	std::string name = filename;
+	if (!_cache_directory.empty())
+	{
+		std::replace(name.begin(), name.end(), '/', '_');
+		name = _cache_directory + "/" + name;
+	}
+
+	// The chain built before encoding depends on these too.
+	uint64_t key = 14695981039346656037ull;
+	hash(key, &_params.mipmapFilter, sizeof(_params.mipmapFilter));
+	hash(key, &_params.srgb, sizeof(_params.srgb));
+	hash(key, &_params.maxLevel, sizeof(_params.maxLevel));
+	char suffix[32];
+	snprintf(suffix, sizeof(suffix), ".%016llx", (unsigned long long)key);
+	return name + suffix + (compression::blockBytes(_params.compressedFormat) == 8 ? ".bc1.dds" : ".bc3.dds");
+}
+
+void Texture::compress()
+{
+	CompressedImage image;
+	image.format = _params.compressedFormat;
+	image.width = _width;
+	image.height = _height;
+	image.levels.resize(getLevelCount());
+	for (int i = 0; i < getLevelCount(); ++i)
+	{
+		Level level = getLevel(i);
+		compression::encode(level.bits, level.width, level.height, level.pitch, image.format, image.levels[i]);
+	}
+
+	clearCPUData();
+	std::swap(_compressed, image);
 }
 
 void Texture::createTextureObject(int context_id)
 {
-	GLuint& id = _ids[context_id];
+	// Another context of the share group may be creating it right now.
+	// notifyUploaded() runs unlocked: the cache's callback takes its own
+	// mutex, which the cache holds while calling destroyContext().
+	std::unique_lock<std::mutex> lock(_create_mutex);
+	if (_ids[context_id] != 0 && ShareGroup::isMember(context_id))
+	{
+		// Already uploaded by a context of the same share group.
+		lock.unlock();
+		notifyUploaded(context_id);
+		return;
+	}
 
+	// Published to _ids only once it is complete.
+	GLuint id = 0;
 	glEnable(GL_TEXTURE_2D);
 	glGenTextures(1, &id);
 	glBindTexture(GL_TEXTURE_2D, id);
@@ -84,30 +381,79 @@ void Texture::createTextureObject(int context_id)
 	// Get the maximum texture size for this GPU.
 	GLint max_size = 0;
 	glGetIntegerv (GL_MAX_TEXTURE_SIZE, &max_size);
-	if (_width > max_size || _height > max_size)
+	if (hasMipmaps() || isCompressed())
+	{
+		if (isCompressed() && !compression::isSupported(_compressed.format))
+		{
+			unbind();
+			glDeleteTextures(1, &id);
+			stringstream error;
+			error << "Texture::createTextureObject(): \"" << texture_name << "\" is compressed in a format the GL does not support.\n";
+			throw runtime_error(error.str ());
+		}
+
+		// Upload the chain, from the first level that fits.
+		int first = 0;
+		Level level = getLevel(first);
+		while ((level.width > max_size || level.height > max_size) && first + 1 < getLevelCount())
+		{
+			level = getLevel(++first);
+		}
+
+		for (int i = first; i < getLevelCount(); ++i)
+		{
+			level = getLevel(i);
+			if (isCompressed())
+			{
+				glCompressedTexImage2D (GL_TEXTURE_2D, i - first, _compressed.format, level.width, level.height, 0, (GLsizei)_compressed.levels[i].size(), level.bits);
+			}
+			else
+			{
+				glTexImage2D (GL_TEXTURE_2D, i - first, _params.internalFormat, level.width, level.height, 0, GL_BGRA, GL_UNSIGNED_BYTE, level.bits);
+			}
+		}
+
+		// A compressed file may have no chain, or not all of it.
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, getLevelCount() - 1 - first);
+		checkGLErrors("Texture::createTextureObject - mipmap chain");
+	}
+	else if (_width > max_size || _height > max_size)
 	{
-		gluBuild2DMipmaps(GL_TEXTURE_2D,
-	                  _params.internalFormat,
-	                  _width, _height,
-	                  GL_BGRA,
-	                  GL_UNSIGNED_BYTE,
-	                  FreeImage_GetBits (_data));
-		checkGLErrors("Texture::createTextureObject - gluBuild2DMipmaps");
+		// Scale the image down to the largest size that fits, and build the
+		// chain of that.  VirtualTexture draws such images at full detail.
+		GLsizei width, height;
+		mipmap::fitSize(_width, _height, max_size, width, height);
+		std::vector<unsigned char> image((size_t)width * height * 4);
+		Level level = getLevel(0);
+		mipmap::resample(level.bits, _width, _height, level.pitch, &image[0], width, height, _params.mipmapFilter, _params.srgb);
+		std::vector<std::vector<unsigned char> > chain;
+		mipmap::buildChain(&image[0], width, height, width * 4, chain, _params.mipmapFilter, _params.srgb);
+
+		glTexImage2D (GL_TEXTURE_2D, 0, _params.internalFormat, width, height, 0, GL_BGRA, GL_UNSIGNED_BYTE, &image[0]);
+		for (size_t i = 0; i < chain.size(); ++i)
+		{
+			glTexImage2D (GL_TEXTURE_2D, i + 1, _params.internalFormat, std::max(width >> (i + 1), 1), std::max(height >> (i + 1), 1),
+			              0, GL_BGRA, GL_UNSIGNED_BYTE, &chain[i][0]);
+		}
+		checkGLErrors("Texture::createTextureObject - downscaled chain");
 	}
 	else
 	{
-		glTexImage2D (GL_TEXTURE_2D, 0, _params.internalFormat, _width, _height, 0, GL_BGRA, GL_UNSIGNED_BYTE, FreeImage_GetBits (_data));
+		glTexImage2D (GL_TEXTURE_2D, 0, _params.internalFormat, _width, _height, 0, GL_BGRA, GL_UNSIGNED_BYTE, getLevel (0).bits);
 		glGenerateMipmapEXT (GL_TEXTURE_2D);
 		checkGLErrors("Texture::createTextureObject - glTexImage2D");
 	}
 
 	unbind();
+	_ids[context_id] = id;
+	lock.unlock();
+	notifyUploaded(context_id);
 }
 
 // Determine if this texture has loaded any data or not.
 bool Texture::hasData (void)
 {
-	return (_data != NULL);
+	return (_data != NULL || _mapped != NULL || isCompressed());
 }
 
 void Texture::clearCPUData()
@@ -117,6 +463,72 @@ void Texture::clearCPUData()
 		FreeImage_Unload (_data);
 		_data = NULL; 
 	}
+	if (_mapped)
+	{
+		munmap ((void*)_mapped, _mapped_size);
+		_mapped = NULL;
+		_mapped_size = 0;
+		_mapped_levels = 0;
+	}
+	_mips.clear();
+	_compressed.levels.clear();
+}
+
+void Texture::buildMipmaps()
+{
+	// Compressed and cached images come with their chain.
+	if (!_data || hasMipmaps())
+	{
+		return;
+	}
+
+	mipmap::buildChain(FreeImage_GetBits(_data), _width, _height, FreeImage_GetPitch(_data), _mips,
+	                   _params.mipmapFilter, _params.srgb);
+	if ((GLint)_mips.size() > _params.maxLevel)
+	{
+		_mips.resize(std::max(_params.maxLevel, 0));
+	}
+}
+
+Texture::Level Texture::getLevel(int index) const
+{
+	Level level;
+	level.width = std::max(_width >> index, 1);
+	level.height = std::max(_height >> index, 1);
+	if (isCompressed())
+	{
+		level.bits = &_compressed.levels[index][0];
+		level.rowBytes = (size_t)((level.width + 3) / 4) * compression::blockBytes(_compressed.format);
+		level.pitch = level.rowBytes;
+		level.rows = (level.height + 3) / 4;
+		level.rowHeight = 4;
+	}
+	else
+	{
+		if (_mapped)
+		{
+			level.bits = _mapped + sizeof(PixelCacheHeader);
+			for (int i = 0; i < index; ++i)
+			{
+				level.bits += (size_t)std::max(_width >> i, 1) * std::max(_height >> i, 1) * 4;
+			}
+			level.pitch = level.width * 4;
+		}
+		else if (index == 0)
+		{
+			level.bits = FreeImage_GetBits(_data);
+			level.pitch = FreeImage_GetPitch(_data);
+		}
+		else
+		{
+			level.bits = &_mips[index - 1][0];
+			level.pitch = level.width * 4;
+		}
+		level.rowBytes = level.width * 4;
+		level.rows = level.height;
+		level.rowHeight = 1;
+	}
+	return level;
 }
 
 void Texture::blank (const size_t width, const size_t height, int data_type, int context_id)
@@ -132,12 +544,36 @@ void Texture::blank (const size_t width, const size_t height, int data_type, int
 
 void Texture::createMipmaps (int context_id)
 {
-	if (valid (context_id))
+	if (!valid (context_id))
+	{
+		return;
+	}
+
+	bind (context_id);
+	if (_params.cpuMipmaps)
+	{
+		// Read level 0 back and filter it here instead.
+		GLint width = 0, height = 0;
+		glGetTexLevelParameteriv (GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+		glGetTexLevelParameteriv (GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+		std::vector<unsigned char> image ((size_t)width * height * 4);
+		glPixelStorei (GL_PACK_ALIGNMENT, 4);
+		glGetTexImage (GL_TEXTURE_2D, 0, GL_BGRA, GL_UNSIGNED_BYTE, &image[0]);
+
+		std::vector<std::vector<unsigned char> > chain;
+		mipmap::buildChain (&image[0], width, height, width * 4, chain, _params.mipmapFilter, _params.srgb);
+		for (size_t i = 0; i < chain.size (); ++i)
+		{
+			glTexImage2D (GL_TEXTURE_2D, i + 1, _params.internalFormat, std::max (width >> (i + 1), 1), std::max (height >> (i + 1), 1),
+			              0, GL_BGRA, GL_UNSIGNED_BYTE, &chain[i][0]);
+		}
+		checkGLErrors ("Texture::createMipmaps");
+	}
+	else
 	{
-		bind (context_id);
 		glGenerateMipmapEXT (GL_TEXTURE_2D);
-		unbind ();
 	}
+	unbind ();
 }
 
 void Texture::bind (int context_id) 
@@ -162,6 +598,7 @@ void Texture::applyParams()
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, _params.wrapS);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, _params.wrapT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, _params.maxLevel);
 }
 
 }
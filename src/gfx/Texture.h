@@ -15,7 +15,15 @@
 #include <GL/glew.h>
 #include <ContextBuffer.h>
 #include <FreeImage.h>
+#include <Mipmap.h>
+#include <TextureCompression.h>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <stdint.h>
 #include <string>
+#include <time.h>
+#include <vector>
 
 namespace gfx
 {
@@ -54,20 +62,88 @@ class Texture
 
 		/**
 		 * Load an image file using FreeImage and load it as an OpenGL texture.
+		 * DDS and KTX files are read block compressed, DDS files turned
+		 * from their top row first order to the bottom row first one of
+		 * FreeImage and GL (except BC7, which cannot be).  Other
+		 * images are encoded with Params::compressedFormat, when it is set,
+		 * and the result is cached in a DDS file that later loads read
+		 * instead while it is newer than the image.  When a cache directory
+		 * is set, uncompressed images are cached decoded, with their mipmap
+		 * chain, in a file there keyed by the path, modification time and
+		 * parameters; later loads map it rather than decoding, and upload
+		 * straight from the mapping.
 		 * @param filename Path to the texture to load.
 		 */
 		void load(const char* filename);
 
+		/**
+		 * Load an image of 32 bit BGRA texels from memory, bottom row first
+		 * as FreeImage lays it out.  It is encoded with
+		 * Params::compressedFormat as load(filename) would, but not cached.
+		 * @param pitch Bytes from one row of bits to the next.
+		 */
+		void load(const unsigned char* bits, GLsizei width, GLsizei height, size_t pitch);
+
+		/**
+		 * Sets the directory the DDS and decoded pixel files of load() are
+		 * cached in.  By default, or when dir is empty, DDS files are
+		 * written next to their image and decoded pixels are not cached at
+		 * all, since they take four bytes a texel.  Nothing is ever removed
+		 * from the directory; an edited image replaces its own file.
+		 * @param dir Directory to cache in.
+		 */
+		static void setCacheDirectory(const std::string& dir) { _cache_directory = dir; }
+
+		/**
+		 * Returns the directory set by setCacheDirectory().
+		 */
+		static const std::string& getCacheDirectory() { return _cache_directory; }
+
+		/**
+		 * Returns the path of the DDS file load() caches the encoding of
+		 * filename in, with the current parameters.  The name includes a
+		 * hash of the parameters the mipmap chain is built with.
+		 */
+		std::string getCacheName(const std::string& filename) const;
+
 		/**
 		 * Creates the context-specific texture object and uploads the image data.
 		 * @param context_id ID of the context to create the texture for.
 		 */
 		void createTextureObject(int context_id = 0);
 
+		/**
+		 * Build the mipmap chain of the loaded image on the CPU, with
+		 * Params::mipmapFilter.  createTextureObject () and TextureUpload
+		 * then upload the levels instead of generating them on the GPU, and
+		 * can start from a smaller level when the image is too large for
+		 * the GPU.  The pixel and DDS caches store the chain.  Touches no
+		 * GL state, so it may run on a worker thread after load ().
+		 */
+		void buildMipmaps();
+
+		/**
+		 * Returns whether buildMipmaps () has run on the loaded image.
+		 */
+		bool hasMipmaps() const { return !_mips.empty() || _compressed.levels.size() > 1 || _mapped_levels > 1; }
+
+		/**
+		 * Returns whether the loaded image is block compressed.
+		 */
+		bool isCompressed() const { return !_compressed.levels.empty(); }
+
 		/**
 		 * Clears image data from core memory.
 		 */
 		void clearCPUData();
+
+		/**
+		 * Sets a function called with the id of each context once the
+		 * texture is complete on it, whether createTextureObject() or a
+		 * TextureUpload put it there or a context of its share group did.
+		 * It may free the image data, so nothing else must be reading it.
+		 */
+		void setUploadedCallback(const std::function<void (int)>& uploaded) { _uploaded = uploaded; }
 		
 		/**
 		  * Determine if this texture has any data loaded or not.
@@ -91,7 +167,8 @@ class Texture
 		bool valid (int context_id = 0) { return _ids[context_id] != 0; }
 
 		/**
-		  * Create mipmaps for this texture.
+		  * Create mipmaps for this texture, on the GPU or, with
+		  * Params::cpuMipmaps, from level 0 read back to the CPU.
 		  * WARNING: Only call this function if you used Texture::blank () to
 		  * create the texture and wish for mipmaps to be created, otherwise
 		  * they have alreay been created.
@@ -149,6 +226,38 @@ class Texture
 			 */
 			GLenum magFilter;
 
+			/**
+			 * Block-compressed format load() encodes images into, either
+			 * GL_COMPRESSED_RGB_S3TC_DXT1_EXT or GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+			 * (the latter for internal formats with alpha), or 0 to leave
+			 * them uncompressed.
+			 */
+			GLenum compressedFormat;
+
+			/**
+			 * Filter mipmap chains are built with on the CPU, and images too
+			 * large for the GPU are scaled down with.
+			 */
+			mipmap::Filter mipmapFilter;
+
+			/**
+			 * Whether the color of the image is sRGB encoded, and so must be
+			 * converted to linear to be filtered.
+			 */
+			bool srgb;
+
+			/**
+			 * Whether createMipmaps() builds the chain on the CPU rather
+			 * than with glGenerateMipmap.  For 8 bit formats only.
+			 */
+			bool cpuMipmaps;
+
+			/**
+			 * Highest mipmap level kept and sampled.  Chains built on the
+			 * CPU stop there.
+			 */
+			GLint maxLevel;
+
 			Params()
 			{
 				internalFormat = 3;
@@ -158,6 +267,11 @@ class Texture
 				wrapT = GL_REPEAT;	
 				minFilter = GL_LINEAR_MIPMAP_LINEAR;
 				magFilter = GL_LINEAR;
+				compressedFormat = 0;
+				mipmapFilter = mipmap::BOX;
+				srgb = true;
+				cpuMipmaps = false;
+				maxLevel = 1000;
 			}
 		};
 
@@ -165,17 +279,109 @@ class Texture
 
 	private:
 
+		friend class TextureUpload;
+		friend class TextureAtlas;
+
 		gfx::ContextBuffer <GLuint> _ids;
+
+		// Held while a context creates its texture object, so that only one
+		// context of a share group does.  _claimed marks a share group whose
+		// texture a TextureUpload is still streaming.
+		std::mutex _create_mutex;
+		gfx::ContextBuffer <bool> _claimed;
 		GLsizei _width, _height;
 
 		Params _params;
 
 		FIBITMAP* _data;
 
+		// Levels 1 and up of the mipmap chain, tightly packed BGRA.
+		std::vector<std::vector<unsigned char> > _mips;
+
+		// The decoded pixel cache file, when the image was read from it.
+		// _data and _mips are empty then.
+		const unsigned char* _mapped;
+		size_t _mapped_size;
+		int _mapped_levels;
+
+		// The whole chain, when the image is block compressed.  _data and
+		// _mips are empty then.
+		CompressedImage _compressed;
+
+		static std::string _cache_directory;
+
+		std::function<void (int)> _uploaded;
+
+		/**
+		 * A level of the mipmap chain, as rows of texels or of 4x4 blocks.
+		 */
+		struct Level
+		{
+			GLsizei width, height;
+			const unsigned char* bits;
+			size_t pitch;		// Bytes from one row to the next.
+			size_t rowBytes;	// Bytes of a row to upload.
+			int rows;
+			int rowHeight;		// Texels high a row is: 1, or 4 for blocks.
+		};
+
+		/**
+		 * Returns level of the mipmap chain (0 being the image).
+		 */
+		Level getLevel(int level) const;
+
+		/**
+		 * Number of levels, including the image itself.
+		 */
+		int getLevelCount() const
+		{
+			int count = isCompressed() ? (int)_compressed.levels.size() : (_mapped ? _mapped_levels : 1 + (int)_mips.size());
+			return std::min(count, _params.maxLevel + 1);
+		}
+
+		/**
+		 * Key of the decoded pixels of filename, as modified at mtime, in
+		 * the pixel cache.
+		 */
+		uint64_t getPixelCacheKey(const std::string& filename, time_t mtime) const;
+
+		/**
+		 * Hash of filename and the parameters.
+		 */
+		uint64_t hashParams(const std::string& filename) const;
+
+		/**
+		 * Path of the pixel cache file of filename with the current
+		 * parameters, in the cache directory.  Each version of the image is
+		 * written to the same path; the key in the file tells them apart.
+		 */
+		std::string getPixelCacheName(const std::string& filename) const;
+
+		/**
+		 * Map the pixel cache file name in place of decoding the image.
+		 * Returns false if there is no such file or it is not the one of key.
+		 */
+		bool mapPixelCache(const std::string& name, uint64_t key);
+
+		/**
+		 * Write the loaded image and its mipmap chain to the pixel cache.
+		 */
+		void savePixelCache(const std::string& name, uint64_t key) const;
+
+		/**
+		 * Encode the loaded image and its mipmap chain, replacing them.
+		 */
+		void compress();
+
 		/**
 		 * Set texture parameters through OpenGL API calls.
 		 */
 		void applyParams();
+
+		/**
+		 * Report that the texture is complete on context_id.
+		 */
+		void notifyUploaded(int context_id) { if (_uploaded) _uploaded(context_id); }
 };
 }
 
@@ -0,0 +1,192 @@
+/*
+   Filename : TextureAtlas.cpp
+   Version  : 1.0
+
+   Purpose  : Packs small images into one texture.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <TextureAtlas.h>
+#include <algorithm>
+#include <sstream>
+#include <string.h>
+
+namespace gfx
+{
+
+TextureAtlas::TextureAtlas (GLsizei max_size, int gutter)
+	: m_max_size (max_size),
+	  m_gutter (gutter),
+	  m_width (0),
+	  m_height (0)
+{
+}
+
+int TextureAtlas::add (const std::string &name, const Texture &image)
+{
+	if (image.isCompressed () || (!image._data && !image._mapped))
+	{
+		return -1;
+	}
+
+	Texture::Level level = image.getLevel (0);
+	Image added;
+	added.name = name;
+	added.width = level.width;
+	added.height = level.height;
+	added.bits.resize ((size_t)level.width * level.height * 4);
+	for (GLsizei y = 0; y < level.height; ++y)
+	{
+		memcpy (&added.bits[(size_t)y * level.width * 4], level.bits + y * level.pitch, level.rowBytes);
+	}
+	added.x = added.y = 0;
+	m_images.push_back (added);
+
+	if (!pack ())
+	{
+		m_images.pop_back ();
+		pack ();
+		return -1;
+	}
+	return (int)m_images.size () - 1;
+}
+
+std::string TextureAtlas::getName (void) const
+{
+	std::stringstream name;
+	name << "atlas " << m_max_size << ' ' << m_gutter;
+	for (size_t i = 0; i < m_images.size (); ++i)
+	{
+		name << '\n' << m_images[i].name;
+	}
+	return name.str ();
+}
+
+void TextureAtlas::applyParams (Texture::Params &params) const
+{
+	int levels = 0;
+	while ((2 << levels) <= m_gutter)
+	{
+		++levels;
+	}
+
+	// Wider filters than a box would reach across the gutters.
+	params.wrapS = GL_CLAMP_TO_EDGE;
+	params.wrapT = GL_CLAMP_TO_EDGE;
+	params.mipmapFilter = mipmap::BOX;
+	params.maxLevel = std::min (params.maxLevel, (GLint)levels);
+}
+
+void TextureAtlas::fill (Texture &texture) const
+{
+	std::vector <unsigned char> bits ((size_t)m_width * m_height * 4, 0);
+	const GLsizei gutter = m_gutter;
+	for (size_t i = 0; i < m_images.size (); ++i)
+	{
+		const Image &image = m_images[i];
+		for (GLsizei y = -gutter; y < image.height + gutter; ++y)
+		{
+			// The gutter repeats the edge texels, as GL_CLAMP_TO_EDGE would.
+			const unsigned char *source = &image.bits[(size_t)std::min (std::max (y, 0), image.height - 1) * image.width * 4];
+			unsigned char *target = &bits[((size_t)(image.y + gutter + y) * m_width + image.x) * 4];
+			for (GLsizei x = 0; x < gutter; ++x)
+			{
+				memcpy (target + x * 4, source, 4);
+			}
+			memcpy (target + gutter * 4, source, (size_t)image.width * 4);
+			for (GLsizei x = 0; x < gutter; ++x)
+			{
+				memcpy (target + (gutter + image.width + x) * 4, source + (image.width - 1) * 4, 4);
+			}
+		}
+	}
+
+	texture.load (&bits[0], m_width, m_height, (size_t)m_width * 4);
+}
+
+GLsizei TextureAtlas::cellSize (GLsizei size) const
+{
+	return (size + 3 * m_gutter - 1) / m_gutter * m_gutter;
+}
+
+GLsizei TextureAtlas::place (GLsizei width)
+{
+	std::vector <size_t> order (m_images.size ());
+	for (size_t i = 0; i < order.size (); ++i)
+	{
+		order[i] = i;
+	}
+	std::stable_sort (order.begin (), order.end (), [this] (size_t a, size_t b)
+	{
+		return m_images[a].height > m_images[b].height;
+	});
+
+	GLsizei x = 0, y = 0, shelf = 0;
+	for (size_t i = 0; i < order.size (); ++i)
+	{
+		Image &image = m_images[order[i]];
+		GLsizei cell_width = cellSize (image.width);
+		if (cell_width > width)
+		{
+			return m_max_size + 1;
+		}
+		if (x + cell_width > width)
+		{
+			y += shelf;
+			x = 0;
+			shelf = 0;
+		}
+		image.x = x;
+		image.y = y;
+		x += cell_width;
+		shelf = std::max (shelf, cellSize (image.height));
+	}
+	return y + shelf;
+}
+
+bool TextureAtlas::pack (void)
+{
+	// Try each power of two wide, keeping the smallest atlas, and the
+	// squarest of those.
+	GLsizei best_width = 0, best_height = 0;
+	for (GLsizei width = m_gutter; width <= m_max_size; width *= 2)
+	{
+		GLsizei needed = place (width);
+		GLsizei height = m_gutter;
+		while (height < needed)
+		{
+			height *= 2;
+		}
+		if (height > m_max_size)
+		{
+			continue;
+		}
+		if (best_width == 0 || (size_t)width * height < (size_t)best_width * best_height ||
+		    ((size_t)width * height == (size_t)best_width * best_height && std::max (width, height) < std::max (best_width, best_height)))
+		{
+			best_width = width;
+			best_height = height;
+		}
+	}
+	if (best_width == 0)
+	{
+		return false;
+	}
+
+	place (best_width);
+	m_width = best_width;
+	m_height = best_height;
+	m_regions.resize (m_images.size ());
+	for (size_t i = 0; i < m_images.size (); ++i)
+	{
+		const Image &image = m_images[i];
+		m_regions[i].offset = math::vec2f ((float)(image.x + m_gutter) / m_width, (float)(image.y + m_gutter) / m_height);
+		m_regions[i].scale = math::vec2f ((float)image.width / m_width, (float)image.height / m_height);
+	}
+	return true;
+}
+
+}
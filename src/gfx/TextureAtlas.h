@@ -0,0 +1,124 @@
+/*
+   Filename : TextureAtlas.h
+   Version  : 1.0
+
+   Purpose  : Packs small images into one texture.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#pragma once
+
+#include <Texture.h>
+#include <Vector.h>
+#include <string>
+#include <vector>
+
+namespace gfx
+{
+
+/**
+  * Packs images side by side into one texture, so that what is drawn with
+  * any of them needs one bind.  Each image is surrounded by a gutter of its
+  * edge texels repeated, which keeps filtering from reaching its neighbours
+  * down to mipmap level log2 (gutter), the last level the atlas has.
+  * Texture coordinates in [0, 1] of an image map to its region of the atlas
+  * through getRegion (); coordinates outside it would not repeat the image,
+  * so images that wrap must not be packed.
+  */
+class TextureAtlas
+{
+	public:
+
+		/**
+		  * Where an image lies in the atlas: texture coordinate t of the
+		  * image is offset + t * scale in the atlas.
+		  */
+		struct Region
+		{
+			math::vec2f offset;
+			math::vec2f scale;
+		};
+
+		/**
+		  * @param max_size Widest and highest the atlas may grow.
+		  * @param gutter Texels around each image, a power of two.
+		  */
+		explicit TextureAtlas (GLsizei max_size = 2048, int gutter = 8);
+
+		/**
+		  * Add the image a texture loaded, if it fits beside those already
+		  * added.  Images decoded uncompressed only; the atlas keeps a copy.
+		  * @return The index of the image, or -1 if it does not fit or is
+		  *         compressed.
+		  */
+		int add (const std::string &name, const Texture &image);
+
+		/**
+		  * Returns the number of images added.
+		  */
+		size_t getImageCount (void) const { return m_images.size (); }
+
+		/**
+		  * Returns the region of image i.  Adding images moves the others, so
+		  * regions are final once the last is added.
+		  */
+		const Region &getRegion (size_t i) const { return m_regions[i]; }
+
+		/**
+		  * Returns a name for the atlas, the same for the same images.
+		  */
+		std::string getName (void) const;
+
+		/**
+		  * Adjust parameters for sampling the atlas: clamped at its edges and
+		  * with no more mipmap levels than the gutter keeps apart.
+		  */
+		void applyParams (Texture::Params &params) const;
+
+		/**
+		  * Load the atlas into texture, as Texture::load () from memory.
+		  */
+		void fill (Texture &texture) const;
+
+		GLsizei width (void) const { return m_width; }
+		GLsizei height (void) const { return m_height; }
+
+	private:
+
+		struct Image
+		{
+			std::string 				name;
+			GLsizei 					width, height;
+			std::vector <unsigned char> bits;	// Tightly packed BGRA.
+			GLsizei 					x, y;		// Corner of the image's gutter.
+		};
+
+		/**
+		  * Cell of an image: the image and its gutter, rounded up to whole
+		  * gutters so that every cell starts on a texel of the last level.
+		  */
+		GLsizei cellSize (GLsizei size) const;
+
+		/**
+		  * Place the images on shelves width texels wide, tallest first.
+		  * Returns the height needed.
+		  */
+		GLsizei place (GLsizei width);
+
+		/**
+		  * Place the images in the smallest atlas they fit.  Returns false
+		  * if they do not fit in max_size.
+		  */
+		bool pack (void);
+
+		std::vector <Image> 	m_images;
+		std::vector <Region> 	m_regions;
+		GLsizei 				m_max_size;
+		int 					m_gutter;
+		GLsizei 				m_width, m_height;
+};
+
+}
@@ -0,0 +1,187 @@
+/*
+   Filename : TextureCache.cpp
+   Version  : 1.0
+
+   Purpose  : Shares one Texture between every user of the same image.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <TextureCache.h>
+#include <limits.h>
+#include <sstream>
+#include <stdlib.h>
+
+namespace gfx
+{
+
+TextureCache::TextureCache (void)
+{
+}
+
+TextureCache &TextureCache::getInstance (void)
+{
+	static TextureCache instance;
+	return instance;
+}
+
+std::string TextureCache::makeKey (const std::string &filename, const Texture::Params &params)
+{
+	char path[PATH_MAX];
+	std::stringstream key;
+	key << (realpath (filename.c_str (), path) ? path : filename.c_str ()) << '\n'
+	    << params.internalFormat << ' ' << params.format << ' '
+	    << params.wrapS << ' ' << params.wrapT << ' ' << params.envMode << ' '
+	    << params.minFilter << ' ' << params.magFilter << ' ' << params.compressedFormat << ' '
+	    << params.mipmapFilter << ' ' << params.srgb << ' ' << params.cpuMipmaps << ' ' << params.maxLevel;
+	return key.str ();
+}
+
+TextureCache::Handle TextureCache::load (const std::string &filename, const Texture::Params &params,
+                                         TextureLoader *loader, std::shared_future <void> *loaded)
+{
+	return get (makeKey (filename, params), filename, params,
+	            [filename] (Texture &texture) { texture.load (filename.c_str ()); }, loader, loaded);
+}
+
+TextureCache::Handle TextureCache::build (const std::string &name, const Texture::Params &params, const std::function <void (Texture &)> &fill,
+                                          TextureLoader *loader, std::shared_future <void> *loaded)
+{
+	std::stringstream key;
+	key << "build:" << makeKey (name, params);
+	return get (key.str (), name, params, fill, loader, loaded);
+}
+
+TextureCache::Handle TextureCache::get (const std::string &key, const std::string &name, const Texture::Params &params,
+                                        const std::function <void (Texture &)> &fill, TextureLoader *loader, std::shared_future <void> *loaded)
+{
+	std::unique_lock <std::mutex> lock (m_mutex);
+	Entry &entry = m_entries[key];
+	Handle handle = entry.handle.lock ();
+	if (handle)
+	{
+		std::shared_future <void> done = entry.loaded;
+		lock.unlock ();
+		if (loaded)
+		{
+			*loaded = done;
+		}
+		else
+		{
+			done.get ();
+		}
+		return handle;
+	}
+
+	// The first user of the image, or the last handle to it is on its way
+	// out and remove () will leave this new entry alone.
+	Texture *texture = new Texture ();
+	texture->setParams (params);
+	texture->texture_name = name;
+	texture->setUploadedCallback ([this, key] (int context_id) { uploaded (key, context_id); });
+	handle = Handle (texture, [this, key] (Texture *texture) { remove (key, texture); });
+	entry.handle = handle;
+	entry.texture = texture;
+	entry.uploaded.clear ();
+
+	if (loader)
+	{
+		entry.loaded = loader->load (handle, fill);
+		if (loaded)
+		{
+			*loaded = entry.loaded;
+		}
+		return handle;
+	}
+
+	// Users asking meanwhile wait for this decode.
+	std::promise <void> decoded;
+	entry.loaded = decoded.get_future ().share ();
+	if (loaded)
+	{
+		*loaded = entry.loaded;
+	}
+	lock.unlock ();
+	try
+	{
+		fill (*texture);
+	}
+	catch (...)
+	{
+		decoded.set_exception (std::current_exception ());
+		throw;
+	}
+	decoded.set_value ();
+	return handle;
+}
+
+void TextureCache::registerContext (int context_id)
+{
+	std::lock_guard <std::mutex> lock (m_mutex);
+	m_contexts.insert (context_id);
+}
+
+void TextureCache::unregisterContext (int context_id)
+{
+	std::lock_guard <std::mutex> lock (m_mutex);
+	m_contexts.erase (context_id);
+	std::map <std::string, Entry>::iterator iter;
+	for (iter = m_entries.begin (); iter != m_entries.end (); ++iter)
+	{
+		iter->second.texture->destroyContext (context_id);
+		iter->second.uploaded.erase (context_id);
+		release (iter->second);
+	}
+}
+
+size_t TextureCache::getTextureCount (void) const
+{
+	std::lock_guard <std::mutex> lock (m_mutex);
+	return m_entries.size ();
+}
+
+void TextureCache::uploaded (const std::string &key, int context_id)
+{
+	std::lock_guard <std::mutex> lock (m_mutex);
+	std::map <std::string, Entry>::iterator iter = m_entries.find (key);
+	if (iter != m_entries.end ())
+	{
+		iter->second.uploaded.insert (context_id);
+		release (iter->second);
+	}
+}
+
+void TextureCache::release (Entry &entry)
+{
+	if (m_contexts.empty () || !entry.texture->hasData ())
+	{
+		return;
+	}
+
+	std::set <int>::const_iterator iter;
+	for (iter = m_contexts.begin (); iter != m_contexts.end (); ++iter)
+	{
+		if (!entry.uploaded.count (*iter))
+		{
+			return;
+		}
+	}
+	entry.texture->clearCPUData ();
+}
+
+void TextureCache::remove (const std::string &key, Texture *texture)
+{
+	{
+		std::lock_guard <std::mutex> lock (m_mutex);
+		std::map <std::string, Entry>::iterator iter = m_entries.find (key);
+		if (iter != m_entries.end () && iter->second.texture == texture)
+		{
+			m_entries.erase (iter);
+		}
+	}
+	delete texture;
+}
+
+}
@@ -0,0 +1,141 @@
+/*
+   Filename : TextureCache.h
+   Version  : 1.0
+
+   Purpose  : Shares one Texture between every user of the same image.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#pragma once
+
+#include <Texture.h>
+#include <TextureLoader.h>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace gfx
+{
+
+/**
+  * Registry of the textures loaded from image files.  Asking for an image
+  * already loaded with the same parameters returns the texture loaded the
+  * first time, so it is decoded, kept and uploaded once however many
+  * materials use it.  A texture is forgotten, and deleted, with its last
+  * handle.
+  *
+  * Once a texture is complete on every registered context its image data
+  * is freed.  Register every context before uploading to it: one that
+  * joins later finds nothing left to upload, unless it shares objects with
+  * a context that has the texture.
+  */
+class TextureCache
+{
+	public:
+
+		typedef std::shared_ptr <Texture> Handle;
+
+		/**
+		  * Returns the cache shared by the whole program.
+		  */
+		static TextureCache &getInstance (void);
+
+		/**
+		  * Get the texture of an image file.
+		  * @param filename Path of the image; paths naming the same file
+		  *        share a texture.
+		  * @param params Parameters to load it with; each set of
+		  *        parameters gets a texture of its own.
+		  * @param loader Loader to decode the image on, or NULL to decode
+		  *        it before returning.  Throws what Texture::load () threw
+		  *        in that case.
+		  * @param loaded If not NULL, receives the future of the decode,
+		  *        whoever started it: ready once the texture may be used,
+		  *        with what Texture::load () threw if it failed.
+		  */
+		Handle load (const std::string &filename, const Texture::Params &params,
+		             TextureLoader *loader = NULL, std::shared_future <void> *loaded = NULL);
+
+		/**
+		  * Get a texture made in memory rather than loaded from a file, such
+		  * as an atlas.  As load (), but the first user's fill makes it.
+		  * @param name Names what fill makes; textures of the same name and
+		  *        parameters are shared.
+		  * @param fill Fills the texture, e.g. with Texture::load () from
+		  *        memory.
+		  */
+		Handle build (const std::string &name, const Texture::Params &params, const std::function <void (Texture &)> &fill,
+		              TextureLoader *loader = NULL, std::shared_future <void> *loaded = NULL);
+
+		/**
+		  * Add a context that textures must reach before their image data
+		  * is freed.
+		  */
+		void registerContext (int context_id);
+
+		/**
+		  * Remove a context, destroying its textures.  Its context must be
+		  * current.
+		  */
+		void unregisterContext (int context_id);
+
+		/**
+		  * Returns the number of textures alive.
+		  */
+		size_t getTextureCount (void) const;
+
+	private:
+
+		struct Entry
+		{
+			std::weak_ptr <Texture>   handle;
+			Texture 				 *texture;
+			std::shared_future <void> loaded;
+			std::set <int> 			  uploaded;	// Contexts the texture is complete on.
+		};
+
+		TextureCache (void);
+		TextureCache (const TextureCache &);
+		TextureCache &operator= (const TextureCache &);
+
+		/**
+		  * Key of filename loaded with params.
+		  */
+		static std::string makeKey (const std::string &filename, const Texture::Params &params);
+
+		/**
+		  * Get the texture of key, filling it with fill if it is new.
+		  */
+		Handle get (const std::string &key, const std::string &name, const Texture::Params &params,
+		            const std::function <void (Texture &)> &fill, TextureLoader *loader, std::shared_future <void> *loaded);
+
+		/**
+		  * Record that the texture of key is complete on context_id.
+		  */
+		void uploaded (const std::string &key, int context_id);
+
+		/**
+		  * Free the image data of entry if every registered context has it.
+		  * The mutex must be held.
+		  */
+		void release (Entry &entry);
+
+		/**
+		  * Forget the texture of key and delete it, once its last handle is
+		  * gone.
+		  */
+		void remove (const std::string &key, Texture *texture);
+
+		mutable std::mutex 			   m_mutex;
+		std::map <std::string, Entry>  m_entries;
+		std::set <int> 				   m_contexts;
+};
+
+}
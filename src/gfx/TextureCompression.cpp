@@ -0,0 +1,728 @@
+/*
+   Filename : TextureCompression.cpp
+   Version  : 1.0
+
+   Purpose  : Block-compressed images: DDS and KTX reading, DDS writing, and
+              a BC1/BC3 encoder for images decoded by FreeImage.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <TextureCompression.h>
+#include <ThreadPool.h>
+#include <VectorOps.h>
+#include <algorithm>
+#include <fstream>
+#include <math.h>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+#include <thread>
+
+namespace gfx
+{
+
+namespace compression
+{
+
+namespace
+{
+
+// DDS header flags and the four character codes read and written.
+const unsigned int DDSD_CAPS 		= 0x1;
+const unsigned int DDSD_HEIGHT 		= 0x2;
+const unsigned int DDSD_WIDTH 		= 0x4;
+const unsigned int DDSD_PIXELFORMAT = 0x1000;
+const unsigned int DDSD_MIPMAPCOUNT = 0x20000;
+const unsigned int DDSD_LINEARSIZE 	= 0x80000;
+const unsigned int DDPF_FOURCC 		= 0x4;
+const unsigned int DDSCAPS_COMPLEX 	= 0x8;
+const unsigned int DDSCAPS_TEXTURE 	= 0x1000;
+const unsigned int DDSCAPS_MIPMAP 	= 0x400000;
+
+inline unsigned int fourCC (const char *code)
+{
+	return (unsigned char)code[0] | ((unsigned char)code[1] << 8) | ((unsigned char)code[2] << 16) | ((unsigned int)(unsigned char)code[3] << 24);
+}
+
+inline unsigned int readU32 (const unsigned char *p, bool swap = false)
+{
+	unsigned int value = p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+	if (swap)
+	{
+		value = (value >> 24) | ((value >> 8) & 0xff00) | ((value << 8) & 0xff0000) | (value << 24);
+	}
+	return value;
+}
+
+inline void writeU32 (unsigned char *p, unsigned int value)
+{
+	p[0] = value & 0xff;
+	p[1] = (value >> 8) & 0xff;
+	p[2] = (value >> 16) & 0xff;
+	p[3] = value >> 24;
+}
+
+void fail (const std::string &filename, const char *reason)
+{
+	std::stringstream error;
+	error << "compression::load(): \"" << filename << "\": " << reason << ".\n";
+	throw std::runtime_error (error.str ());
+}
+
+/**
+  * Split the levels of a file's data, level 0 first.
+  */
+void readLevels (const std::string &filename, const unsigned char *data, size_t size, unsigned int count, CompressedImage &image)
+{
+	image.levels.clear ();
+	size_t offset = 0;
+	for (unsigned int level = 0; level < count; ++level)
+	{
+		size_t bytes = levelSize (image.format, std::max (image.width >> level, 1), std::max (image.height >> level, 1));
+		if (offset + bytes > size)
+		{
+			fail (filename, "truncated");
+		}
+		image.levels.push_back (std::vector <unsigned char> (data + offset, data + offset + bytes));
+		offset += bytes;
+	}
+}
+
+/**
+  * Reverse the first rows rows of texels of a block's 2 bit color indices,
+  * one byte a row.
+  */
+void flipColors (unsigned char *block, int rows)
+{
+	std::reverse (block + 4, block + 4 + rows);
+}
+
+/**
+  * Reverse the rows of a BC2 block's explicit alpha, two bytes a row.
+  */
+void flipExplicitAlpha (unsigned char *block, int rows)
+{
+	for (int y = 0; y < rows / 2; ++y)
+	{
+		std::swap (block[2 * y], block[2 * (rows - 1 - y)]);
+		std::swap (block[2 * y + 1], block[2 * (rows - 1 - y) + 1]);
+	}
+}
+
+/**
+  * Reverse the rows of a BC3 block's 3 bit alpha indices, 12 bits a row.
+  */
+void flipInterpolatedAlpha (unsigned char *block, int rows)
+{
+	unsigned long long bits = 0;
+	for (int i = 0; i < 6; ++i)
+	{
+		bits |= (unsigned long long)block[2 + i] << (8 * i);
+	}
+	unsigned long long flipped = bits;
+	for (int y = 0; y < rows; ++y)
+	{
+		const int to = 12 * (rows - 1 - y);
+		flipped = (flipped & ~(0xfffull << to)) | (((bits >> (12 * y)) & 0xfff) << to);
+	}
+	for (int i = 0; i < 6; ++i)
+	{
+		block[2 + i] = (unsigned char)(flipped >> (8 * i));
+	}
+}
+
+/**
+  * Turn a level upside down, between the bottom row first order of GL and
+  * the top row first order of DDS files: the rows of blocks swap, and the
+  * rows of texels within each block.  Exact when the height is a multiple
+  * of 4 or less than 4; otherwise the padding rows of the last blocks end
+  * up at the top.  BC7 blocks cannot be flipped without decoding them, so
+  * returns false and leaves them as they are.
+  */
+bool flipLevel (GLenum format, GLsizei width, GLsizei height, std::vector <unsigned char> &level)
+{
+	const int block_bytes = blockBytes (format);
+	if (format == GL_COMPRESSED_RGBA_BPTC_UNORM_ARB || format == GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB)
+	{
+		return false;
+	}
+
+	const size_t row_bytes = (size_t)((width + 3) / 4) * block_bytes;
+	const int block_rows = (height + 3) / 4;
+	for (int y = 0; y < block_rows / 2; ++y)
+	{
+		std::swap_ranges (level.begin () + y * row_bytes, level.begin () + (y + 1) * row_bytes,
+		                  level.begin () + (block_rows - 1 - y) * row_bytes);
+	}
+
+	const int rows = std::min (height, 4);
+	for (size_t offset = 0; offset + block_bytes <= level.size (); offset += block_bytes)
+	{
+		unsigned char *block = &level[offset];
+		if (block_bytes == 16)
+		{
+			if (format == GL_COMPRESSED_RGBA_S3TC_DXT3_EXT || format == GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT)
+			{
+				flipExplicitAlpha (block, rows);
+			}
+			else
+			{
+				flipInterpolatedAlpha (block, rows);
+			}
+			block += 8;
+		}
+		flipColors (block, rows);
+	}
+	return true;
+}
+
+void loadDDS (const std::string &filename, const std::vector <unsigned char> &file, CompressedImage &image)
+{
+	if (file.size () < 128 || readU32 (&file[0]) != fourCC ("DDS ") || readU32 (&file[4]) != 124)
+	{
+		fail (filename, "not a DDS file");
+	}
+
+	const unsigned char *header = &file[4];
+	image.height = readU32 (header + 8);
+	image.width = readU32 (header + 12);
+	unsigned int levels = std::max (readU32 (header + 24), 1u);
+	unsigned int pixel_flags = readU32 (header + 76);
+	unsigned int code = readU32 (header + 80);
+	size_t data_offset = 128;
+	if (!(pixel_flags & DDPF_FOURCC))
+	{
+		fail (filename, "not block compressed");
+	}
+
+	if (code == fourCC ("DXT1"))
+	{
+		image.format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+	}
+	else if (code == fourCC ("DXT3"))
+	{
+		image.format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+	}
+	else if (code == fourCC ("DXT5"))
+	{
+		image.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	}
+	else if (code == fourCC ("DX10"))
+	{
+		if (file.size () < 148)
+		{
+			fail (filename, "truncated");
+		}
+
+		// DXGI_FORMAT values of the BC1, BC2, BC3 and BC7 variants.
+		data_offset = 148;
+		switch (readU32 (&file[128]))
+		{
+			case 71: image.format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; break;
+			case 72: image.format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; break;
+			case 74: image.format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; break;
+			case 75: image.format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; break;
+			case 77: image.format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; break;
+			case 78: image.format = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; break;
+			case 98: image.format = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB; break;
+			case 99: image.format = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB; break;
+			default: fail (filename, "unsupported DXGI format");
+		}
+	}
+	else
+	{
+		fail (filename, "unsupported compression");
+	}
+
+	readLevels (filename, &file[0] + data_offset, file.size () - data_offset, levels, image);
+
+	// DDS files store the top row first.
+	for (size_t i = 0; i < image.levels.size (); ++i)
+	{
+		flipLevel (image.format, std::max (image.width >> i, 1), std::max (image.height >> i, 1), image.levels[i]);
+	}
+}
+
+void loadKTX (const std::string &filename, const std::vector <unsigned char> &file, CompressedImage &image)
+{
+	static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+	if (file.size () < 64 || memcmp (&file[0], identifier, 12) != 0)
+	{
+		fail (filename, "not a KTX file");
+	}
+
+	const bool swap = readU32 (&file[12]) != 0x04030201;
+	const unsigned char *header = &file[16];
+	unsigned int type = readU32 (header, swap);
+	image.format = readU32 (header + 12, swap);
+	image.width = readU32 (header + 20, swap);
+	image.height = readU32 (header + 24, swap);
+	unsigned int depth = readU32 (header + 28, swap);
+	unsigned int elements = readU32 (header + 32, swap);
+	unsigned int faces = readU32 (header + 36, swap);
+	unsigned int levels = std::max (readU32 (header + 40, swap), 1u);
+	unsigned int key_values = readU32 (header + 44, swap);
+	if (type != 0 || blockBytes (image.format) == 0)
+	{
+		fail (filename, "not block compressed");
+	}
+	if (depth > 1 || elements > 0 || faces != 1)
+	{
+		fail (filename, "not a 2D texture");
+	}
+
+	// Each level is its size followed by its data, padded to 4 bytes.
+	image.levels.clear ();
+	size_t offset = 64 + key_values;
+	for (unsigned int level = 0; level < levels; ++level)
+	{
+		if (offset + 4 > file.size ())
+		{
+			fail (filename, "truncated");
+		}
+		size_t bytes = readU32 (&file[offset], swap);
+		offset += 4;
+		if (bytes != levelSize (image.format, std::max (image.width >> level, 1), std::max (image.height >> level, 1)) ||
+		    offset + bytes > file.size ())
+		{
+			fail (filename, "bad level size");
+		}
+		image.levels.push_back (std::vector <unsigned char> (&file[offset], &file[offset] + bytes));
+		offset += (bytes + 3) & ~(size_t)3;
+	}
+}
+
+/**
+  * Color of a 5:6:5 endpoint, expanded to 8 bits per channel (r, g, b).
+  */
+inline void unpack565 (unsigned int color, float *rgb)
+{
+	unsigned int r = (color >> 11) & 31;
+	unsigned int g = (color >> 5) & 63;
+	unsigned int b = color & 31;
+	rgb[0] = (float)((r << 3) | (r >> 2));
+	rgb[1] = (float)((g << 2) | (g >> 4));
+	rgb[2] = (float)((b << 3) | (b >> 2));
+}
+
+inline unsigned int pack565 (const float *rgb)
+{
+	unsigned int r = (unsigned int)(std::min (std::max (rgb[0], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+	unsigned int g = (unsigned int)(std::min (std::max (rgb[1], 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+	unsigned int b = (unsigned int)(std::min (std::max (rgb[2], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+	return (r << 11) | (g << 5) | b;
+}
+
+/**
+  * Encode the colors of a block: endpoints at the extremes of the block
+  * along its principal axis, inset a little, and each texel given the
+  * nearest of the four palette colors.
+  * @param pixels 16 BGRA texels, row by row.
+  * @param out 8 bytes.
+  */
+void encodeColors (const unsigned char *pixels, unsigned char *out)
+{
+	// Channels as r, g, b floats.
+	float rgb[16][3];
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; ++i)
+	{
+		rgb[i][0] = pixels[i * 4 + 2];
+		rgb[i][1] = pixels[i * 4 + 1];
+		rgb[i][2] = pixels[i * 4 + 0];
+		for (int c = 0; c < 3; ++c)
+		{
+			mean[c] += rgb[i][c];
+		}
+	}
+	for (int c = 0; c < 3; ++c)
+	{
+		mean[c] /= 16.0f;
+	}
+
+	float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; ++i)
+	{
+		float r = rgb[i][0] - mean[0];
+		float g = rgb[i][1] - mean[1];
+		float b = rgb[i][2] - mean[2];
+		covariance[0] += r * r;
+		covariance[1] += r * g;
+		covariance[2] += r * b;
+		covariance[3] += g * g;
+		covariance[4] += g * b;
+		covariance[5] += b * b;
+	}
+
+	// Principal axis by power iteration; luminance for flat blocks.
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for (int iteration = 0; iteration < 4; ++iteration)
+	{
+		float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+		float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+		float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+		float largest = std::max (fabsf (x), std::max (fabsf (y), fabsf (z)));
+		if (largest < 1.0e-4f)
+		{
+			axis[0] = 0.299f;
+			axis[1] = 0.587f;
+			axis[2] = 0.114f;
+			break;
+		}
+		axis[0] = x / largest;
+		axis[1] = y / largest;
+		axis[2] = z / largest;
+	}
+	float length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+	float low = 1.0e30f;
+	float high = -1.0e30f;
+	for (int i = 0; i < 16; ++i)
+	{
+		float t = ((rgb[i][0] - mean[0]) * axis[0] + (rgb[i][1] - mean[1]) * axis[1] + (rgb[i][2] - mean[2]) * axis[2]) / length;
+		low = std::min (low, t);
+		high = std::max (high, t);
+	}
+
+	// Inset the ends by 1/16 of the range: the extremes are rarely worth
+	// an endpoint of their own.
+	float inset = (high - low) / 16.0f;
+	low += inset;
+	high -= inset;
+	float end0[3], end1[3];
+	for (int c = 0; c < 3; ++c)
+	{
+		end0[c] = mean[c] + axis[c] * high;
+		end1[c] = mean[c] + axis[c] * low;
+	}
+
+	unsigned int color0 = pack565 (end0);
+	unsigned int color1 = pack565 (end1);
+	if (color0 < color1)
+	{
+		std::swap (color0, color1);
+	}
+
+	unsigned int indices = 0;
+	if (color0 != color1)
+	{
+		// Palette: the endpoints and the two colors between them.
+		float palette[4][3];
+		unpack565 (color0, palette[0]);
+		unpack565 (color1, palette[1]);
+		for (int c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+			palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+		}
+
+#ifdef MATH_USE_SSE
+		// Four texels at a time.
+		for (int i = 0; i < 16; i += 4)
+		{
+			__m128 r = _mm_set_ps (rgb[i + 3][0], rgb[i + 2][0], rgb[i + 1][0], rgb[i][0]);
+			__m128 g = _mm_set_ps (rgb[i + 3][1], rgb[i + 2][1], rgb[i + 1][1], rgb[i][1]);
+			__m128 b = _mm_set_ps (rgb[i + 3][2], rgb[i + 2][2], rgb[i + 1][2], rgb[i][2]);
+			__m128 best = _mm_set1_ps (1.0e30f);
+			__m128 best_index = _mm_setzero_ps ();
+			for (int k = 0; k < 4; ++k)
+			{
+				__m128 dr = _mm_sub_ps (r, _mm_set1_ps (palette[k][0]));
+				__m128 dg = _mm_sub_ps (g, _mm_set1_ps (palette[k][1]));
+				__m128 db = _mm_sub_ps (b, _mm_set1_ps (palette[k][2]));
+				__m128 distance = _mm_add_ps (_mm_add_ps (_mm_mul_ps (dr, dr), _mm_mul_ps (dg, dg)), _mm_mul_ps (db, db));
+				__m128 closer = _mm_cmplt_ps (distance, best);
+				best = _mm_min_ps (distance, best);
+				best_index = _mm_or_ps (_mm_and_ps (closer, _mm_set1_ps ((float)k)), _mm_andnot_ps (closer, best_index));
+			}
+
+			float chosen[4];
+			_mm_storeu_ps (chosen, best_index);
+			for (int j = 0; j < 4; ++j)
+			{
+				indices |= (unsigned int)chosen[j] << (2 * (i + j));
+			}
+		}
+#else
+		for (int i = 0; i < 16; ++i)
+		{
+			float best = 1.0e30f;
+			unsigned int best_index = 0;
+			for (int k = 0; k < 4; ++k)
+			{
+				float dr = rgb[i][0] - palette[k][0];
+				float dg = rgb[i][1] - palette[k][1];
+				float db = rgb[i][2] - palette[k][2];
+				float distance = dr * dr + dg * dg + db * db;
+				if (distance < best)
+				{
+					best = distance;
+					best_index = k;
+				}
+			}
+			indices |= best_index << (2 * i);
+		}
+#endif
+	}
+
+	out[0] = color0 & 0xff;
+	out[1] = color0 >> 8;
+	out[2] = color1 & 0xff;
+	out[3] = color1 >> 8;
+	writeU32 (out + 4, indices);
+}
+
+/**
+  * Encode the alpha of a block as BC3 does: the extremes as endpoints and
+  * six values between them.
+  * @param out 8 bytes.
+  */
+void encodeAlpha (const unsigned char *pixels, unsigned char *out)
+{
+	int alpha0 = 0;
+	int alpha1 = 255;
+	for (int i = 0; i < 16; ++i)
+	{
+		alpha0 = std::max (alpha0, (int)pixels[i * 4 + 3]);
+		alpha1 = std::min (alpha1, (int)pixels[i * 4 + 3]);
+	}
+
+	unsigned long long indices = 0;
+	if (alpha0 != alpha1)
+	{
+		int palette[8];
+		palette[0] = alpha0;
+		palette[1] = alpha1;
+		for (int k = 1; k < 7; ++k)
+		{
+			palette[k + 1] = ((7 - k) * alpha0 + k * alpha1 + 3) / 7;
+		}
+
+		for (int i = 0; i < 16; ++i)
+		{
+			int alpha = pixels[i * 4 + 3];
+			int best = 256;
+			unsigned long long best_index = 0;
+			for (int k = 0; k < 8; ++k)
+			{
+				int distance = abs (alpha - palette[k]);
+				if (distance < best)
+				{
+					best = distance;
+					best_index = k;
+				}
+			}
+			indices |= best_index << (3 * i);
+		}
+	}
+
+	out[0] = (unsigned char)alpha0;
+	out[1] = (unsigned char)alpha1;
+	for (int i = 0; i < 6; ++i)
+	{
+		out[2 + i] = (unsigned char)(indices >> (8 * i));
+	}
+}
+
+/**
+  * Encode block rows [first, last) of an image.
+  */
+void encodeRows (const unsigned char *bgra, GLsizei width, GLsizei height, size_t pitch,
+                 bool alpha, int first, int last, unsigned char *out)
+{
+	const int block_bytes = alpha ? 16 : 8;
+	const int blocks_wide = (width + 3) / 4;
+	unsigned char block[64];
+	for (int by = first; by < last; ++by)
+	{
+		unsigned char *row_out = out + (size_t)by * blocks_wide * block_bytes;
+		for (int bx = 0; bx < blocks_wide; ++bx)
+		{
+			// Gather the block, repeating the last row and column of sizes
+			// that are not a multiple of 4.  FreeImage stores the image
+			// bottom up, as GL expects it, so row 0 is the first row.
+			for (int y = 0; y < 4; ++y)
+			{
+				const unsigned char *source = bgra + std::min (by * 4 + y, height - 1) * pitch;
+				for (int x = 0; x < 4; ++x)
+				{
+					memcpy (block + (y * 4 + x) * 4, source + std::min (bx * 4 + x, width - 1) * 4, 4);
+				}
+			}
+
+			unsigned char *block_out = row_out + bx * block_bytes;
+			if (alpha)
+			{
+				encodeAlpha (block, block_out);
+				block_out += 8;
+			}
+			encodeColors (block, block_out);
+		}
+	}
+}
+
+}
+
+int blockBytes (GLenum format)
+{
+	switch (format)
+	{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+			return 8;
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+		case GL_COMPRESSED_RGBA_BPTC_UNORM_ARB:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB:
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+size_t levelSize (GLenum format, GLsizei width, GLsizei height)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes (format);
+}
+
+bool isSupported (GLenum format)
+{
+	switch (format)
+	{
+		case GL_COMPRESSED_RGBA_BPTC_UNORM_ARB:
+		case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB:
+			return GLEW_ARB_texture_compression_bptc;
+		case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+			return GLEW_EXT_texture_compression_s3tc && GLEW_EXT_texture_sRGB;
+		default:
+			return blockBytes (format) != 0 && GLEW_EXT_texture_compression_s3tc;
+	}
+}
+
+bool isCompressedFile (const std::string &filename)
+{
+	size_t dot = filename.find_last_of ('.');
+	if (dot == std::string::npos)
+	{
+		return false;
+	}
+
+	std::string extension = filename.substr (dot + 1);
+	std::transform (extension.begin (), extension.end (), extension.begin (), ::tolower);
+	return extension == "dds" || extension == "ktx";
+}
+
+void load (const std::string &filename, CompressedImage &image)
+{
+	std::ifstream fin (filename.c_str (), std::ios::binary);
+	if (!fin)
+	{
+		fail (filename, "cannot open");
+	}
+	std::vector <unsigned char> file ((std::istreambuf_iterator <char> (fin)), std::istreambuf_iterator <char> ());
+
+	if (file.size () >= 4 && readU32 (&file[0]) == fourCC ("DDS "))
+	{
+		loadDDS (filename, file, image);
+	}
+	else
+	{
+		loadKTX (filename, file, image);
+	}
+}
+
+bool saveDDS (const std::string &filename, const CompressedImage &image)
+{
+	unsigned int code = 0;
+	switch (image.format)
+	{
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+			code = fourCC ("DXT1");
+			break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+			code = fourCC ("DXT3");
+			break;
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+			code = fourCC ("DXT5");
+			break;
+		default:
+			return false;
+	}
+
+	unsigned char header[128];
+	memset (header, 0, sizeof (header));
+	writeU32 (header, fourCC ("DDS "));
+	writeU32 (header + 4, 124);
+	writeU32 (header + 8, DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | DDSD_LINEARSIZE);
+	writeU32 (header + 12, image.height);
+	writeU32 (header + 16, image.width);
+	writeU32 (header + 20, image.levels.empty () ? 0 : (unsigned int)image.levels[0].size ());
+	writeU32 (header + 28, (unsigned int)image.levels.size ());
+	writeU32 (header + 76, 32);
+	writeU32 (header + 80, DDPF_FOURCC);
+	writeU32 (header + 84, code);
+	writeU32 (header + 108, DDSCAPS_TEXTURE | (image.levels.size () > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0));
+
+	std::ofstream fout (filename.c_str (), std::ios::binary);
+	if (!fout)
+	{
+		return false;
+	}
+	fout.write ((const char *)header, sizeof (header));
+	for (size_t i = 0; i < image.levels.size (); ++i)
+	{
+		// Top row first, as other DDS readers expect.
+		std::vector <unsigned char> level = image.levels[i];
+		flipLevel (image.format, std::max (image.width >> i, 1), std::max (image.height >> i, 1), level);
+		fout.write ((const char *)&level[0], level.size ());
+	}
+	return (bool)fout;
+}
+
+void encode (const unsigned char *bgra, GLsizei width, GLsizei height, size_t pitch,
+             GLenum format, std::vector <unsigned char> &out, unsigned int threads)
+{
+	const bool alpha = blockBytes (format) == 16;
+	const int block_rows = (height + 3) / 4;
+	out.resize (levelSize (format, width, height));
+
+	// Small levels are not worth a thread, and neither is a pool job: the
+	// loader encodes one texture per worker already.
+	if (threads == 0)
+	{
+		threads = util::ThreadPool::isWorker () ? 1 : std::max (std::thread::hardware_concurrency (), 1u);
+	}
+	threads = std::min (threads, (unsigned int)std::max (block_rows / 16, 1));
+	if (threads == 1)
+	{
+		encodeRows (bgra, width, height, pitch, alpha, 0, block_rows, &out[0]);
+		return;
+	}
+
+	std::vector <std::thread> workers;
+	for (unsigned int i = 0; i < threads; ++i)
+	{
+		int first = block_rows * i / threads;
+		int last = block_rows * (i + 1) / threads;
+		workers.push_back (std::thread (encodeRows, bgra, width, height, pitch, alpha, first, last, &out[0]));
+	}
+	for (size_t i = 0; i < workers.size (); ++i)
+	{
+		workers[i].join ();
+	}
+}
+
+}
+
+}
@@ -0,0 +1,89 @@
+/*
+   Filename : TextureCompression.h
+   Version  : 1.0
+
+   Purpose  : Block-compressed images: DDS and KTX reading, DDS writing, and
+              a BC1/BC3 encoder for images decoded by FreeImage.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+
+namespace gfx
+{
+
+/**
+  * A block-compressed image and its mipmap chain, ready for
+  * glCompressedTexImage2D.
+  */
+struct CompressedImage
+{
+	CompressedImage (void) : format (0), width (0), height (0) {}
+
+	GLenum  format;		// GL internal format, such as GL_COMPRESSED_RGBA_S3TC_DXT5_EXT.
+	GLsizei width;		// Size of level 0.
+	GLsizei height;
+	std::vector <std::vector <unsigned char> > levels;
+};
+
+namespace compression
+{
+
+/**
+  * Bytes per 4x4 block of a compressed format, or 0 if it is not one this
+  * code knows.
+  */
+int blockBytes (GLenum format);
+
+/**
+  * Bytes of a width x height level in a compressed format.
+  */
+size_t levelSize (GLenum format, GLsizei width, GLsizei height);
+
+/**
+  * Returns true if the GL reports support for format.  Needs glewInit ().
+  */
+bool isSupported (GLenum format);
+
+/**
+  * Returns true if filename has an extension load () reads (.dds, .ktx).
+  */
+bool isCompressedFile (const std::string &filename);
+
+/**
+  * Read a DDS (BC1, BC2, BC3 or BC7) or KTX file of a compressed 2D texture.
+  * The levels of DDS files, stored top row first, are flipped to the bottom
+  * row first order of GL, except BC7 ones; KTX levels are read as stored.
+  * Throws std::runtime_error if the file cannot be read or is not one.
+  */
+void load (const std::string &filename, CompressedImage &image);
+
+/**
+  * Write image, bottom row first, as a DDS file, top row first.  Returns
+  * false on failure.
+  */
+bool saveDDS (const std::string &filename, const CompressedImage &image);
+
+/**
+  * Encode a 32 bit BGRA image, as FreeImage lays it out, into BC1 or BC3.
+  * Block rows are split between threads.
+  * @param format GL_COMPRESSED_RGB_S3TC_DXT1_EXT or
+  *        GL_COMPRESSED_RGBA_S3TC_DXT5_EXT.
+  * @param pitch Bytes from one row of bgra to the next.
+  * @param out Receives levelSize (format, width, height) bytes.
+  * @param threads Threads to use; 0 for one per hardware thread, or just
+  *        the caller's on a util::ThreadPool worker.
+  */
+void encode (const unsigned char *bgra, GLsizei width, GLsizei height, size_t pitch,
+             GLenum format, std::vector <unsigned char> &out, unsigned int threads = 0);
+
+}
+
+}
@@ -0,0 +1,124 @@
+/*
+   Filename : TextureLoader.cpp
+   Version  : 1.0
+
+   Purpose  : Decodes images into Textures on a thread pool, all of a batch
+              at once.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <TextureLoader.h>
+#include <mutex>
+
+namespace gfx
+{
+
+/**
+  * Loads of a batch still running.  The last one to finish, once the batch
+  * is closed, completes the batch's future.
+  */
+struct TextureLoader::Batch
+{
+	Batch (void) : left (0), closed (false) {}
+
+	void complete (void)
+	{
+		if (error)
+		{
+			done.set_exception (error);
+		}
+		else
+		{
+			done.set_value ();
+		}
+	}
+
+	std::promise <void> done;
+	std::mutex 			mutex;
+	int 				left;
+	bool 				closed;
+	std::exception_ptr 	error;		// First load that failed.
+};
+
+TextureLoader::TextureLoader (util::ThreadPool &pool)
+	: m_pool (pool),
+	  m_batch (std::make_shared <Batch> ())
+{
+}
+
+std::shared_future <void> TextureLoader::load (Texture &texture, const std::string &filename)
+{
+	// The caller keeps the texture alive.
+	return load (std::shared_ptr <Texture> (&texture, [] (Texture *) {}), filename);
+}
+
+std::shared_future <void> TextureLoader::load (const std::shared_ptr <Texture> &texture, const std::string &filename)
+{
+	return load (texture, [filename] (Texture &target) { target.load (filename.c_str ()); });
+}
+
+std::shared_future <void> TextureLoader::load (const std::shared_ptr <Texture> &texture, const std::function <void (Texture &)> &fill)
+{
+	std::shared_ptr <Batch> batch = m_batch;
+	{
+		std::lock_guard <std::mutex> lock (batch->mutex);
+		++batch->left;
+	}
+
+	std::shared_ptr <Texture> target = texture;
+	return m_pool.submit ([batch, target, fill] () mutable
+	{
+		std::exception_ptr error;
+		try
+		{
+			fill (*target);
+			target->buildMipmaps ();
+		}
+		catch (...)
+		{
+			error = std::current_exception ();
+		}
+
+		// Let go of the texture before it can be uploaded, so that it is
+		// never deleted here with GL objects to delete.
+		target.reset ();
+
+		{
+			std::lock_guard <std::mutex> lock (batch->mutex);
+			if (error && !batch->error)
+			{
+				batch->error = error;
+			}
+			if (--batch->left == 0 && batch->closed)
+			{
+				batch->complete ();
+			}
+		}
+
+		// Also fail this texture's own future.
+		if (error)
+		{
+			std::rethrow_exception (error);
+		}
+	}).share ();
+}
+
+std::shared_future <void> TextureLoader::finish (void)
+{
+	std::shared_ptr <Batch> batch = m_batch;
+	m_batch = std::make_shared <Batch> ();
+
+	std::shared_future <void> done = batch->done.get_future ().share ();
+	std::lock_guard <std::mutex> lock (batch->mutex);
+	batch->closed = true;
+	if (batch->left == 0)
+	{
+		batch->complete ();
+	}
+	return done;
+}
+
+}
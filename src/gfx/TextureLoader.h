@@ -0,0 +1,71 @@
+/*
+   Filename : TextureLoader.h
+   Version  : 1.0
+
+   Purpose  : Decodes images into Textures on a thread pool, all of a batch
+              at once.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#pragma once
+
+#include <Texture.h>
+#include <ThreadPool.h>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+
+namespace gfx
+{
+
+/**
+  * Submits Texture::load () calls to a thread pool.  Submit every image
+  * first, then wait on the futures or hand them to the upload queues: the
+  * images decode in parallel, one per worker.  A texture must not be used
+  * until its future is ready.
+  */
+class TextureLoader
+{
+	public:
+
+		explicit TextureLoader (util::ThreadPool &pool);
+
+		/**
+		  * Decode filename into texture on the pool, and build its mipmap
+		  * chain there so that TextureUpload can stream it smallest first.
+		  * @return Ready once texture is loaded; rethrows what load () threw.
+		  */
+		std::shared_future <void> load (Texture &texture, const std::string &filename);
+
+		/**
+		  * As above, also keeping texture alive until it is decoded.
+		  */
+		std::shared_future <void> load (const std::shared_ptr <Texture> &texture, const std::string &filename);
+
+		/**
+		  * Fill texture with fill, in place of a file, on the pool and build
+		  * its mipmap chain there.
+		  * @return Ready once fill has run; rethrows what it threw.
+		  */
+		std::shared_future <void> load (const std::shared_ptr <Texture> &texture, const std::function <void (Texture &)> &fill);
+
+		/**
+		  * End the batch of loads submitted since the last call.
+		  * @return Ready once every load of the batch is done (at once if
+		  *         there were none), with the first error if any failed.
+		  */
+		std::shared_future <void> finish (void);
+
+	private:
+
+		struct Batch;
+
+		util::ThreadPool 		&m_pool;
+		std::shared_ptr <Batch>  m_batch;
+};
+
+}
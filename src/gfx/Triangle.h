@@ -13,6 +13,7 @@
 #pragma once
 
 #include <Vector.h>
+#include <VectorExpression.h>
 #include <Material.h>
 #include <vector>
 
@@ -130,7 +131,7 @@ class Triangle
 			// Compute the last barycentric coordinate (a + b + c = 0)
 			T c = (T)1 - a - b;
 
-			return math::normalize (m_normals[0] * a + m_normals[1] * b + m_normals[2] * c);
+			return math::normalize (math::eval (math::lazy (m_normals[0]) * a + math::lazy (m_normals[1]) * b + math::lazy (m_normals[2]) * c));
 		}
 
 		/**
@@ -255,8 +256,9 @@ class Triangle
 			math::Vector <T, 3> edge1 = v2 - v1;
 			math::Vector <T, 3> edge2 = v3 - v1;
 
-			t = ((edge1 * (t3[1] - t1[1])) - (edge2 * (t2[1] - t1[1]))) * det;
-			b = ((edge1 * (-(t3[0] - t1[0]))) + (edge2 * (t2[0] - t1[0]))) * det;
+			// Fused into one loop per vector, no temporaries.
+			t = ((math::lazy (edge1) * (t3[1] - t1[1])) - (math::lazy (edge2) * (t2[1] - t1[1]))) * det;
+			b = ((math::lazy (edge1) * (-(t3[0] - t1[0]))) + (math::lazy (edge2) * (t2[0] - t1[0]))) * det;
 			t = normalize (t);
 			b = normalize (b);
 			math::Vector <T, 3> normal = cross (t, b);
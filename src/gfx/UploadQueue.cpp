@@ -0,0 +1,428 @@
+/*
+   Filename : UploadQueue.cpp
+   Version  : 1.0
+
+   Purpose  : Per-context queue of GPU uploads, spread over frames.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <UploadQueue.h>
+#include <util.h>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+namespace gfx
+{
+
+UploadJob::UploadJob (std::shared_future <void> prepared)
+	: m_prepared (prepared)
+{
+}
+
+UploadJob::~UploadJob (void)
+{
+}
+
+bool UploadJob::isPrepared (void) const
+{
+	if (!m_prepared.valid ())
+	{
+		return true;
+	}
+	if (m_prepared.wait_for (std::chrono::seconds (0)) != std::future_status::ready)
+	{
+		return false;
+	}
+
+	// Rethrow on the render thread what preparing the data threw.
+	m_prepared.get ();
+	return true;
+}
+
+void UploadJob::cancel (void)
+{
+}
+
+FunctionUpload::FunctionUpload (size_t bytes, const std::function <void ()> &upload, std::shared_future <void> prepared)
+	: UploadJob (prepared),
+	  m_bytes (bytes),
+	  m_upload (upload),
+	  m_finished (false)
+{
+}
+
+size_t FunctionUpload::upload (size_t budget, bool force)
+{
+	if (m_bytes > budget && !force)
+	{
+		return 0;
+	}
+
+	m_upload ();
+	m_finished = true;
+	return m_bytes;
+}
+
+TextureUpload::TextureUpload (Texture &texture, int context_id, std::shared_future <void> prepared)
+	: UploadJob (prepared),
+	  m_texture (texture),
+	  m_context_id (context_id),
+	  m_id (0),
+	  m_pbo (0),
+	  m_first (0),
+	  m_level (0),
+	  m_row (0),
+	  m_claimed (false),
+	  m_published (false),
+	  m_finished (false)
+{
+}
+
+size_t TextureUpload::upload (size_t budget, bool force)
+{
+	if (!m_id)
+	{
+		// Another context of the share group is streaming the texture: wait
+		// for it to be published.
+		if (!m_claimed && !claim ())
+		{
+			return 0;
+		}
+
+		bool started = false;
+		try
+		{
+			started = start ();
+		}
+		catch (...)
+		{
+			release ();
+			throw;
+		}
+		if (!started)
+		{
+			m_finished = true;
+			release ();
+			return 0;
+		}
+	}
+
+	// Small levels take little of the budget, so several may go up in one
+	// frame.
+	size_t uploaded = 0;
+	while (!m_finished)
+	{
+		Texture::Level level = m_texture.getLevel (m_level);
+		int rows = (int)std::min ((budget - uploaded) / level.rowBytes, (size_t)(level.rows - m_row));
+		if (rows == 0)
+		{
+			if (!force || uploaded > 0)
+			{
+				break;
+			}
+			rows = 1;
+		}
+
+		uploadRows (rows);
+		uploaded += level.rowBytes * rows;
+		if (m_row == level.rows)
+		{
+			finishLevel ();
+		}
+	}
+
+	return uploaded;
+}
+
+bool TextureUpload::start (void)
+{
+	// Nothing to do when a context sharing objects with this one got there
+	// first, or when there is nothing loaded.
+	if (m_texture.valid (m_context_id))
+	{
+		m_texture.notifyUploaded (m_context_id);
+		return false;
+	}
+	if (!m_texture.hasData ())
+	{
+		return false;
+	}
+
+	const bool compressed = m_texture.isCompressed ();
+	const GLenum format = m_texture._compressed.format;
+	if (compressed && !compression::isSupported (format))
+	{
+		std::stringstream error;
+		error << "TextureUpload::start (): \"" << m_texture.texture_name << "\" is compressed in a format the GL does not support.\n";
+		throw std::runtime_error (error.str ());
+	}
+
+	GLint max_size = 0;
+	glGetIntegerv (GL_MAX_TEXTURE_SIZE, &max_size);
+	const int levels = m_texture.getLevelCount ();
+	m_first = 0;
+	Texture::Level level = m_texture.getLevel (m_first);
+	while ((level.width > max_size || level.height > max_size) && m_first + 1 < levels)
+	{
+		level = m_texture.getLevel (++m_first);
+	}
+	if (level.width > max_size || level.height > max_size)
+	{
+		// Too large for the GPU and no smaller level to start from:
+		// createTextureObject () scales it down on the CPU.
+		m_texture.createTextureObject (m_context_id);
+		return false;
+	}
+
+	glGenTextures (1, &m_id);
+	glBindTexture (GL_TEXTURE_2D, m_id);
+	m_texture.applyParams ();
+	for (int i = m_first; i < levels; ++i)
+	{
+		level = m_texture.getLevel (i);
+		if (compressed)
+		{
+			glCompressedTexImage2D (GL_TEXTURE_2D, i - m_first, format, level.width, level.height, 0, (GLsizei)(level.rowBytes * level.rows), NULL);
+		}
+		else
+		{
+			glTexImage2D (GL_TEXTURE_2D, i - m_first, m_texture._params.internalFormat, level.width, level.height, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+		}
+	}
+	if (levels > 1 || compressed)
+	{
+		// Sample only the levels uploaded so far.
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1 - m_first);
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, levels - 1 - m_first);
+	}
+	glBindTexture (GL_TEXTURE_2D, 0);
+	glGenBuffers (1, &m_pbo);
+
+	m_level = levels - 1;
+	m_row = 0;
+	return true;
+}
+
+void TextureUpload::uploadRows (int rows)
+{
+	Texture::Level level = m_texture.getLevel (m_level);
+
+	// Copy the band into a freshly orphaned pixel buffer and let the driver
+	// transfer it to the texture from there.
+	const size_t bytes = level.rowBytes * rows;
+	glBindBuffer (GL_PIXEL_UNPACK_BUFFER, m_pbo);
+	glBufferData (GL_PIXEL_UNPACK_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+	unsigned char *mapped = (unsigned char *)glMapBuffer (GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+	for (int i = 0; i < rows; ++i)
+	{
+		const unsigned char *source = level.bits + (m_row + i) * level.pitch;
+		if (mapped)
+		{
+			memcpy (mapped + i * level.rowBytes, source, level.rowBytes);
+		}
+		else
+		{
+			glBufferSubData (GL_PIXEL_UNPACK_BUFFER, i * level.rowBytes, level.rowBytes, source);
+		}
+	}
+	if (mapped)
+	{
+		glUnmapBuffer (GL_PIXEL_UNPACK_BUFFER);
+	}
+
+	// Blocks of the last row may hang over the bottom of the level.
+	const GLint y = m_row * level.rowHeight;
+	const GLsizei height = std::min (rows * level.rowHeight, level.height - y);
+	glBindTexture (GL_TEXTURE_2D, m_id);
+	if (m_texture.isCompressed ())
+	{
+		glCompressedTexSubImage2D (GL_TEXTURE_2D, m_level - m_first, 0, y, level.width, height, m_texture._compressed.format, (GLsizei)bytes, (char *)NULL);
+	}
+	else
+	{
+		glTexSubImage2D (GL_TEXTURE_2D, m_level - m_first, 0, y, level.width, height, GL_BGRA, GL_UNSIGNED_BYTE, (char *)NULL);
+	}
+	glBindTexture (GL_TEXTURE_2D, 0);
+	glBindBuffer (GL_PIXEL_UNPACK_BUFFER, 0);
+	m_row += rows;
+}
+
+void TextureUpload::finishLevel (void)
+{
+	const bool chain = m_texture.getLevelCount () > 1 || m_texture.isCompressed ();
+	glBindTexture (GL_TEXTURE_2D, m_id);
+	if (chain)
+	{
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, m_level - m_first);
+	}
+	else
+	{
+		glGenerateMipmapEXT (GL_TEXTURE_2D);
+	}
+	glBindTexture (GL_TEXTURE_2D, 0);
+	checkGLErrors ("TextureUpload::finishLevel");
+
+	if (!m_published && !publish ())
+	{
+		// The texture of another context of the share group is in use.
+		cancel ();
+		m_finished = true;
+		m_texture.notifyUploaded (m_context_id);
+		return;
+	}
+
+	--m_level;
+	m_row = 0;
+	if (m_level < m_first)
+	{
+		glDeleteBuffers (1, &m_pbo);
+		m_pbo = 0;
+		m_id = 0;
+		m_finished = true;
+		release ();
+		m_texture.notifyUploaded (m_context_id);
+	}
+}
+
+bool TextureUpload::claim (void)
+{
+	std::lock_guard <std::mutex> lock (m_texture._create_mutex);
+	if (m_texture._ids[m_context_id] != 0)
+	{
+		// Already there: start () finds it valid.
+		return true;
+	}
+
+	bool &claimed = m_texture._claimed[m_context_id];
+	if (claimed)
+	{
+		return false;
+	}
+	claimed = true;
+	m_claimed = true;
+	return true;
+}
+
+void TextureUpload::release (void)
+{
+	if (m_claimed)
+	{
+		std::lock_guard <std::mutex> lock (m_texture._create_mutex);
+		m_texture._claimed[m_context_id] = false;
+		m_claimed = false;
+	}
+}
+
+bool TextureUpload::publish (void)
+{
+	std::lock_guard <std::mutex> lock (m_texture._create_mutex);
+	GLuint &id = m_texture._ids[m_context_id];
+	if (id != 0)
+	{
+		return false;
+	}
+
+	id = m_id;
+	m_published = true;
+	return true;
+}
+
+void TextureUpload::cancel (void)
+{
+	// Once published, the texture belongs to the context and is deleted with
+	// it.
+	if (m_id && !m_published)
+	{
+		glDeleteTextures (1, &m_id);
+	}
+	m_id = 0;
+	if (m_pbo)
+	{
+		glDeleteBuffers (1, &m_pbo);
+		m_pbo = 0;
+	}
+	release ();
+}
+
+UploadQueue::UploadQueue (size_t budget)
+	: m_budget (budget)
+{
+}
+
+UploadQueue::~UploadQueue (void)
+{
+	for (size_t i = 0; i < m_jobs.size (); ++i)
+	{
+		delete m_jobs[i];
+	}
+}
+
+void UploadQueue::push (UploadJob *job)
+{
+	m_jobs.push_back (job);
+}
+
+void UploadQueue::push (size_t bytes, const std::function <void ()> &upload, std::shared_future <void> prepared)
+{
+	push (new FunctionUpload (bytes, upload, prepared));
+}
+
+size_t UploadQueue::process (void)
+{
+	size_t uploaded = 0;
+	std::deque <UploadJob *>::iterator iter = m_jobs.begin ();
+	while (iter != m_jobs.end () && uploaded < m_budget)
+	{
+		UploadJob *job = *iter;
+		bool finished = false;
+		try
+		{
+			if (!job->isPrepared ())
+			{
+				++iter;
+				continue;
+			}
+
+			uploaded += job->upload (m_budget - uploaded, uploaded == 0);
+			finished = job->isFinished ();
+		}
+		catch (const std::exception &error)
+		{
+			// Report a failed decode or upload once and drop the job; what it
+			// was uploading stays invalid on the context.
+			std::cout << "UploadQueue::process () - Error: " << error.what () << std::endl;
+			job->cancel ();
+			finished = true;
+		}
+
+		if (finished)
+		{
+			delete job;
+			iter = m_jobs.erase (iter);
+		}
+		else
+		{
+			++iter;
+		}
+	}
+
+	return uploaded;
+}
+
+void UploadQueue::clear (void)
+{
+	for (size_t i = 0; i < m_jobs.size (); ++i)
+	{
+		m_jobs[i]->cancel ();
+		delete m_jobs[i];
+	}
+	m_jobs.clear ();
+}
+
+}
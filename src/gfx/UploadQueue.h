@@ -0,0 +1,225 @@
+/*
+   Filename : UploadQueue.h
+   Version  : 1.0
+
+   Purpose  : Per-context queue of GPU uploads, spread over frames.  The
+              CPU side of a resource (decoding, interleaving) is prepared
+              once, possibly on worker threads, and each context then only
+              copies it to the GPU, a limited number of bytes per frame.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+#include <Texture.h>
+#include <deque>
+#include <functional>
+#include <future>
+
+namespace gfx
+{
+
+/**
+  * One resource to upload to a context.
+  */
+class UploadJob
+{
+	public:
+
+		/**
+		  * @param prepared Becomes ready once the CPU data of the resource is;
+		  *        the job is skipped until then.  Default: ready now.
+		  */
+		explicit UploadJob (std::shared_future <void> prepared = std::shared_future <void> ());
+
+		virtual ~UploadJob (void);
+
+		/**
+		  * Returns true once the CPU data is ready to upload.  Rethrows the
+		  * exception preparing it ended with, if any.
+		  */
+		bool isPrepared (void) const;
+
+		/**
+		  * Upload part of the resource.  Called with the context current.
+		  * @param budget Bytes left to upload this frame.
+		  * @param force Nothing has been uploaded this frame yet, so a job
+		  *        that cannot be split must go ahead even above budget.
+		  * @return Bytes uploaded.
+		  */
+		virtual size_t upload (size_t budget, bool force) = 0;
+
+		/**
+		  * Returns true when nothing is left to upload.
+		  */
+		virtual bool isFinished (void) const = 0;
+
+		/**
+		  * Release whatever the job created on the context without
+		  * finishing.  Called with the context current.
+		  */
+		virtual void cancel (void);
+
+	private:
+
+		std::shared_future <void> m_prepared;
+};
+
+/**
+  * Upload done in one go by a function, such as filling a vertex buffer.
+  */
+class FunctionUpload : public UploadJob
+{
+	public:
+
+		/**
+		  * @param bytes Size of the upload, counted against the budget.
+		  * @param upload Function doing the upload.
+		  */
+		FunctionUpload (size_t bytes, const std::function <void ()> &upload,
+		                std::shared_future <void> prepared = std::shared_future <void> ());
+
+		virtual size_t upload (size_t budget, bool force);
+		virtual bool isFinished (void) const { return m_finished; }
+
+	private:
+
+		size_t m_bytes;
+		std::function <void ()> m_upload;
+		bool m_finished;
+};
+
+/**
+  * Streams a loaded texture to a context through a pixel buffer object, a
+  * band of rows at a time.  When the texture has a mipmap chain built on
+  * the CPU (Texture::buildMipmaps ()), the levels go up smallest first: the
+  * texture becomes valid () on the context as soon as the smallest level is
+  * there, sampled from the finest level uploaded so far, and sharpens over
+  * the following frames.  Otherwise level 0 goes up alone and the mipmaps
+  * are generated on the GPU, and the texture is only valid () once complete.
+  * Block-compressed textures stream the same way, a row of blocks at a time,
+  * and are never given generated mipmaps.
+  */
+class TextureUpload : public UploadJob
+{
+	public:
+
+		TextureUpload (Texture &texture, int context_id,
+		               std::shared_future <void> prepared = std::shared_future <void> ());
+
+		virtual size_t upload (size_t budget, bool force);
+		virtual bool isFinished (void) const { return m_finished; }
+		virtual void cancel (void);
+
+	private:
+
+		/**
+		  * Create the texture and define its levels.  Returns false when
+		  * there is nothing to stream.
+		  */
+		bool start (void);
+
+		/**
+		  * Claim the texture of the context's share group for this job, so
+		  * that only one context streams it.  Returns false while another
+		  * context's job holds the claim.
+		  */
+		bool claim (void);
+
+		/**
+		  * Give up the claim, if held.
+		  */
+		void release (void);
+
+		/**
+		  * Copy rows of the current level through the pixel buffer.
+		  */
+		void uploadRows (int rows);
+
+		/**
+		  * The current level is complete: make it the base level, and move
+		  * to the next finer one.
+		  */
+		void finishLevel (void);
+
+		/**
+		  * Give the texture to the context, unless another context of its
+		  * share group got there first.  Returns false in that case.
+		  */
+		bool publish (void);
+
+		Texture &m_texture;
+		int 	 m_context_id;
+		GLuint 	 m_id;			// Texture being filled.
+		GLuint 	 m_pbo;
+		int 	 m_first;		// Level of the chain uploaded as level 0 of the texture.
+		int 	 m_level;		// Level of the chain being uploaded.
+		int 	 m_row;			// Next row of that level, of texels or blocks.
+		bool 	 m_claimed;		// Holds the claim on the share group's texture.
+		bool 	 m_published;	// m_id is the context's texture.
+		bool 	 m_finished;
+};
+
+/**
+  * Uploads of one context, processed in order once per frame.
+  */
+class UploadQueue
+{
+	public:
+
+		/**
+		  * @param budget Bytes to upload per frame.
+		  */
+		explicit UploadQueue (size_t budget = 8 * 1024 * 1024);
+
+		/**
+		  * Destructor.  Deletes the jobs left; call clear () first, with the
+		  * context current, to also release what they created.
+		  */
+		~UploadQueue (void);
+
+		void setBudget (size_t budget) { m_budget = budget; }
+		size_t getBudget (void) const { return m_budget; }
+
+		/**
+		  * Queue a job.  The queue takes ownership.
+		  */
+		void push (UploadJob *job);
+
+		/**
+		  * Queue a FunctionUpload.
+		  */
+		void push (size_t bytes, const std::function <void ()> &upload,
+		           std::shared_future <void> prepared = std::shared_future <void> ());
+
+		/**
+		  * Run jobs in order until the frame's budget is spent; jobs whose
+		  * data is not prepared yet are passed over.  A job whose data failed
+		  * to prepare, or which fails to upload, is reported and dropped.
+		  * Call once per frame with the context current.
+		  * @return Bytes uploaded.
+		  */
+		size_t process (void);
+
+		/**
+		  * Cancel and delete every job.  The context must be current.
+		  */
+		void clear (void);
+
+		bool isEmpty (void) const { return m_jobs.empty (); }
+		size_t getPendingCount (void) const { return m_jobs.size (); }
+
+	private:
+
+		UploadQueue (const UploadQueue &);
+		UploadQueue &operator= (const UploadQueue &);
+
+		std::deque <UploadJob *> m_jobs;
+		size_t 					 m_budget;
+};
+
+}
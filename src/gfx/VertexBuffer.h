@@ -1,18 +1,21 @@
 /*
    Filename : VertexBuffer.h
    Author   : Cody White and Joe Mahsman
-   Version  : 1.0
+   Version  : 1.1
 
    Change List:
 
       - 06/18/2009  - Created (Cody White and Joe Mahsman)
+	  - 10/18/2026  - Added usage modes, partial updates and streaming.
 */
 
 #pragma once
 
 #include <GL/glew.h>
 #include <ContextBuffer.h>
+#include <algorithm>
 #include <iostream>
+#include <string.h>
 
 namespace gfx
 {
@@ -23,25 +26,40 @@ namespace gfx
 class VertexBuffer
 {
 	public:
-		
-		/** 
+
+		/**
+		 * How the contents of the buffer change.
+		 */
+		enum Usage
+		{
+			STATIC,		// Loaded once and drawn many times.
+			DYNAMIC,	// Reloaded or updated every so often; reloading orphans the old storage.
+			STREAM		// Written every frame through stream (), as a ring.
+		};
+
+		/**
 		 * Default constructor.
 		 * @param target Type of VBO to use.
+		 * @param usage How the contents change.  Only STATIC buffers are shared
+		 *        between the contexts of a share group; the others usually
+		 *        hold per-frame data of each context.
 		 */
-		VertexBuffer (GLenum target = GL_ARRAY_BUFFER)
+		VertexBuffer (GLenum target = GL_ARRAY_BUFFER, Usage usage = STATIC)
+			: m_buffers (usage == STATIC)
 		{
 			m_target = target;
+			m_usage = usage;
 		}
 
-		/** 
+		/**
 		 * Default destructor.
 		 */
 		~VertexBuffer ()
 		{
-			gfx::ContextBuffer<GLuint>::ContextBufferIterator iter;
-			for (iter = m_ids.begin (); iter != m_ids.end (); ++iter)
+			gfx::ContextBuffer<Buffer>::ContextBufferIterator iter;
+			for (iter = m_buffers.begin (); iter != m_buffers.end (); ++iter)
 			{
-				glDeleteBuffers (1, &(iter->second));
+				release (iter->second);
 			}
 		}
 
@@ -51,47 +69,217 @@ class VertexBuffer
 		  */
 		void destroyContext (int context_id)
 		{
-			glDeleteBuffers (1, &m_ids[context_id]);
-			m_ids.remove (context_id);
+			// Contexts sharing the buffer may still be using it.
+			if (m_buffers.isLastUser (context_id))
+			{
+				release (m_buffers[context_id]);
+				m_buffers.remove (context_id);
+			}
 		}
 
 		/**
-		 * Assignment operator.
-		 * @param other The vertex buffer to set this object equal to.
+		 * Move constructor.  The buffer objects, fences and mappings now
+		 * belong to this object; other is left empty.
 		 */
-		VertexBuffer & operator= (const VertexBuffer &other)
+		VertexBuffer (VertexBuffer &&other)
+			: m_buffers (other.m_buffers)
+		{
+			m_target = other.m_target;
+			m_usage = other.m_usage;
+			other.m_buffers = gfx::ContextBuffer<Buffer> (other.m_usage == STATIC);
+		}
+
+		/**
+		 * Move assignment.  Releases the buffers this object held.
+		 */
+		VertexBuffer & operator= (VertexBuffer &&other)
 		{
 			if (this != &other)
 			{
-				gfx::ContextBuffer<GLuint>::ConstContextBufferIterator iter;
-				for (iter = other.m_ids.begin (); iter != other.m_ids.end (); ++iter)
+				gfx::ContextBuffer<Buffer>::ContextBufferIterator iter;
+				for (iter = m_buffers.begin (); iter != m_buffers.end (); ++iter)
 				{
-					m_ids[iter->first] = iter->second;
+					release (iter->second);
 				}
 
+				m_buffers = other.m_buffers;
 				m_target = other.m_target;
+				m_usage = other.m_usage;
+				other.m_buffers = gfx::ContextBuffer<Buffer> (other.m_usage == STATIC);
 			}
 
 			return *this;
 		}
 
 		/**
-		 * Generate the VBO id and load the data.
-		 * @param data The data to populate the VBO with.
+		 * Load the data, generating the VBO the first time.  Loading again
+		 * replaces the contents, and lets the driver orphan the old storage
+		 * instead of waiting for draws still reading it.  Not for STREAM
+		 * buffers.
+		 * @param data The data to populate the VBO with, or NULL to only
+		 *        allocate it.
+		 * @param size Size in bytes of the data.
+		 */
+		void load (const void *data, GLsizeiptr size, int context_id = 0)
+		{
+			if (m_usage == STREAM)
+			{
+				std::cout << "VertexBuffer::load () - Error: Stream buffers are written with stream ()." << std::endl;
+				return;
+			}
+
+			Buffer &buffer = m_buffers[context_id];
+			if (buffer.id == 0)
+			{
+				glGenBuffers (1, &buffer.id);
+				if (buffer.id == 0)
+				{
+					std::cout << "VertexBuffer::load () - Error: Unable to generate VBO!" << std::endl;
+					return;
+				}
+			}
+
+			glBindBuffer (m_target, buffer.id);
+			glBufferData (m_target, size, data, m_usage == STATIC ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW);
+			buffer.size = size;
+		}
+
+		/**
+		 * Replace part of the contents, the rest being kept.  Not for STREAM
+		 * buffers.
+		 * @param offset Offset in bytes of the part to replace.
+		 * @param data The new data.
+		 * @param size Size in bytes of the data.
+		 */
+		void update (GLintptr offset, const void *data, GLsizeiptr size, int context_id = 0)
+		{
+			Buffer &buffer = m_buffers[context_id];
+			if (m_usage == STREAM || buffer.id == 0 || offset < 0 || offset + size > buffer.size)
+			{
+				std::cout << "VertexBuffer::update () - Error: Range outside of the loaded buffer." << std::endl;
+				return;
+			}
+
+			glBindBuffer (m_target, buffer.id);
+			glBufferSubData (m_target, offset, size, data);
+		}
+
+		/**
+		 * Allocate the ring of a STREAM buffer.  Optional: stream () grows the
+		 * ring as needed, but every growth reallocates it.
+		 * @param size Size in bytes of the ring; half of it can be written
+		 *        while the GPU reads the other half.
+		 */
+		void reserve (GLsizeiptr size, int context_id = 0)
+		{
+			Buffer &buffer = m_buffers[context_id];
+			release (buffer);
+			buffer = Buffer ();
+			buffer.size = (std::max (size, (GLsizeiptr)(2 * ALIGNMENT)) + 2 * ALIGNMENT - 1) & ~(GLsizeiptr)(2 * ALIGNMENT - 1);
+
+			glGenBuffers (1, &buffer.id);
+			if (buffer.id == 0)
+			{
+				std::cout << "VertexBuffer::reserve () - Error: Unable to generate VBO!" << std::endl;
+				return;
+			}
+			glBindBuffer (m_target, buffer.id);
+
+			if (GLEW_ARB_buffer_storage && GLEW_ARB_sync)
+			{
+				// Mapped once for the buffer's lifetime; fences keep the CPU
+				// from overwriting a half the GPU has yet to read.
+				const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+				glBufferStorage (m_target, buffer.size, NULL, flags);
+				buffer.mapped = (char *)glMapBufferRange (m_target, 0, buffer.size, flags);
+			}
+
+			if (!buffer.mapped)
+			{
+				glBufferData (m_target, buffer.size, NULL, GL_STREAM_DRAW);
+			}
+		}
+
+		/**
+		 * Append data to the ring of a STREAM buffer without waiting on the
+		 * GPU.  Draw from the returned offset after binding the buffer.  Each
+		 * write must be drawn before the writes following it fill the other
+		 * half of the ring.
+		 * @param data The data to append.
 		 * @param size Size in bytes of the data.
+		 * @return Offset of the data in the buffer, or -1 on error.
 		 */
-		void load (void *data, int size, int context_id = 0)
+		GLintptr stream (const void *data, GLsizeiptr size, int context_id = 0)
 		{
-			GLuint& id = m_ids[context_id];
-			glGenBuffers (1, &id);
-			
-			if (id == 0)
+			if (m_usage != STREAM)
+			{
+				std::cout << "VertexBuffer::stream () - Error: Not a stream buffer." << std::endl;
+				return -1;
+			}
+
+			const GLsizeiptr aligned = (size + ALIGNMENT - 1) & ~(GLsizeiptr)(ALIGNMENT - 1);
+			Buffer &buffer = m_buffers[context_id];
+			if (buffer.id == 0 || aligned > buffer.size / 2)
+			{
+				reserve (std::max (2 * buffer.size, 2 * aligned), context_id);
+				if (buffer.id == 0)
+				{
+					return -1;
+				}
+			}
+
+			// Move to the other half when the data does not fit in this one.
+			const GLsizeiptr half = buffer.size / 2;
+			if (buffer.head + aligned > (buffer.half + 1) * half)
 			{
-				std::cout << "VertexBuffer::load () - Error: Unable to generate VBO!" << std::endl;
+				if (buffer.mapped)
+				{
+					// The draws issued so far are the last to read this half.
+					buffer.fences[buffer.half] = glFenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+				}
+
+				buffer.half = 1 - buffer.half;
+				buffer.head = buffer.half * half;
+
+				if (buffer.mapped && buffer.fences[buffer.half])
+				{
+					waitFence (buffer.fences[buffer.half]);
+					buffer.fences[buffer.half] = 0;
+				}
+				else if (!buffer.mapped && buffer.half == 0)
+				{
+					// Back at the start: orphan the storage rather than wait
+					// for the draws reading it.
+					glBindBuffer (m_target, buffer.id);
+					glBufferData (m_target, buffer.size, NULL, GL_STREAM_DRAW);
+				}
+			}
+
+			const GLintptr offset = buffer.head;
+			buffer.head += aligned;
+			if (buffer.mapped)
+			{
+				memcpy (buffer.mapped + offset, data, size);
+				return offset;
 			}
 
-			glBindBuffer (m_target, id);
-			glBufferData (m_target, size, data, GL_STATIC_DRAW);
+			// Nothing has been written to this range since the storage was
+			// orphaned, so there is nothing to synchronize with.
+			glBindBuffer (m_target, buffer.id);
+			void *mapped = glMapBufferRange (m_target, offset, size,
+			                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+			if (mapped)
+			{
+				memcpy (mapped, data, size);
+				if (glUnmapBuffer (m_target))
+				{
+					return offset;
+				}
+			}
+
+			// Mapping failed or the contents were lost while mapped.
+			glBufferSubData (m_target, offset, size, data);
+			return offset;
 		}
 
 		/**
@@ -100,7 +288,7 @@ class VertexBuffer
 		 */
 		void bind (int context_id = 0) const
 		{
-			glBindBuffer (m_target, m_ids[context_id]);
+			glBindBuffer (m_target, m_buffers[context_id].id);
 		}
 
 		/**
@@ -111,19 +299,100 @@ class VertexBuffer
 			glBindBuffer (m_target, 0);
 		}
 
-		/** 
-		 * Return the VBO id assigned by OpenGL. 
+		/**
+		 * Returns whether the VBO has been loaded for a context, or for a
+		 * context sharing objects with it.
+		 */
+		bool valid (int context_id = 0) const
+		{
+			return m_buffers.contains (context_id) && m_buffers[context_id].id != 0;
+		}
+
+		/**
+		 * Return the VBO id assigned by OpenGL.
 		 */
 		GLuint id (int context_id = 0) const
 		{
-			return m_ids[context_id];
+			return m_buffers[context_id].id;
 		}
 
+		/**
+		 * Return the size in bytes of the buffer on a context.
+		 */
+		GLsizeiptr size (int context_id = 0) const
+		{
+			return m_buffers[context_id].size;
+		}
+
+		Usage usage (void) const { return m_usage; }
+
 	private:
 
-		gfx::ContextBuffer <GLuint> m_ids;
+		// Copies would delete the same buffer objects and fences twice.
+		VertexBuffer (const VertexBuffer &);
+		VertexBuffer &operator= (const VertexBuffer &);
+
+		// Alignment of the data appended by stream ().
+		static const GLsizeiptr ALIGNMENT = 16;
+
+		/**
+		 * The buffer object of one context.
+		 */
+		struct Buffer
+		{
+			Buffer (void) : id (0), size (0), head (0), half (0), mapped (NULL)
+			{
+				fences[0] = fences[1] = 0;
+			}
+
+			GLuint id;
+			GLsizeiptr size;		// Bytes allocated.
+			GLintptr head;			// Next byte stream () writes.
+			int half;				// Half of the ring head is in.
+			char *mapped;			// Persistent mapping of a stream ring, if supported.
+			GLsync fences[2];		// Draws reading each half of a persistent ring.
+		};
+
+		/**
+		 * Delete the buffer object and fences of a context.
+		 */
+		static void release (Buffer &buffer)
+		{
+			for (int i = 0; i < 2; ++i)
+			{
+				if (buffer.fences[i])
+				{
+					glDeleteSync (buffer.fences[i]);
+					buffer.fences[i] = 0;
+				}
+			}
+
+			// Deleting the buffer also unmaps it.
+			if (buffer.id)
+			{
+				glDeleteBuffers (1, &buffer.id);
+				buffer.id = 0;
+			}
+			buffer.mapped = NULL;
+		}
+
+		/**
+		 * Block until the GPU is past a fence, then delete it.
+		 */
+		static void waitFence (GLsync fence)
+		{
+			GLenum result;
+			do
+			{
+				result = glClientWaitSync (fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+			}
+			while (result == GL_TIMEOUT_EXPIRED);
+			glDeleteSync (fence);
+		}
+
+		gfx::ContextBuffer <Buffer> m_buffers;
 		GLenum m_target;
+		Usage m_usage;
 };
 
 }
-
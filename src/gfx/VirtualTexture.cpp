@@ -0,0 +1,839 @@
+/*
+   Filename : VirtualTexture.cpp
+   Version  : 1.0
+
+   Purpose  : Streams the tiles of images too large for the GPU through a
+              cache texture of fixed size.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <VirtualTexture.h>
+#include <Texture.h>
+#include <FreeImage.h>
+#include <util.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <math.h>
+#include <sstream>
+#include <stdexcept>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace gfx
+{
+
+const uint64_t VirtualTexture::NO_TILE;
+
+namespace
+{
+
+/**
+  * Start of a tile file, followed by the tiles of each level, largest level
+  * first, each level's bottom row of tiles first and each tile its bottom
+  * row first, as tightly packed BGRA.
+  */
+struct TileFileHeader
+{
+	char magic[8];
+	uint32_t width, height;
+	uint32_t tile_size, border;
+	uint32_t levels, reserved;
+};
+
+const char tile_file_magic[8] = { 'T', 'E', 'X', 'T', 'I', 'L', '0', '1' };
+
+// Clip space w below which a vertex counts as behind the eye.
+const float min_w = 1.0e-5f;
+
+/**
+  * Samples the image through the indirection texture: each texel of a level
+  * of it holds the slot of the cache and the level of the tile standing in
+  * for that tile.
+  */
+const char *fragment_source =
+	"#version 130\n"
+	"uniform sampler2D cache;\n"
+	"uniform sampler2D indirection;\n"
+	"uniform vec2 size;\n"
+	"uniform vec2 cache_size;\n"
+	"uniform float tile_size;\n"
+	"uniform float border;\n"
+	"uniform float last_level;\n"
+	"void main ()\n"
+	"{\n"
+	"	vec2 uv = clamp (gl_TexCoord[0].st, 0.0, 1.0);\n"
+	"\n"
+	"	// The level whose texels are about a pixel apart.\n"
+	"	vec2 dx = dFdx (gl_TexCoord[0].st * size);\n"
+	"	vec2 dy = dFdy (gl_TexCoord[0].st * size);\n"
+	"	float level = clamp (floor (0.5 * log2 (max (max (dot (dx, dx), dot (dy, dy)), 1.0e-8))), 0.0, last_level);\n"
+	"	vec2 level_size = max (floor (size / exp2 (level)), vec2 (1.0));\n"
+	"	ivec2 tile = ivec2 (min (uv * level_size, level_size - 0.5) / tile_size);\n"
+	"\n"
+	"	// The tile in the cache, or the coarser one standing in for it.\n"
+	"	vec4 entry = floor (texelFetch (indirection, tile, int (level)) * 255.0 + 0.5);\n"
+	"	vec2 resident_size = max (floor (size / exp2 (entry.z)), vec2 (1.0));\n"
+	"	ivec2 resident_tiles = ivec2 (ceil (resident_size / tile_size));\n"
+	"	ivec2 resident_tile = min (tile >> (int (entry.z) - int (level)), resident_tiles - 1);\n"
+	"	vec2 local = clamp (uv * resident_size - vec2 (resident_tile) * tile_size, 0.5 - border, tile_size + border - 0.5);\n"
+	"	vec2 texel = entry.xy * (tile_size + 2.0 * border) + border + local;\n"
+	"	gl_FragColor = textureLod (cache, texel / cache_size, 0.0) * gl_Color;\n"
+	"}\n";
+
+/**
+  * Transform p by the OpenGL layout matrix m (m * p in OpenGL terms).
+  */
+inline math::vec4f toClip (const float *m, const math::vec3f &p)
+{
+	return math::vec4f (m[0] * p[0] + m[4] * p[1] + m[8]  * p[2] + m[12],
+	                    m[1] * p[0] + m[5] * p[1] + m[9]  * p[2] + m[13],
+	                    m[2] * p[0] + m[6] * p[1] + m[10] * p[2] + m[14],
+	                    m[3] * p[0] + m[7] * p[1] + m[11] * p[2] + m[15]);
+}
+
+/**
+  * Number of levels of an image cut into tiles: down to the level that fits
+  * in one.
+  */
+int countLevels (GLsizei width, GLsizei height, int tile_size)
+{
+	int levels = 1;
+	while (std::max (width >> (levels - 1), 1) > tile_size || std::max (height >> (levels - 1), 1) > tile_size)
+	{
+		++levels;
+	}
+	return levels;
+}
+
+/**
+  * Copy the tile at (x, y) of a level and its border into bits, repeating
+  * the edge texels of the level past its edges.
+  */
+void cutTile (const unsigned char *level, GLsizei width, GLsizei height, size_t pitch,
+              int x, int y, int tile_size, int border, unsigned char *bits)
+{
+	const int size = tile_size + 2 * border;
+	const int left = x * tile_size - border;
+	const int first = std::min (std::max (-left, 0), size);
+	const int last = std::max (std::min ((int)width - left, size), first);
+	for (int row = 0; row < size; ++row)
+	{
+		const int source_row = std::min (std::max (y * tile_size - border + row, 0), (int)height - 1);
+		const unsigned char *source = level + source_row * pitch;
+		unsigned char *target = bits + (size_t)row * size * 4;
+		for (int i = 0; i < first; ++i)
+		{
+			memcpy (target + i * 4, source, 4);
+		}
+		memcpy (target + first * 4, source + (left + first) * 4, (size_t)(last - first) * 4);
+		for (int i = last; i < size; ++i)
+		{
+			memcpy (target + i * 4, source + (width - 1) * 4, 4);
+		}
+	}
+}
+
+}
+
+void VirtualTexture::build (const std::string &image, const std::string &tiles,
+                            int tile_size, int border, mipmap::Filter filter, bool srgb)
+{
+	FREE_IMAGE_FORMAT format = FreeImage_GetFileType (image.c_str (), 0);
+	FIBITMAP *unconverted = FreeImage_Load (format, image.c_str ());
+	if (unconverted == NULL)
+	{
+		std::stringstream error;
+		error << "VirtualTexture::build (): Unable to load \"" << image << "\".\n";
+		throw std::runtime_error (error.str ());
+	}
+	FIBITMAP *data = FreeImage_ConvertTo32Bits (unconverted);
+	FreeImage_Unload (unconverted);
+
+	TileFileHeader header;
+	memcpy (header.magic, tile_file_magic, sizeof (header.magic));
+	header.width = FreeImage_GetWidth (data);
+	header.height = FreeImage_GetHeight (data);
+	header.tile_size = tile_size;
+	header.border = border;
+	header.levels = countLevels (header.width, header.height, tile_size);
+	header.reserved = 0;
+
+	// Write to a name of our own and rename it into place, so that a load
+	// never opens a file still being written.
+	std::stringstream temporary;
+	temporary << tiles << "." << getpid () << ".tmp";
+	FILE *file = fopen (temporary.str ().c_str (), "wb");
+	bool written = file && fwrite (&header, sizeof (header), 1, file) == 1;
+
+	// Only a level and the next are in memory at a time.
+	const unsigned char *bits = FreeImage_GetBits (data);
+	size_t pitch = FreeImage_GetPitch (data);
+	GLsizei width = header.width, height = header.height;
+	std::vector <unsigned char> level, next;
+	std::vector <unsigned char> tile ((size_t)(tile_size + 2 * border) * (tile_size + 2 * border) * 4);
+	for (uint32_t i = 0; i < header.levels && written; ++i)
+	{
+		if (i > 0)
+		{
+			GLsizei next_width = std::max (width / 2, 1);
+			GLsizei next_height = std::max (height / 2, 1);
+			next.resize ((size_t)next_width * next_height * 4);
+			mipmap::resample (bits, width, height, pitch, &next[0], next_width, next_height, filter, srgb);
+			level.swap (next);
+			bits = &level[0];
+			pitch = next_width * 4;
+			width = next_width;
+			height = next_height;
+			if (data)
+			{
+				FreeImage_Unload (data);
+				data = NULL;
+			}
+		}
+
+		const int tiles_x = (width + tile_size - 1) / tile_size;
+		const int tiles_y = (height + tile_size - 1) / tile_size;
+		for (int y = 0; y < tiles_y && written; ++y)
+		{
+			for (int x = 0; x < tiles_x && written; ++x)
+			{
+				cutTile (bits, width, height, pitch, x, y, tile_size, border, &tile[0]);
+				written = fwrite (&tile[0], tile.size (), 1, file) == 1;
+			}
+		}
+	}
+	if (data)
+	{
+		FreeImage_Unload (data);
+	}
+
+	written = file && fclose (file) == 0 && written;
+	if (!written || rename (temporary.str ().c_str (), tiles.c_str ()) != 0)
+	{
+		remove (temporary.str ().c_str ());
+		std::stringstream error;
+		error << "VirtualTexture::build (): Unable to write \"" << tiles << "\".\n";
+		throw std::runtime_error (error.str ());
+	}
+}
+
+std::string VirtualTexture::getTileFileName (const std::string &image)
+{
+	std::string name = image;
+	const std::string &directory = Texture::getCacheDirectory ();
+	if (!directory.empty ())
+	{
+		std::replace (name.begin (), name.end (), '/', '_');
+		name = directory + "/" + name;
+	}
+	return name + ".tiles";
+}
+
+VirtualTexture::VirtualTexture (int cache_tiles)
+	: m_file (-1),
+	  m_width (0),
+	  m_height (0),
+	  m_tile_size (0),
+	  m_border (0),
+	  m_indirection_width (0),
+	  m_indirection_height (0),
+	  m_generation (0),
+	  m_stop (false),
+	  m_frame (1),
+	  m_cache_tiles (cache_tiles),
+	  m_contexts (true)
+{
+	m_shader.setSource (fragment_source);
+}
+
+VirtualTexture::~VirtualTexture (void)
+{
+	close ();
+}
+
+void VirtualTexture::load (const std::string &image)
+{
+	std::string tiles = getTileFileName (image);
+	struct stat source, built;
+	if (stat (tiles.c_str (), &built) != 0 || (stat (image.c_str (), &source) == 0 && built.st_mtime < source.st_mtime))
+	{
+		build (image, tiles);
+	}
+	open (tiles);
+}
+
+void VirtualTexture::open (const std::string &tiles)
+{
+	close ();
+
+	int file = ::open (tiles.c_str (), O_RDONLY);
+	TileFileHeader header;
+	struct stat info;
+	bool valid = file >= 0 && pread (file, &header, sizeof (header), 0) == (ssize_t)sizeof (header) &&
+	             fstat (file, &info) == 0 && memcmp (header.magic, tile_file_magic, sizeof (header.magic)) == 0 &&
+	             header.width > 0 && header.height > 0 && header.tile_size > 0 &&
+	             (int)header.levels == countLevels (header.width, header.height, header.tile_size);
+
+	// Every tile must be there.
+	std::vector <Level> levels;
+	uint64_t count = 0;
+	for (uint32_t i = 0; valid && i < header.levels; ++i)
+	{
+		Level level;
+		level.width = std::max ((GLsizei)header.width >> i, 1);
+		level.height = std::max ((GLsizei)header.height >> i, 1);
+		level.tiles_x = (level.width + header.tile_size - 1) / header.tile_size;
+		level.tiles_y = (level.height + header.tile_size - 1) / header.tile_size;
+		level.first = count;
+		count += (uint64_t)level.tiles_x * level.tiles_y;
+		levels.push_back (level);
+	}
+	const uint64_t tile_bytes = (uint64_t)(header.tile_size + 2 * header.border) * (header.tile_size + 2 * header.border) * 4;
+	if (!valid || (uint64_t)info.st_size < sizeof (header) + count * tile_bytes)
+	{
+		if (file >= 0)
+		{
+			::close (file);
+		}
+		std::stringstream error;
+		error << "VirtualTexture::open (): \"" << tiles << "\" is not a tile file.\n";
+		throw std::runtime_error (error.str ());
+	}
+
+	m_file = file;
+	m_width = header.width;
+	m_height = header.height;
+	m_tile_size = header.tile_size;
+	m_border = header.border;
+	m_levels.swap (levels);
+	m_indirection_width = 1;
+	while (m_indirection_width < m_levels[0].tiles_x)
+	{
+		m_indirection_width *= 2;
+	}
+	m_indirection_height = 1;
+	while (m_indirection_height < m_levels[0].tiles_y)
+	{
+		m_indirection_height *= 2;
+	}
+	++m_generation;
+
+	// The coarsest tile stays in slot 0, so that every tile has something
+	// to stand in for it.
+	m_slots.assign ((size_t)m_cache_tiles * m_cache_tiles, Slot ());
+	m_wanted.clear ();
+	m_resident.clear ();
+	const uint64_t coarsest = tileKey ((int)m_levels.size () - 1, 0, 0);
+	m_slots[0].bits.resize (tile_bytes);
+	if (!readTile (coarsest, &m_slots[0].bits[0]))
+	{
+		close ();
+		std::stringstream error;
+		error << "VirtualTexture::open (): Unable to read \"" << tiles << "\".\n";
+		throw std::runtime_error (error.str ());
+	}
+	m_slots[0].tile = coarsest;
+	m_slots[0].version = 1;
+	m_resident[coarsest] = 0;
+
+	m_stop = false;
+	m_thread = std::thread (&VirtualTexture::stream, this);
+}
+
+void VirtualTexture::close (void)
+{
+	if (m_thread.joinable ())
+	{
+		{
+			std::lock_guard <std::mutex> lock (m_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_all ();
+		m_thread.join ();
+	}
+	if (m_file >= 0)
+	{
+		::close (m_file);
+		m_file = -1;
+	}
+}
+
+bool VirtualTexture::readTile (uint64_t tile, unsigned char *bits) const
+{
+	const Level &level = m_levels[tileLevel (tile)];
+	const size_t size = (size_t)getPhysicalSize () * getPhysicalSize () * 4;
+	off_t offset = sizeof (TileFileHeader) + (off_t)(level.first + (uint64_t)tileY (tile) * level.tiles_x + tileX (tile)) * size;
+	size_t done = 0;
+	while (done < size)
+	{
+		ssize_t result = pread (m_file, bits + done, size - done, offset + done);
+		if (result <= 0)
+		{
+			return false;
+		}
+		done += result;
+	}
+	return true;
+}
+
+void VirtualTexture::stream (void)
+{
+	std::vector <unsigned char> bits ((size_t)getPhysicalSize () * getPhysicalSize () * 4);
+	std::unique_lock <std::mutex> lock (m_mutex);
+	while (!m_stop)
+	{
+		uint64_t tile;
+		if (!nextTile (tile))
+		{
+			m_wake.wait (lock);
+			continue;
+		}
+
+		// Read without the mutex, so that requests are not held up by the
+		// disk.
+		lock.unlock ();
+		bool read = readTile (tile, &bits[0]);
+		lock.lock ();
+		if (!read)
+		{
+			m_wanted.erase (tile);
+			continue;
+		}
+
+		// The view may have moved on meanwhile.
+		int slot = findSlot ();
+		if (slot < 0 || m_resident.count (tile))
+		{
+			continue;
+		}
+		Slot &target = m_slots[slot];
+		if (target.tile != NO_TILE)
+		{
+			m_resident.erase (target.tile);
+		}
+		target.tile = tile;
+		target.bits.swap (bits);
+		bits.resize (target.bits.size ());
+		target.last_used = m_frame;
+		++target.version;
+		m_resident[tile] = slot;
+	}
+}
+
+int VirtualTexture::findSlot (void) const
+{
+	// An empty slot, or the one whose tile went out of view first.  Tiles
+	// asked for this frame or the last stay.
+	int best = -1;
+	for (size_t i = 1; i < m_slots.size (); ++i)
+	{
+		const Slot &slot = m_slots[i];
+		if (slot.tile == NO_TILE)
+		{
+			return (int)i;
+		}
+		if (slot.last_used + 1 >= m_frame)
+		{
+			continue;
+		}
+		if (best < 0 || slot.last_used < m_slots[best].last_used)
+		{
+			best = (int)i;
+		}
+	}
+	return best;
+}
+
+bool VirtualTexture::nextTile (uint64_t &tile) const
+{
+	if (findSlot () < 0)
+	{
+		return false;
+	}
+
+	// Keys sort coarsest last: reading those first fills the view quickly,
+	// if blurred.
+	std::map <uint64_t, uint64_t>::const_reverse_iterator iter;
+	for (iter = m_wanted.rbegin (); iter != m_wanted.rend (); ++iter)
+	{
+		if (iter->second + 1 >= m_frame && !m_resident.count (iter->first))
+		{
+			tile = iter->first;
+			return true;
+		}
+	}
+	return false;
+}
+
+void VirtualTexture::request (const math::vec2f &min, const math::vec2f &max, int level)
+{
+	if (m_levels.empty ())
+	{
+		return;
+	}
+
+	const int last = (int)m_levels.size () - 1;
+	level = std::min (std::max (level, 0), last);
+	const float u0 = std::min (std::max (std::min (min[0], max[0]), 0.0f), 1.0f);
+	const float u1 = std::min (std::max (std::max (min[0], max[0]), 0.0f), 1.0f);
+	const float v0 = std::min (std::max (std::min (min[1], max[1]), 0.0f), 1.0f);
+	const float v1 = std::min (std::max (std::max (min[1], max[1]), 0.0f), 1.0f);
+
+	// No one region may take more than a quarter of the cache.
+	const int budget = std::max ((int)m_slots.size () / 4, 1);
+
+	std::lock_guard <std::mutex> lock (m_mutex);
+	bool wake = false;
+	for (int i = level; i <= last; ++i)
+	{
+		const Level &info = m_levels[i];
+		const int x0 = std::min ((int)(u0 * info.width), info.width - 1) / m_tile_size;
+		const int x1 = std::min ((int)(u1 * info.width), info.width - 1) / m_tile_size;
+		const int y0 = std::min ((int)(v0 * info.height), info.height - 1) / m_tile_size;
+		const int y1 = std::min ((int)(v1 * info.height), info.height - 1) / m_tile_size;
+		if (i < last && (x1 - x0 + 1) * (y1 - y0 + 1) > budget)
+		{
+			continue;
+		}
+
+		for (int y = y0; y <= y1; ++y)
+		{
+			for (int x = x0; x <= x1; ++x)
+			{
+				const uint64_t tile = tileKey (i, x, y);
+				m_wanted[tile] = m_frame;
+				std::map <uint64_t, int>::const_iterator resident = m_resident.find (tile);
+				if (resident != m_resident.end ())
+				{
+					m_slots[resident->second].last_used = m_frame;
+				}
+				else
+				{
+					wake = true;
+				}
+			}
+		}
+	}
+
+	if (wake)
+	{
+		m_wake.notify_one ();
+	}
+}
+
+void VirtualTexture::request (const math::vec3f vertices[3], const math::vec2f coords[3],
+                              const math::Matrixf &view_projection, const math::vec2f &viewport)
+{
+	if (m_levels.empty ())
+	{
+		return;
+	}
+
+	const float *m = view_projection.data ();
+	math::vec2f screen[3];
+	bool behind = false;
+	int outside[6] = { 0, 0, 0, 0, 0, 0 };
+	for (int i = 0; i < 3; ++i)
+	{
+		math::vec4f clip = toClip (m, vertices[i]);
+		for (int j = 0; j < 3; ++j)
+		{
+			outside[j * 2] += clip[j] < -clip[3];
+			outside[j * 2 + 1] += clip[j] > clip[3];
+		}
+		if (clip[3] < min_w)
+		{
+			behind = true;
+			continue;
+		}
+		screen[i] = math::vec2f ((clip[0] / clip[3] * 0.5f + 0.5f) * viewport[0],
+		                         (clip[1] / clip[3] * 0.5f + 0.5f) * viewport[1]);
+	}
+	for (int j = 0; j < 6; ++j)
+	{
+		if (outside[j] == 3)
+		{
+			return;
+		}
+	}
+
+	// Texels of level 0 per pixel, from the areas the triangle covers in
+	// each.  One reaching behind the eye is close enough to want level 0.
+	int level = 0;
+	if (!behind)
+	{
+		const float pixels = fabsf ((screen[1][0] - screen[0][0]) * (screen[2][1] - screen[0][1]) -
+		                            (screen[2][0] - screen[0][0]) * (screen[1][1] - screen[0][1]));
+		const float texels = fabsf ((coords[1][0] - coords[0][0]) * (coords[2][1] - coords[0][1]) -
+		                            (coords[2][0] - coords[0][0]) * (coords[1][1] - coords[0][1])) * m_width * m_height;
+		if (pixels > 0.0f && texels > 0.0f)
+		{
+			level = std::max ((int)floorf (0.5f * log2f (texels / pixels)), 0);
+		}
+		else if (texels > 0.0f)
+		{
+			// Seen edge on.
+			level = (int)m_levels.size () - 1;
+		}
+	}
+
+	math::vec2f min (std::min (std::min (coords[0][0], coords[1][0]), coords[2][0]),
+	                 std::min (std::min (coords[0][1], coords[1][1]), coords[2][1]));
+	math::vec2f max (std::max (std::max (coords[0][0], coords[1][0]), coords[2][0]),
+	                 std::max (std::max (coords[0][1], coords[1][1]), coords[2][1]));
+	request (min, max, level);
+}
+
+void VirtualTexture::nextFrame (void)
+{
+	{
+		std::lock_guard <std::mutex> lock (m_mutex);
+		++m_frame;
+
+		// Tiles out of view for a frame are not read any more.
+		std::map <uint64_t, uint64_t>::iterator iter = m_wanted.begin ();
+		while (iter != m_wanted.end ())
+		{
+			if (iter->second + 1 < m_frame)
+			{
+				m_wanted.erase (iter++);
+			}
+			else
+			{
+				++iter;
+			}
+		}
+	}
+	m_wake.notify_one ();
+}
+
+void VirtualTexture::update (int context_id, int max_tiles)
+{
+	if (m_levels.empty ())
+	{
+		return;
+	}
+
+	// Contexts of a share group update the same textures.
+	std::lock_guard <std::mutex> update_lock (m_update_mutex);
+	ContextState &state = m_contexts[context_id];
+	const int size = getPhysicalSize ();
+	if (state.cache == 0 || state.generation != m_generation)
+	{
+		if (state.cache != 0)
+		{
+			glDeleteTextures (1, &state.cache);
+			glDeleteTextures (1, &state.indirection);
+		}
+
+		glGenTextures (1, &state.cache);
+		glBindTexture (GL_TEXTURE_2D, state.cache);
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+		glTexImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, m_cache_tiles * size, m_cache_tiles * size, 0, GL_BGRA, GL_UNSIGNED_BYTE, NULL);
+
+		glGenTextures (1, &state.indirection);
+		glBindTexture (GL_TEXTURE_2D, state.indirection);
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)m_levels.size () - 1);
+		for (size_t i = 0; i < m_levels.size (); ++i)
+		{
+			glTexImage2D (GL_TEXTURE_2D, i, GL_RGBA8, std::max (m_indirection_width >> i, 1), std::max (m_indirection_height >> i, 1),
+			              0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		}
+		glBindTexture (GL_TEXTURE_2D, 0);
+		checkGLErrors ("VirtualTexture::update () - create textures");
+
+		state.tiles.assign (m_slots.size (), NO_TILE);
+		state.versions.assign (m_slots.size (), 0);
+		state.generation = m_generation;
+	}
+
+	// Copy the tiles that arrived, coarsest first, and upload them without
+	// the mutex.
+	const size_t tile_bytes = (size_t)size * size * 4;
+	std::vector <std::pair <int, int> > changed;	// Level (negated, to sort coarsest first) and slot.
+	std::vector <uint64_t> tiles;
+	std::vector <unsigned int> versions;
+	std::vector <unsigned char> staging;
+	{
+		std::lock_guard <std::mutex> lock (m_mutex);
+		for (size_t i = 0; i < m_slots.size (); ++i)
+		{
+			if (m_slots[i].tile != NO_TILE && m_slots[i].version != state.versions[i])
+			{
+				changed.push_back (std::make_pair (-tileLevel (m_slots[i].tile), (int)i));
+			}
+		}
+		std::sort (changed.begin (), changed.end ());
+		changed.resize (std::min (changed.size (), (size_t)std::max (max_tiles, 1)));
+
+		staging.resize (changed.size () * tile_bytes);
+		for (size_t i = 0; i < changed.size (); ++i)
+		{
+			const Slot &slot = m_slots[changed[i].second];
+			memcpy (&staging[i * tile_bytes], &slot.bits[0], tile_bytes);
+			tiles.push_back (slot.tile);
+			versions.push_back (slot.version);
+		}
+	}
+	if (changed.empty ())
+	{
+		return;
+	}
+
+	glBindTexture (GL_TEXTURE_2D, state.cache);
+	for (size_t i = 0; i < changed.size (); ++i)
+	{
+		const int slot = changed[i].second;
+		glTexSubImage2D (GL_TEXTURE_2D, 0, (slot % m_cache_tiles) * size, (slot / m_cache_tiles) * size, size, size,
+		                 GL_BGRA, GL_UNSIGNED_BYTE, &staging[i * tile_bytes]);
+		state.tiles[slot] = tiles[i];
+		state.versions[slot] = versions[i];
+	}
+	glBindTexture (GL_TEXTURE_2D, 0);
+	checkGLErrors ("VirtualTexture::update () - upload tiles");
+
+	updateIndirection (state);
+}
+
+void VirtualTexture::updateIndirection (const ContextState &state) const
+{
+	// Each level starts as the level above, each tile pointing where its
+	// parent does, and the tiles of the level that are in the cache then
+	// point at themselves.
+	const int last = (int)m_levels.size () - 1;
+	std::vector <std::vector <unsigned char> > entries (m_levels.size ());
+	for (int i = last; i >= 0; --i)
+	{
+		const Level &level = m_levels[i];
+		const GLsizei width = std::max (m_indirection_width >> i, 1);
+		entries[i].assign ((size_t)width * std::max (m_indirection_height >> i, 1) * 4, 0);
+		if (i == last)
+		{
+			entries[i][2] = (unsigned char)last;
+			entries[i][3] = 255;
+			continue;
+		}
+
+		const Level &parent = m_levels[i + 1];
+		const GLsizei parent_width = std::max (m_indirection_width >> (i + 1), 1);
+		for (int y = 0; y < level.tiles_y; ++y)
+		{
+			const int parent_y = std::min (y >> 1, parent.tiles_y - 1);
+			for (int x = 0; x < level.tiles_x; ++x)
+			{
+				const int parent_x = std::min (x >> 1, parent.tiles_x - 1);
+				memcpy (&entries[i][((size_t)y * width + x) * 4], &entries[i + 1][((size_t)parent_y * parent_width + parent_x) * 4], 4);
+			}
+		}
+
+		for (size_t slot = 0; slot < state.tiles.size (); ++slot)
+		{
+			const uint64_t tile = state.tiles[slot];
+			if (tile != NO_TILE && tileLevel (tile) == i)
+			{
+				unsigned char *entry = &entries[i][((size_t)tileY (tile) * width + tileX (tile)) * 4];
+				entry[0] = (unsigned char)(slot % m_cache_tiles);
+				entry[1] = (unsigned char)(slot / m_cache_tiles);
+				entry[2] = (unsigned char)i;
+				entry[3] = 255;
+			}
+		}
+	}
+
+	glBindTexture (GL_TEXTURE_2D, state.indirection);
+	for (int i = 0; i <= last; ++i)
+	{
+		glTexSubImage2D (GL_TEXTURE_2D, i, 0, 0, std::max (m_indirection_width >> i, 1), std::max (m_indirection_height >> i, 1),
+		                 GL_RGBA, GL_UNSIGNED_BYTE, &entries[i][0]);
+	}
+	glBindTexture (GL_TEXTURE_2D, 0);
+	checkGLErrors ("VirtualTexture::updateIndirection ()");
+}
+
+bool VirtualTexture::isComplete (int context_id) const
+{
+	const ContextState &state = m_contexts[context_id];
+	std::lock_guard <std::mutex> lock (m_mutex);
+	if (state.generation != m_generation)
+	{
+		return false;
+	}
+	for (size_t i = 0; i < m_slots.size (); ++i)
+	{
+		if (m_slots[i].tile != NO_TILE && m_slots[i].version != state.versions[i])
+		{
+			return false;
+		}
+	}
+	uint64_t tile;
+	return !nextTile (tile);
+}
+
+void VirtualTexture::bind (int context_id)
+{
+	const ContextState &state = m_contexts[context_id];
+	if (m_program.id (context_id) == 0)
+	{
+		m_shader.initialize (Shader::FRAGMENT, context_id);
+		m_program.attach (m_shader, context_id);
+		m_program.link (context_id);
+	}
+
+	glActiveTexture (GL_TEXTURE1);
+	glBindTexture (GL_TEXTURE_2D, state.indirection);
+	glActiveTexture (GL_TEXTURE0);
+	glBindTexture (GL_TEXTURE_2D, state.cache);
+
+	m_program.bind (context_id);
+	m_program.set1i ("cache", 0);
+	m_program.set1i ("indirection", 1);
+	const float size[2] = { (float)m_width, (float)m_height };
+	const float cache_size[2] = { (float)(m_cache_tiles * getPhysicalSize ()), (float)(m_cache_tiles * getPhysicalSize ()) };
+	m_program.set2fv ("size", size);
+	m_program.set2fv ("cache_size", cache_size);
+	m_program.set1f ("tile_size", (float)m_tile_size);
+	m_program.set1f ("border", (float)m_border);
+	m_program.set1f ("last_level", (float)(m_levels.size () - 1));
+}
+
+void VirtualTexture::unbind (void) const
+{
+	m_program.unbind ();
+	glActiveTexture (GL_TEXTURE1);
+	glBindTexture (GL_TEXTURE_2D, 0);
+	glActiveTexture (GL_TEXTURE0);
+	glBindTexture (GL_TEXTURE_2D, 0);
+}
+
+void VirtualTexture::destroyContext (int context_id)
+{
+	std::lock_guard <std::mutex> update_lock (m_update_mutex);
+	if (m_contexts.contains (context_id) && m_contexts.isLastUser (context_id))
+	{
+		ContextState &state = m_contexts[context_id];
+		if (state.cache != 0)
+		{
+			glDeleteTextures (1, &state.cache);
+			glDeleteTextures (1, &state.indirection);
+		}
+		m_contexts.remove (context_id);
+	}
+	if (m_program.id (context_id) != 0)
+	{
+		m_shader.destroyContext (context_id);
+		m_program.destroyContext (context_id);
+	}
+}
+
+}
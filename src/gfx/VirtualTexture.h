@@ -0,0 +1,277 @@
+/*
+   Filename : VirtualTexture.h
+   Version  : 1.0
+
+   Purpose  : Streams the tiles of images too large for the GPU through a
+              cache texture of fixed size.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#pragma once
+
+#include <GL/glew.h>
+#include <ContextBuffer.h>
+#include <Matrix.h>
+#include <Mipmap.h>
+#include <Program.h>
+#include <Shader.h>
+#include <Vector.h>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gfx
+{
+
+/**
+  * An image of any size drawn at full detail from a bounded amount of video
+  * memory.  build () cuts the image and its mipmap chain into square tiles
+  * in a file.  A thread reads the tiles the view needs into a cache texture
+  * of cache_tiles x cache_tiles tiles, evicting those least recently
+  * needed.  An indirection texture, one texel per tile and a level per
+  * mipmap level, points each tile at its slot in the cache, or at the
+  * nearest coarser tile there while it is not.
+  *
+  * The coarsest level is a single tile that never leaves the cache, so
+  * something is drawn from the first frame.  Tiles carry a border of the
+  * texels around them so that they filter linearly across their edges;
+  * levels are not blended with one another.
+  *
+  * Each frame: request () the parts of the image in view, draw with the
+  * texture coordinates of unit 0 addressing the image between bind () and
+  * unbind (), then call nextFrame () once.  update () every context before
+  * drawing on it.
+  */
+class VirtualTexture
+{
+	public:
+
+		/**
+		  * Cut an image and its mipmap chain into a tile file.  Throws
+		  * std::runtime_error if the image cannot be read or the file
+		  * written.
+		  * @param tile_size Texels across a tile, borders excluded.
+		  * @param border Texels around each tile, repeated from its
+		  *        neighbours.
+		  */
+		static void build (const std::string &image, const std::string &tiles,
+		                   int tile_size = 120, int border = 4,
+		                   mipmap::Filter filter = mipmap::BOX, bool srgb = true);
+
+		/**
+		  * Returns the path load () keeps the tile file of image at: next to
+		  * it, or in Texture's cache directory.
+		  */
+		static std::string getTileFileName (const std::string &image);
+
+		/**
+		  * @param cache_tiles Tiles across the cache texture.  The tile
+		  *        size of the file sets its texels, 128 per tile by default.
+		  */
+		explicit VirtualTexture (int cache_tiles = 16);
+
+		/**
+		  * Stops the streaming thread.  destroyContext () every context
+		  * first.
+		  */
+		~VirtualTexture (void);
+
+		/**
+		  * Open the tile file of an image, building it first when it is
+		  * missing or older than the image.  Throws std::runtime_error.
+		  */
+		void load (const std::string &image);
+
+		/**
+		  * Open a tile file and start streaming from it.  Throws
+		  * std::runtime_error if it is not one.
+		  */
+		void open (const std::string &tiles);
+
+		/**
+		  * Ask for the tiles covering a region of the image at a mipmap
+		  * level, and the coarser tiles covering it.  Regions too large for
+		  * the cache at that level are asked for at a coarser one.
+		  * @param min Corner of the region, in texture coordinates.
+		  * @param max Opposite corner.
+		  */
+		void request (const math::vec2f &min, const math::vec2f &max, int level);
+
+		/**
+		  * Ask for the tiles a triangle needs, at the level where its texels
+		  * are about a pixel on screen: a CPU estimate of what a feedback
+		  * pass would find, before the triangle is drawn.  Triangles outside
+		  * the view ask for nothing.
+		  * @param vertices Corners of the triangle, in world space.
+		  * @param coords Their texture coordinates.
+		  * @param view_projection Stored product modelview * projection,
+		  *        see Frustum.
+		  * @param viewport Pixels across and down the viewport.
+		  */
+		void request (const math::vec3f vertices[3], const math::vec2f coords[3],
+		              const math::Matrixf &view_projection, const math::vec2f &viewport);
+
+		/**
+		  * End a frame of requests.  Tiles not asked for again during the
+		  * next frame are no longer streamed and may be evicted.
+		  */
+		void nextFrame (void);
+
+		/**
+		  * Upload up to max_tiles tiles streamed since the last call and
+		  * point the indirection texture at them, creating the textures the
+		  * first time.  The context must be current.
+		  */
+		void update (int context_id, int max_tiles = 8);
+
+		/**
+		  * Bind the textures and the shader sampling them, on units 0 and
+		  * 1.  The shader modulates the texel by the primary color.
+		  */
+		void bind (int context_id);
+
+		void unbind (void) const;
+
+		/**
+		  * Destroy the textures and shader of a context.
+		  */
+		void destroyContext (int context_id);
+
+		GLsizei width (void) const { return m_width; }
+		GLsizei height (void) const { return m_height; }
+
+		/**
+		  * Returns the number of mipmap levels, the last a single tile.
+		  */
+		int getLevelCount (void) const { return (int)m_levels.size (); }
+
+		/**
+		  * Returns true once a context has every tile the requests so far
+		  * will bring it: none are left to read, or room for them.
+		  */
+		bool isComplete (int context_id) const;
+
+	private:
+
+		/**
+		  * A level of the mipmap chain in the tile file.
+		  */
+		struct Level
+		{
+			GLsizei width, height;
+			int 	tiles_x, tiles_y;
+			uint64_t first;			// Index in the file of the level's first tile.
+		};
+
+		/**
+		  * A place for a tile in the cache texture.
+		  */
+		struct Slot
+		{
+			Slot (void) : tile (NO_TILE), last_used (0), version (0) {}
+
+			uint64_t 					tile;
+			uint64_t 					last_used;	// Last frame the tile was asked for.
+			unsigned int 				version;	// Changes with each tile read into it.
+			std::vector <unsigned char> bits;
+		};
+
+		/**
+		  * What a context (or share group) has of the cache.
+		  */
+		struct ContextState
+		{
+			ContextState (void) : cache (0), indirection (0), generation (0) {}
+
+			GLuint 						 cache;
+			GLuint 						 indirection;
+			unsigned int 				 generation;	// File the textures were made for.
+			std::vector <uint64_t> 		 tiles;		// Tile in each slot of the cache texture.
+			std::vector <unsigned int> 	 versions;	// Slot version uploaded.
+		};
+
+		static const uint64_t NO_TILE = ~0ull;
+
+		VirtualTexture (const VirtualTexture &);
+		VirtualTexture &operator= (const VirtualTexture &);
+
+		/**
+		  * Key of a tile: level first, so that coarser tiles sort last.
+		  */
+		static uint64_t tileKey (int level, int x, int y) { return ((uint64_t)level << 48) | ((uint64_t)y << 24) | (uint64_t)x; }
+		static int tileLevel (uint64_t tile) { return (int)(tile >> 48); }
+		static int tileX (uint64_t tile) { return (int)(tile & 0xffffff); }
+		static int tileY (uint64_t tile) { return (int)((tile >> 24) & 0xffffff); }
+
+		/**
+		  * Texels across a tile, borders included.
+		  */
+		int getPhysicalSize (void) const { return m_tile_size + 2 * m_border; }
+
+		/**
+		  * Stop the streaming thread and close the file.
+		  */
+		void close (void);
+
+		/**
+		  * Read a tile from the file.
+		  */
+		bool readTile (uint64_t tile, unsigned char *bits) const;
+
+		/**
+		  * Body of the streaming thread.
+		  */
+		void stream (void);
+
+		/**
+		  * Pick the next tile to read: the coarsest wanted and missing.
+		  * Returns false if there is none, or nowhere to put it.  The mutex
+		  * must be held.
+		  */
+		bool nextTile (uint64_t &tile) const;
+
+		/**
+		  * Returns the slot to read a tile into, or -1.  The mutex must be
+		  * held.
+		  */
+		int findSlot (void) const;
+
+		/**
+		  * Point the indirection texture of a context at the tiles it has.
+		  */
+		void updateIndirection (const ContextState &state) const;
+
+		// The tile file.
+		int 				m_file;
+		GLsizei 			m_width, m_height;
+		int 				m_tile_size, m_border;
+		std::vector <Level> m_levels;
+		GLsizei 			m_indirection_width, m_indirection_height;
+		unsigned int 		m_generation;	// Changes with each file opened.
+
+		// Shared with the streaming thread.
+		mutable std::mutex 			m_mutex;
+		std::condition_variable 	m_wake;
+		std::thread 				m_thread;
+		bool 						m_stop;
+		uint64_t 					m_frame;
+		std::map <uint64_t, uint64_t> m_wanted;		// Tile to the last frame it was asked for.
+		std::map <uint64_t, int> 	m_resident;		// Tile to its slot.
+		std::vector <Slot> 			m_slots;
+		int 						m_cache_tiles;
+
+		// GL state of the contexts.
+		std::mutex 					m_update_mutex;
+		ContextBuffer <ContextState> m_contexts;
+		Shader 						m_shader;
+		Program 					m_program;
+};
+
+}
@@ -0,0 +1,112 @@
+/*
+   Filename : Constants.h
+   Version  : 1.0
+
+   Purpose  : Compile-time constants and constexpr builders for the math
+              library: axes, rotations, and projection matrices.  Everything
+              here is evaluated by the compiler, so tables built from it are
+              stored in the binary rather than computed at startup.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#pragma once
+
+#include "Vector.h"
+#include "Matrix.h"
+#include "Quaternion.h"
+
+namespace math
+{
+
+namespace constants
+{
+
+constexpr double pi = 3.14159265358979323846;
+constexpr double half_pi = pi * 0.5;
+constexpr double two_pi = pi * 2.0;
+constexpr double degrees_to_radians = pi / 180.0;
+constexpr double radians_to_degrees = 180.0 / pi;
+
+constexpr vec3f x_axis (1.0f, 0.0f, 0.0f);
+constexpr vec3f y_axis (0.0f, 1.0f, 0.0f);
+constexpr vec3f z_axis (0.0f, 0.0f, 1.0f);
+
+constexpr Matrixf identity;
+
+// Exact quarter and half turns (right handed, counter-clockwise looking down
+// the axis towards the origin), laid out like rotateX/Y/Z in Matrix.h.
+constexpr Matrixf rotate_x_90 ( 1,  0,  0,  0,
+                                0,  0, -1,  0,
+                                0,  1,  0,  0,
+                                0,  0,  0,  1);
+constexpr Matrixf rotate_y_90 ( 0,  0,  1,  0,
+                                0,  1,  0,  0,
+                               -1,  0,  0,  0,
+                                0,  0,  0,  1);
+constexpr Matrixf rotate_z_90 ( 0, -1,  0,  0,
+                                1,  0,  0,  0,
+                                0,  0,  1,  0,
+                                0,  0,  0,  1);
+constexpr Matrixf rotate_x_180 (1,  0,  0,  0,
+                                0, -1,  0,  0,
+                                0,  0, -1,  0,
+                                0,  0,  0,  1);
+constexpr Matrixf rotate_y_180 (-1, 0,  0,  0,
+                                0,  1,  0,  0,
+                                0,  0, -1,  0,
+                                0,  0,  0,  1);
+constexpr Matrixf rotate_z_180 (-1, 0,  0,  0,
+                                0, -1,  0,  0,
+                                0,  0,  1,  0,
+                                0,  0,  0,  1);
+
+// The same quarter turns as unit quaternions (w = cos 45, xyz = axis * sin 45).
+constexpr quatf quarter_turn_x (0.70710678118654752f, vec3f (0.70710678118654752f, 0.0f, 0.0f));
+constexpr quatf quarter_turn_y (0.70710678118654752f, vec3f (0.0f, 0.70710678118654752f, 0.0f));
+constexpr quatf quarter_turn_z (0.70710678118654752f, vec3f (0.0f, 0.0f, 0.70710678118654752f));
+
+}
+
+/**
+  * Perspective projection, the same matrix glFrustum builds.
+  */
+template <class T>
+constexpr Matrix<T> frustum (T left, T right, T bottom, T top, T z_near, T z_far)
+{
+	return Matrix<T> ((2 * z_near) * (1 / (right - left)), 0, (right + left) * (1 / (right - left)), 0,
+	                  0, (2 * z_near) * (1 / (top - bottom)), (top + bottom) * (1 / (top - bottom)), 0,
+	                  0, 0, -((z_far + z_near) * (1 / (z_far - z_near))), (-(2 * z_near) * z_far) * (1 / (z_far - z_near)),
+	                  0, 0, -1, 0);
+}
+
+/**
+  * Orthographic projection, the same matrix glOrtho builds.
+  */
+template <class T>
+constexpr Matrix<T> ortho (T left, T right, T bottom, T top, T z_near, T z_far)
+{
+	return Matrix<T> (2 / (right - left), 0, 0, -(right + left) / (right - left),
+	                  0, 2 / (top - bottom), 0, -(top + bottom) / (top - bottom),
+	                  0, 0, -2 / (z_far - z_near), -(z_far + z_near) / (z_far - z_near),
+	                  0, 0, 0, 1);
+}
+
+namespace constants
+{
+
+/** gluOrtho2D (0, 1, 0, 1): maps the unit square to the viewport, for full screen passes. */
+constexpr Matrixf ortho_unit_square = ortho (0.0f, 1.0f, 0.0f, 1.0f, -1.0f, 1.0f);
+
+/** glOrtho (-1, 1, -1, 1, -1, 1): normalized device coordinates. */
+constexpr Matrixf ortho_ndc = ortho (-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
+
+// Matrix stores columns contiguously, so (i, j) is column i, row j here.
+static_assert (rotate_z_90 (0, 1) == 1.0f, "rotate_z_90 must take x to y");
+static_assert (ortho_unit_square (3, 0) == -1.0f, "ortho_unit_square must map 0 to -1");
+
+}
+
+}
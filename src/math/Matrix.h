@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Vector.h"
+#include "MatrixOps.h"
 
 #include <cmath>
 #include <iostream>
@@ -14,38 +15,43 @@ public:
 	/**
 	 * Initialized to identity matrix.
 	 */
-	Matrix();
-	Matrix(const Matrix<T>& m);
-	Matrix(T aa, T ab, T ac, T ad,
-	       T ba, T bb, T bc, T bd,
-	       T ca, T cb, T cc, T cd,
-	       T da, T db, T dc, T dd);
+	constexpr Matrix();
+	constexpr Matrix(const Matrix<T>& m) = default;
+	constexpr Matrix(T aa, T ab, T ac, T ad,
+	                 T ba, T bb, T bc, T bd,
+	                 T ca, T cb, T cc, T cd,
+	                 T da, T db, T dc, T dd);
 
-	const Matrix<T>& operator=(const Matrix<T>& m);
+	constexpr const Matrix<T>& operator=(const Matrix<T>& m);
 
-	T& operator( )(int i) { return _data[i]; }
-	T operator() (int i) const { return _data[i]; }
+	constexpr T& operator( )(int i) { return _data[i]; }
+	constexpr T operator() (int i) const { return _data[i]; }
 
-	Matrix<T> operator* (const Matrix<T> &other);
+	MATH_CONSTEXPR Matrix<T> operator* (const Matrix<T> &other) const;
 
-	void zero (void);
+	constexpr void zero (void);
+
+	/**
+	 * Return the transpose of this matrix.
+	 */
+	MATH_CONSTEXPR Matrix<T> transpose (void) const;
 
 	/**
 	 * Return the element in the ith row, jth column.
 	 */
-	T& operator() (int i, int j) { return _data[j + i * 4]; }
-	T operator() (int i, int j) const { return _data[j + i * 4]; }
+	constexpr T& operator() (int i, int j) { return _data[j + i * 4]; }
+	constexpr T operator() (int i, int j) const { return _data[j + i * 4]; }
 
-	Vector<T, 4> row (int i) const;
-	Vector<T, 4> col (int j) const;
+	constexpr Vector<T, 4> row (int i) const;
+	constexpr Vector<T, 4> col (int j) const;
 
 	/**
 	 * Return the internal array.
 	 * The data is stored in column major form,
 	 * just the way OpenGL likes it.
 	 */
-	T *data (void) { return _data; }
-	const T *data (void) const { return _data; }
+	constexpr T *data (void) { return _data; }
+	constexpr const T *data (void) const { return _data; }
 
 	void setData (T *data);
 
@@ -60,21 +66,16 @@ private:
 // 03 07 11 15
 
 template <class T>
-Matrix<T>::Matrix()
+constexpr Matrix<T>::Matrix()
+	: _data { 1, 0, 0, 0,
+	          0, 1, 0, 0,
+	          0, 0, 1, 0,
+	          0, 0, 0, 1 }
 {
-	for (int i = 0; i < 16; ++i)
-	{
-		_data[i] = 0;
-	}
-
-	_data[0] = 1;
-	_data[5] = 1;
-	_data[10] = 1;
-	_data[15] = 1;
 }
 
 template <class T>
-void Matrix<T>::zero (void)
+constexpr void Matrix<T>::zero (void)
 {
 	for (size_t i = 0; i < 16; ++i)
 	{
@@ -83,25 +84,19 @@ void Matrix<T>::zero (void)
 }
 
 template <class T>
-Matrix<T>::Matrix(const Matrix<T>& m)
+constexpr Matrix<T>::Matrix(T aa, T ab, T ac, T ad,
+                            T ba, T bb, T bc, T bd,
+                            T ca, T cb, T cc, T cd,
+                            T da, T db, T dc, T dd)
+	: _data { aa, ba, ca, da,
+	          ab, bb, cb, db,
+	          ac, bc, cc, dc,
+	          ad, bd, cd, dd }
 {
-	operator=(m);
 }
 
 template <class T>
-Matrix<T>::Matrix(T aa, T ab, T ac, T ad,
-                  T ba, T bb, T bc, T bd,
-                  T ca, T cb, T cc, T cd,
-                  T da, T db, T dc, T dd)
-{
-	_data[ 0] = aa; _data[ 4] = ab; _data[ 8] = ac; _data[12] = ad;
-	_data[ 1] = ba; _data[ 5] = bb; _data[ 9] = bc; _data[13] = bd;
-	_data[ 2] = ca; _data[ 6] = cb; _data[10] = cc; _data[14] = cd;
-	_data[ 3] = da; _data[ 7] = db; _data[11] = dc; _data[15] = dd;
-}
-
-template <class T>
-const Matrix<T>& Matrix<T>::operator=(const Matrix<T>& m)
+constexpr const Matrix<T>& Matrix<T>::operator=(const Matrix<T>& m)
 {
 	for (int i = 0; i < 16; ++i)
 	{
@@ -112,26 +107,23 @@ const Matrix<T>& Matrix<T>::operator=(const Matrix<T>& m)
 }
 
 template <class T>
-Matrix <T> Matrix<T>::operator* (const Matrix <T> &other)
+MATH_CONSTEXPR Matrix <T> Matrix<T>::operator* (const Matrix <T> &other) const
 {
 	Matrix <T> result;
+	MatrixOps<T>::multiply (result._data, _data, other._data);
+	return result;
+}
 
-	for (size_t r = 0; r < 4; ++r)
-	{
-		for (size_t c = 0; c < 4; ++c)
-		{
-			for (size_t i = 0; i < 4; ++i)
-			{
-				result(r, c) += (*this)(r, i) * other(i, c);
-			}
-		}
-	}
-
+template <class T>
+MATH_CONSTEXPR Matrix <T> Matrix<T>::transpose (void) const
+{
+	Matrix <T> result;
+	MatrixOps<T>::transpose (result._data, _data);
 	return result;
 }
 
 template <class T>
-Vector<T, 4> Matrix<T>::row(int i) const
+constexpr Vector<T, 4> Matrix<T>::row(int i) const
 {
 	Vector<T, 4> v;
 
@@ -144,7 +136,7 @@ Vector<T, 4> Matrix<T>::row(int i) const
 }
 
 template <class T>
-Vector<T, 4> Matrix<T>::col(int j) const
+constexpr Vector<T, 4> Matrix<T>::col(int j) const
 {
 	Vector<T, 4> v;
 
@@ -302,38 +294,116 @@ Matrix<T> rotate(T angle, const Vector<T, 4>& vector)
 }
 
 template <class T>
-Matrix<T> operator*(const Matrix<T>& A, const Matrix<T>& B)
+MATH_CONSTEXPR Vector<T, 4> operator*(const Matrix<T>& M, const Vector<T, 4>& v)
 {
-	Matrix<T> C;
+	Vector<T, 4> result;
+	MatrixOps<T>::transform (result.v, M.data (), v.v);
+	return result;
+}
 
-	for (int j = 0; j < 4; ++j)
+/**
+ * Invert a general 4x4 matrix.
+ * @param M Matrix to invert.
+ * @param result Receives the inverse.  Untouched if M is singular.
+ * @return false if M is singular.
+ */
+template <class T>
+MATH_CONSTEXPR bool inverse(const Matrix<T>& M, Matrix<T>& result)
+{
+	return MatrixOps<T>::inverse (result.data (), M.data ());
+}
+
+/**
+ * Invert a general 4x4 matrix, returning identity if it is singular.
+ */
+template <class T>
+MATH_CONSTEXPR Matrix<T> inverse(const Matrix<T>& M)
+{
+	Matrix<T> result;
+	inverse (M, result);
+	return result;
+}
+
+/**
+ * Invert an affine matrix (an OpenGL matrix whose bottom row is 0, 0, 0, 1),
+ * such as a modelview matrix.  Cheaper than the general inverse.
+ * @param M Matrix to invert.
+ * @param result Receives the inverse.  Untouched if M is singular.
+ * @return false if the upper 3x3 of M is singular.
+ */
+template <class T>
+MATH_CONSTEXPR bool affineInverse(const Matrix<T>& M, Matrix<T>& result)
+{
+	return MatrixOps<T>::affineInverse (result.data (), M.data ());
+}
+
+/**
+ * Invert an affine matrix, returning identity if it is singular.
+ */
+template <class T>
+MATH_CONSTEXPR Matrix<T> affineInverse(const Matrix<T>& M)
+{
+	Matrix<T> result;
+	affineInverse (M, result);
+	return result;
+}
+
+/**
+ * Transform count homogeneous points by M, the same as out[i] = M * in[i].
+ * in and out may be the same array.
+ */
+template <class T>
+void transformPoints(const Matrix<T>& M, const Vector<T, 4> *in, Vector<T, 4> *out, size_t count)
+{
+	if (count == 0)
 	{
-		for (int i = 0; i < 4; ++i)
-		{
-			C(i, j) = A.row(i).dot(B.col(j));
-		}
+		return;
 	}
 
-	return C;
+	MatrixOps<T>::transform4 (out[0].v, M.data (), in[0].v, count);
 }
 
+/**
+ * Transform count points with an implicit w of one by the affine matrix M.
+ * M is in the OpenGL layout that affineInverse and glLoadMatrix take, with
+ * the translation in data[12..14]; this is not the layout operator* (M, v)
+ * and the vec4 overload read.  in and out may be the same array.
+ */
 template <class T>
-Vector<T, 4> operator*(const Matrix<T>& M, const Vector<T, 4>& v)
+void transformPoints(const Matrix<T>& M, const Vector<T, 3> *in, Vector<T, 3> *out, size_t count)
 {
-	Vector<T, 4> result;
-
-	for (int i = 0; i < 4; ++i)
+	if (count == 0)
 	{
-		result[i] = dot (M.row(i), v);
+		return;
 	}
 
-	return result;
+	MatrixOps<T>::transform3 (out[0].v, M.data (), in[0].v, count);
 }
 
+/**
+ * Transform count points stored as separate x, y and z arrays by the affine
+ * matrix M, in the same OpenGL layout as the vec3 overload.  The outputs may
+ * be the inputs.
+ */
+template <class T>
+MATH_CONSTEXPR void transformPoints(const Matrix<T>& M, const T *x, const T *y, const T *z, T *out_x, T *out_y, T *out_z, size_t count)
+{
+	MatrixOps<T>::transformSoA (out_x, out_y, out_z, M.data (), x, y, z, (T)1, count);
+}
 
+/**
+ * Transform count directions stored as separate x, y and z arrays by the
+ * affine matrix M, in the OpenGL layout, ignoring its translation.  The
+ * outputs may be the inputs.
+ */
+template <class T>
+MATH_CONSTEXPR void transformDirections(const Matrix<T>& M, const T *x, const T *y, const T *z, T *out_x, T *out_y, T *out_z, size_t count)
+{
+	MatrixOps<T>::transformSoA (out_x, out_y, out_z, M.data (), x, y, z, (T)0, count);
+}
 
 template <class T>
-bool operator==(const Matrix<T>& A, const Matrix<T>& B)
+constexpr bool operator==(const Matrix<T>& A, const Matrix<T>& B)
 {
 	bool result = true;
 
@@ -349,7 +419,7 @@ bool operator==(const Matrix<T>& A, const Matrix<T>& B)
 }
 
 template <class T>
-bool operator!=(const Matrix<T>& A, const Matrix<T>& B)
+constexpr bool operator!=(const Matrix<T>& A, const Matrix<T>& B)
 {
 	return !(A == B);
 }
@@ -0,0 +1,507 @@
+#pragma once
+
+/**
+ * 4x4 matrix kernels used by math::Matrix.
+ *
+ * All kernels work on the raw 16 element array as laid out in
+ * math::Matrix, where element (i, j) lives at data[j + i * 4].
+ * MatrixOpsScalar<T> runs plain loops and is what MatrixOps<T> uses by
+ * default; MatrixOps<float> is specialized with SSE when VectorOps.h enables
+ * it (see MATH_USE_SSE / MATH_NO_SIMD).
+ *
+ * Every kernel tolerates its output aliasing one of its inputs.  As with
+ * VectorOps, the kernels are usable in constant expressions where
+ * MATH_CONSTEXPR allows.
+ */
+
+#include "VectorOps.h"
+
+#include <stddef.h>
+#include <math.h>
+
+namespace math
+{
+
+template <typename T>
+struct MatrixOpsScalar
+{
+	/** r(i, j) = sum_k a(i, k) * b(k, j) */
+	static constexpr inline void multiply (T *r, const T *a, const T *b)
+	{
+		T tmp[16] = {};
+		for (int i = 0; i < 4; ++i)
+		{
+			for (int j = 0; j < 4; ++j)
+			{
+				tmp[j + i * 4] = a[0 + i * 4] * b[j + 0] +
+				                 a[1 + i * 4] * b[j + 4] +
+				                 a[2 + i * 4] * b[j + 8] +
+				                 a[3 + i * 4] * b[j + 12];
+			}
+		}
+
+		for (int i = 0; i < 16; ++i)
+		{
+			r[i] = tmp[i];
+		}
+	}
+
+	static constexpr inline void transpose (T *r, const T *a)
+	{
+		T tmp[16] = {};
+		for (int i = 0; i < 4; ++i)
+		{
+			for (int j = 0; j < 4; ++j)
+			{
+				tmp[j + i * 4] = a[i + j * 4];
+			}
+		}
+
+		for (int i = 0; i < 16; ++i)
+		{
+			r[i] = tmp[i];
+		}
+	}
+
+	/** r[i] = sum_j m(i, j) * v[j] */
+	static constexpr inline void transform (T *r, const T *m, const T *v)
+	{
+		T x = v[0], y = v[1], z = v[2], w = v[3];
+		for (int i = 0; i < 4; ++i)
+		{
+			r[i] = m[0 + i * 4] * x + m[1 + i * 4] * y + m[2 + i * 4] * z + m[3 + i * 4] * w;
+		}
+	}
+
+	/**
+	  * Transform count points of stride 4 (x, y, z, w).
+	  */
+	static constexpr inline void transform4 (T *r, const T *m, const T *v, size_t count)
+	{
+		for (size_t n = 0; n < count; ++n)
+		{
+			transform (r + n * 4, m, v + n * 4);
+		}
+	}
+
+	/**
+	  * Transform count points of stride 3 with an implicit w of one.  The
+	  * resulting w is dropped, so this is only meaningful for affine m.
+	  * Like affineInverse, m is in the OpenGL layout: m[0..2], m[4..6] and
+	  * m[8..10] are the columns of the upper 3x3 and m[12..14] is the
+	  * translation.  This is the transpose of what transform reads.
+	  */
+	static constexpr inline void transform3 (T *r, const T *m, const T *v, size_t count)
+	{
+		for (size_t n = 0; n < count; ++n)
+		{
+			const T *p = v + n * 3;
+			T x = p[0], y = p[1], z = p[2];
+			for (int i = 0; i < 3; ++i)
+			{
+				r[n * 3 + i] = m[0 + i] * x + m[4 + i] * y + m[8 + i] * z + m[12 + i];
+			}
+		}
+	}
+
+	/**
+	  * Transform count points stored as separate x, y and z arrays
+	  * (structure of arrays) with an implicit w, one for points and zero for
+	  * directions.  The resulting w is dropped, so m should be affine.  m is
+	  * in the same OpenGL layout as for transform3.  The output arrays may be
+	  * the input arrays.
+	  */
+	static constexpr inline void transformSoA (T *rx, T *ry, T *rz, const T *m, const T *x, const T *y, const T *z, T w, size_t count)
+	{
+		for (size_t n = 0; n < count; ++n)
+		{
+			T px = x[n], py = y[n], pz = z[n];
+			rx[n] = m[0] * px + m[4] * py + m[8]  * pz + m[12] * w;
+			ry[n] = m[1] * px + m[5] * py + m[9]  * pz + m[13] * w;
+			rz[n] = m[2] * px + m[6] * py + m[10] * pz + m[14] * w;
+		}
+	}
+
+	/**
+	  * General inverse by cofactor expansion.  Returns false and leaves r
+	  * untouched if the matrix is singular.
+	  */
+	static constexpr inline bool inverse (T *r, const T *m)
+	{
+		T inv[16] = {};
+
+		inv[0]  =  m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+		inv[4]  = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+		inv[8]  =  m[4] * m[9]  * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+		inv[12] = -m[4] * m[9]  * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+		inv[1]  = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+		inv[5]  =  m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+		inv[9]  = -m[0] * m[9]  * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+		inv[13] =  m[0] * m[9]  * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+		inv[2]  =  m[1] * m[6]  * m[15] - m[1] * m[7]  * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7]  - m[13] * m[3] * m[6];
+		inv[6]  = -m[0] * m[6]  * m[15] + m[0] * m[7]  * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7]  + m[12] * m[3] * m[6];
+		inv[10] =  m[0] * m[5]  * m[15] - m[0] * m[7]  * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7]  - m[12] * m[3] * m[5];
+		inv[14] = -m[0] * m[5]  * m[14] + m[0] * m[6]  * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6]  + m[12] * m[2] * m[5];
+		inv[3]  = -m[1] * m[6]  * m[11] + m[1] * m[7]  * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9]  * m[2] * m[7]  + m[9]  * m[3] * m[6];
+		inv[7]  =  m[0] * m[6]  * m[11] - m[0] * m[7]  * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8]  * m[2] * m[7]  - m[8]  * m[3] * m[6];
+		inv[11] = -m[0] * m[5]  * m[11] + m[0] * m[7]  * m[9]  + m[4] * m[1] * m[11] - m[4] * m[3] * m[9]  - m[8]  * m[1] * m[7]  + m[8]  * m[3] * m[5];
+		inv[15] =  m[0] * m[5]  * m[10] - m[0] * m[6]  * m[9]  - m[4] * m[1] * m[10] + m[4] * m[2] * m[9]  + m[8]  * m[1] * m[6]  - m[8]  * m[2] * m[5];
+
+		T det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+		if (det == 0)
+		{
+			return false;
+		}
+
+		det = (T)1 / det;
+		for (int i = 0; i < 16; ++i)
+		{
+			r[i] = inv[i] * det;
+		}
+
+		return true;
+	}
+
+	/**
+	  * Inverse of an affine matrix, i.e. one whose elements (0, 3), (1, 3)
+	  * and (2, 3) are zero and (3, 3) is one.  In OpenGL terms this is a
+	  * matrix with a (0, 0, 0, 1) bottom row.  The upper 3x3 may contain any
+	  * invertible rotation, scale and shear.  Returns false if it is singular.
+	  */
+	static constexpr inline bool affineInverse (T *r, const T *m)
+	{
+		// Rows of the upper 3x3 are a, b, c.  The columns of its inverse are
+		// (b x c, c x a, a x b) / det.
+		T c0[3] = { m[5] * m[10] - m[6] * m[9],  m[6] * m[8]  - m[4] * m[10], m[4] * m[9] - m[5] * m[8] };
+		T c1[3] = { m[9] * m[2]  - m[10] * m[1], m[10] * m[0] - m[8] * m[2],  m[8] * m[1] - m[9] * m[0] };
+		T c2[3] = { m[1] * m[6]  - m[2] * m[5],  m[2] * m[4]  - m[0] * m[6],  m[0] * m[5] - m[1] * m[4] };
+
+		T det = m[0] * c0[0] + m[1] * c0[1] + m[2] * c0[2];
+		if (det == 0)
+		{
+			return false;
+		}
+		det = (T)1 / det;
+
+		T inv[16] = {};
+		for (int i = 0; i < 3; ++i)
+		{
+			inv[0 + i * 4] = c0[i] * det;
+			inv[1 + i * 4] = c1[i] * det;
+			inv[2 + i * 4] = c2[i] * det;
+			inv[3 + i * 4] = 0;
+		}
+
+		// The translation row is -t * inverse (upper 3x3).
+		T tx = m[12], ty = m[13], tz = m[14];
+		for (int j = 0; j < 3; ++j)
+		{
+			inv[12 + j] = -(tx * inv[j] + ty * inv[j + 4] + tz * inv[j + 8]);
+		}
+		inv[15] = 1;
+
+		for (int i = 0; i < 16; ++i)
+		{
+			r[i] = inv[i];
+		}
+
+		return true;
+	}
+};
+
+template <typename T>
+struct MatrixOps : public MatrixOpsScalar <T>
+{
+};
+
+#ifdef MATH_USE_SSE
+
+namespace sse
+{
+
+#define MATH_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps ((a), (b), _MM_SHUFFLE ((w), (z), (y), (x)))
+#define MATH_SWIZZLE(a, x, y, z, w) MATH_SHUFFLE ((a), (a), (x), (y), (z), (w))
+
+/** 2x2 row major matrix product a * b, each packed as (00, 01, 10, 11). */
+inline __m128 mat2Mul (__m128 a, __m128 b)
+{
+	return _mm_add_ps (_mm_mul_ps (a, MATH_SWIZZLE (b, 0, 3, 0, 3)),
+	                   _mm_mul_ps (MATH_SWIZZLE (a, 1, 0, 3, 2), MATH_SWIZZLE (b, 2, 1, 2, 1)));
+}
+
+/** adj(a) * b */
+inline __m128 mat2AdjMul (__m128 a, __m128 b)
+{
+	return _mm_sub_ps (_mm_mul_ps (MATH_SWIZZLE (a, 3, 3, 0, 0), b),
+	                   _mm_mul_ps (MATH_SWIZZLE (a, 1, 1, 2, 2), MATH_SWIZZLE (b, 2, 3, 0, 1)));
+}
+
+/** a * adj(b) */
+inline __m128 mat2MulAdj (__m128 a, __m128 b)
+{
+	return _mm_sub_ps (_mm_mul_ps (a, MATH_SWIZZLE (b, 3, 0, 3, 0)),
+	                   _mm_mul_ps (MATH_SWIZZLE (a, 1, 0, 3, 2), MATH_SWIZZLE (b, 2, 1, 2, 1)));
+}
+
+}
+
+template <>
+struct MatrixOps <float>
+{
+	static MATH_CONSTEXPR inline void multiply (float *r, const float *a, const float *b)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			MatrixOpsScalar <float>::multiply (r, a, b);
+			return;
+		}
+
+		__m128 b0 = _mm_loadu_ps (b + 0);
+		__m128 b1 = _mm_loadu_ps (b + 4);
+		__m128 b2 = _mm_loadu_ps (b + 8);
+		__m128 b3 = _mm_loadu_ps (b + 12);
+
+		for (int i = 0; i < 4; ++i)
+		{
+			__m128 row = _mm_loadu_ps (a + i * 4);
+			__m128 result = _mm_mul_ps (MATH_SWIZZLE (row, 0, 0, 0, 0), b0);
+			result = _mm_add_ps (result, _mm_mul_ps (MATH_SWIZZLE (row, 1, 1, 1, 1), b1));
+			result = _mm_add_ps (result, _mm_mul_ps (MATH_SWIZZLE (row, 2, 2, 2, 2), b2));
+			result = _mm_add_ps (result, _mm_mul_ps (MATH_SWIZZLE (row, 3, 3, 3, 3), b3));
+			_mm_storeu_ps (r + i * 4, result);
+		}
+	}
+
+	static MATH_CONSTEXPR inline void transpose (float *r, const float *a)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			MatrixOpsScalar <float>::transpose (r, a);
+			return;
+		}
+
+		__m128 r0 = _mm_loadu_ps (a + 0);
+		__m128 r1 = _mm_loadu_ps (a + 4);
+		__m128 r2 = _mm_loadu_ps (a + 8);
+		__m128 r3 = _mm_loadu_ps (a + 12);
+		_MM_TRANSPOSE4_PS (r0, r1, r2, r3);
+		_mm_storeu_ps (r + 0, r0);
+		_mm_storeu_ps (r + 4, r1);
+		_mm_storeu_ps (r + 8, r2);
+		_mm_storeu_ps (r + 12, r3);
+	}
+
+	static MATH_CONSTEXPR inline void transform (float *r, const float *m, const float *v)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			MatrixOpsScalar <float>::transform (r, m, v);
+			return;
+		}
+
+		transform4 (r, m, v, 1);
+	}
+
+	static MATH_CONSTEXPR inline void transform4 (float *r, const float *m, const float *v, size_t count)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			MatrixOpsScalar <float>::transform4 (r, m, v, count);
+			return;
+		}
+
+		// Columns of m, so each point is a sum of four broadcasts.
+		__m128 c0 = _mm_loadu_ps (m + 0);
+		__m128 c1 = _mm_loadu_ps (m + 4);
+		__m128 c2 = _mm_loadu_ps (m + 8);
+		__m128 c3 = _mm_loadu_ps (m + 12);
+		_MM_TRANSPOSE4_PS (c0, c1, c2, c3);
+
+		for (size_t n = 0; n < count; ++n)
+		{
+			__m128 p = _mm_loadu_ps (v + n * 4);
+			__m128 result = _mm_mul_ps (c0, MATH_SWIZZLE (p, 0, 0, 0, 0));
+			result = _mm_add_ps (result, _mm_mul_ps (c1, MATH_SWIZZLE (p, 1, 1, 1, 1)));
+			result = _mm_add_ps (result, _mm_mul_ps (c2, MATH_SWIZZLE (p, 2, 2, 2, 2)));
+			result = _mm_add_ps (result, _mm_mul_ps (c3, MATH_SWIZZLE (p, 3, 3, 3, 3)));
+			_mm_storeu_ps (r + n * 4, result);
+		}
+	}
+
+	static MATH_CONSTEXPR inline void transform3 (float *r, const float *m, const float *v, size_t count)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			MatrixOpsScalar <float>::transform3 (r, m, v, count);
+			return;
+		}
+
+		// OpenGL layout, so the columns load directly.
+		__m128 c0 = _mm_loadu_ps (m + 0);
+		__m128 c1 = _mm_loadu_ps (m + 4);
+		__m128 c2 = _mm_loadu_ps (m + 8);
+		__m128 c3 = _mm_loadu_ps (m + 12);
+
+		for (size_t n = 0; n < count; ++n)
+		{
+			const float *p = v + n * 3;
+			__m128 result = _mm_add_ps (c3, _mm_mul_ps (c0, _mm_set1_ps (p[0])));
+			result = _mm_add_ps (result, _mm_mul_ps (c1, _mm_set1_ps (p[1])));
+			result = _mm_add_ps (result, _mm_mul_ps (c2, _mm_set1_ps (p[2])));
+			sse::store3 (r + n * 3, result);
+		}
+	}
+
+	static MATH_CONSTEXPR inline void transformSoA (float *rx, float *ry, float *rz, const float *m, const float *x, const float *y, const float *z, float w, size_t count)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			MatrixOpsScalar <float>::transformSoA (rx, ry, rz, m, x, y, z, w, count);
+			return;
+		}
+
+		// Four points per iteration, one per lane.  The sums are grouped the
+		// same way as the scalar loop so both give identical results.
+		__m128 m00 = _mm_set1_ps (m[0]), m01 = _mm_set1_ps (m[4]), m02 = _mm_set1_ps (m[8]),  t0 = _mm_set1_ps (m[12] * w);
+		__m128 m10 = _mm_set1_ps (m[1]), m11 = _mm_set1_ps (m[5]), m12 = _mm_set1_ps (m[9]),  t1 = _mm_set1_ps (m[13] * w);
+		__m128 m20 = _mm_set1_ps (m[2]), m21 = _mm_set1_ps (m[6]), m22 = _mm_set1_ps (m[10]), t2 = _mm_set1_ps (m[14] * w);
+
+		size_t n = 0;
+		for (; n + 4 <= count; n += 4)
+		{
+			__m128 px = _mm_loadu_ps (x + n);
+			__m128 py = _mm_loadu_ps (y + n);
+			__m128 pz = _mm_loadu_ps (z + n);
+
+			__m128 ox = _mm_add_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (m00, px), _mm_mul_ps (m01, py)), _mm_mul_ps (m02, pz)), t0);
+			__m128 oy = _mm_add_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (m10, px), _mm_mul_ps (m11, py)), _mm_mul_ps (m12, pz)), t1);
+			__m128 oz = _mm_add_ps (_mm_add_ps (_mm_add_ps (_mm_mul_ps (m20, px), _mm_mul_ps (m21, py)), _mm_mul_ps (m22, pz)), t2);
+
+			_mm_storeu_ps (rx + n, ox);
+			_mm_storeu_ps (ry + n, oy);
+			_mm_storeu_ps (rz + n, oz);
+		}
+
+		MatrixOpsScalar <float>::transformSoA (rx + n, ry + n, rz + n, m, x + n, y + n, z + n, w, count - n);
+	}
+
+	/**
+	  * Block-wise inverse using 2x2 sub-matrices and their adjugates.
+	  */
+	static MATH_CONSTEXPR inline bool inverse (float *r, const float *m)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			return MatrixOpsScalar <float>::inverse (r, m);
+		}
+
+		__m128 r0 = _mm_loadu_ps (m + 0);
+		__m128 r1 = _mm_loadu_ps (m + 4);
+		__m128 r2 = _mm_loadu_ps (m + 8);
+		__m128 r3 = _mm_loadu_ps (m + 12);
+
+		// The 2x2 blocks A B / C D.
+		__m128 A = _mm_movelh_ps (r0, r1);
+		__m128 B = _mm_movehl_ps (r1, r0);
+		__m128 C = _mm_movelh_ps (r2, r3);
+		__m128 D = _mm_movehl_ps (r3, r2);
+
+		// (|A|, |B|, |C|, |D|)
+		__m128 det_sub = _mm_sub_ps (_mm_mul_ps (MATH_SHUFFLE (r0, r2, 0, 2, 0, 2), MATH_SHUFFLE (r1, r3, 1, 3, 1, 3)),
+		                             _mm_mul_ps (MATH_SHUFFLE (r0, r2, 1, 3, 1, 3), MATH_SHUFFLE (r1, r3, 0, 2, 0, 2)));
+		__m128 det_A = MATH_SWIZZLE (det_sub, 0, 0, 0, 0);
+		__m128 det_B = MATH_SWIZZLE (det_sub, 1, 1, 1, 1);
+		__m128 det_C = MATH_SWIZZLE (det_sub, 2, 2, 2, 2);
+		__m128 det_D = MATH_SWIZZLE (det_sub, 3, 3, 3, 3);
+
+		__m128 D_C = sse::mat2AdjMul (D, C);
+		__m128 A_B = sse::mat2AdjMul (A, B);
+		__m128 X = _mm_sub_ps (_mm_mul_ps (det_D, A), sse::mat2Mul (B, D_C));
+		__m128 W = _mm_sub_ps (_mm_mul_ps (det_A, D), sse::mat2Mul (C, A_B));
+		__m128 Y = _mm_sub_ps (_mm_mul_ps (det_B, C), sse::mat2MulAdj (D, A_B));
+		__m128 Z = _mm_sub_ps (_mm_mul_ps (det_C, B), sse::mat2MulAdj (A, D_C));
+
+		// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+		__m128 tr = _mm_mul_ps (A_B, MATH_SWIZZLE (D_C, 0, 2, 1, 3));
+		tr = _mm_add_ps (tr, _mm_movehl_ps (tr, tr));
+		tr = _mm_add_ss (tr, MATH_SWIZZLE (tr, 1, 1, 1, 1));
+		__m128 det_M = _mm_sub_ss (_mm_add_ss (_mm_mul_ss (det_A, det_D), _mm_mul_ss (det_B, det_C)), tr);
+
+		float det = _mm_cvtss_f32 (det_M);
+		if (det == 0.0f)
+		{
+			return false;
+		}
+
+		__m128 r_det = _mm_div_ps (_mm_setr_ps (1.0f, -1.0f, -1.0f, 1.0f), MATH_SWIZZLE (det_M, 0, 0, 0, 0));
+		X = _mm_mul_ps (X, r_det);
+		Y = _mm_mul_ps (Y, r_det);
+		Z = _mm_mul_ps (Z, r_det);
+		W = _mm_mul_ps (W, r_det);
+
+		// Apply the adjugate shuffle while storing.
+		_mm_storeu_ps (r + 0,  MATH_SHUFFLE (X, Y, 3, 1, 3, 1));
+		_mm_storeu_ps (r + 4,  MATH_SHUFFLE (X, Y, 2, 0, 2, 0));
+		_mm_storeu_ps (r + 8,  MATH_SHUFFLE (Z, W, 3, 1, 3, 1));
+		_mm_storeu_ps (r + 12, MATH_SHUFFLE (Z, W, 2, 0, 2, 0));
+
+		return true;
+	}
+
+	static MATH_CONSTEXPR inline bool affineInverse (float *r, const float *m)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			return MatrixOpsScalar <float>::affineInverse (r, m);
+		}
+
+		__m128 a = _mm_loadu_ps (m + 0);
+		__m128 b = _mm_loadu_ps (m + 4);
+		__m128 c = _mm_loadu_ps (m + 8);
+		__m128 t = _mm_loadu_ps (m + 12);
+
+		// b x c, c x a, a x b are the columns of the inverse upper 3x3.
+		__m128 c0 = _mm_sub_ps (_mm_mul_ps (MATH_SWIZZLE (b, 1, 2, 0, 3), MATH_SWIZZLE (c, 2, 0, 1, 3)),
+		                        _mm_mul_ps (MATH_SWIZZLE (b, 2, 0, 1, 3), MATH_SWIZZLE (c, 1, 2, 0, 3)));
+		__m128 c1 = _mm_sub_ps (_mm_mul_ps (MATH_SWIZZLE (c, 1, 2, 0, 3), MATH_SWIZZLE (a, 2, 0, 1, 3)),
+		                        _mm_mul_ps (MATH_SWIZZLE (c, 2, 0, 1, 3), MATH_SWIZZLE (a, 1, 2, 0, 3)));
+		__m128 c2 = _mm_sub_ps (_mm_mul_ps (MATH_SWIZZLE (a, 1, 2, 0, 3), MATH_SWIZZLE (b, 2, 0, 1, 3)),
+		                        _mm_mul_ps (MATH_SWIZZLE (a, 2, 0, 1, 3), MATH_SWIZZLE (b, 1, 2, 0, 3)));
+
+		// a . (b x c); the w lanes of the crosses are zero.
+		float det = sse::hsum (_mm_mul_ps (a, c0));
+		if (det == 0.0f)
+		{
+			return false;
+		}
+
+		__m128 r_det = _mm_set1_ps (1.0f / det);
+		c0 = _mm_mul_ps (c0, r_det);
+		c1 = _mm_mul_ps (c1, r_det);
+		c2 = _mm_mul_ps (c2, r_det);
+
+		// Rows of the inverse are the transposed columns, w stays zero.
+		__m128 zero = _mm_setzero_ps ();
+		_MM_TRANSPOSE4_PS (c0, c1, c2, zero);
+
+		// Translation row is -(tx * row0 + ty * row1 + tz * row2), w = 1.
+		__m128 translation = _mm_mul_ps (MATH_SWIZZLE (t, 0, 0, 0, 0), c0);
+		translation = _mm_add_ps (translation, _mm_mul_ps (MATH_SWIZZLE (t, 1, 1, 1, 1), c1));
+		translation = _mm_add_ps (translation, _mm_mul_ps (MATH_SWIZZLE (t, 2, 2, 2, 2), c2));
+		translation = _mm_sub_ps (_mm_setr_ps (0.0f, 0.0f, 0.0f, 1.0f), translation);
+
+		_mm_storeu_ps (r + 0,  c0);
+		_mm_storeu_ps (r + 4,  c1);
+		_mm_storeu_ps (r + 8,  c2);
+		_mm_storeu_ps (r + 12, translation);
+
+		return true;
+	}
+};
+
+#undef MATH_SWIZZLE
+#undef MATH_SHUFFLE
+
+#endif
+
+}
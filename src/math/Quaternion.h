@@ -40,19 +40,21 @@ class Quaternion
 		/** 
 		  * Default constructor. 
 		  */
-		Quaternion (void)
+		constexpr Quaternion (void)
+			: m_angle (1),
+			  m_axis (0, 0, 0)
 		{
-			// Load the identity quaternion.
-			identity ();
+			// The identity quaternion.
 		}
 
 		/** 
 		  * Copy contructor.
 		  * @param rhs Quaternion to copy.
 		  */
-		Quaternion (const Quaternion &rhs)
+		constexpr Quaternion (const Quaternion &rhs)
+			: m_angle (rhs.m_angle),
+			  m_axis (rhs.m_axis)
 		{
-			*this = rhs;
 		}
 
 		/** Initialized constructor.  Set create_rotation to true to turn the new
@@ -61,31 +63,21 @@ class Quaternion
 		  * @param axis 3D vector for the quaternion.
 		  * @param create_rotation Flag to immediately turn this quaternion into a rotation quaternion or not.
 		  */
-		Quaternion (T radians, QVec axis, bool create_rotation = false)
+		constexpr Quaternion (T radians, QVec axis, bool create_rotation = false)
+			: m_angle (radians),
+			  m_axis (axis)
 		{
-			if (!create_rotation)
-			{
-				m_angle = radians;
-				m_axis = axis;
-			}
-			else
+			if (create_rotation)
 			{
 				createFromAxisAngle (radians, axis);
 			}
 		}
 
-		/** 
-		  * Default destructor. 
-		  */
-		~Quaternion (void) 
-		{
-		}
-
 		/** 
 		  * Operator +.
 		  * @param rhs Quaternion to add to this one.
 		  */
-		inline Quaternion<T> operator+ (const Quaternion &rhs) const
+		MATH_CONSTEXPR inline Quaternion<T> operator+ (const Quaternion &rhs) const
 		{
 			Quaternion<T> tmp (m_angle + rhs.m_angle, m_axis + rhs.m_axis);
 			return tmp;
@@ -105,7 +97,7 @@ class Quaternion
 		  * Operator -. 
 		  * @param rhs Quaternion to subtract from this one.
 		  */
-		inline Quaternion<T> operator- (const Quaternion &rhs) const
+		MATH_CONSTEXPR inline Quaternion<T> operator- (const Quaternion &rhs) const
 		{
 			Quaternion<T> tmp (m_angle - rhs.m_angle, m_axis - rhs.m_axis);
 			return tmp;
@@ -125,7 +117,7 @@ class Quaternion
 		  * Operator * (quaternion).
 		  * @param rhs Quaternion to multiply into this once.
 		  */
-		inline Quaternion<T> operator* (const Quaternion &rhs) const
+		MATH_CONSTEXPR inline Quaternion<T> operator* (const Quaternion &rhs) const
 		{
 			Quaternion<T> tmp;
 			tmp.m_angle = (m_angle * rhs.m_angle) - math::dot (m_axis, rhs.m_axis);
@@ -169,7 +161,7 @@ class Quaternion
 		  * Operator * (scalar).
 		  * @param scalar Scalar value to multiply into this quaternion.
 		  */
-		inline Quaternion<T> operator* (const T scalar) const
+		MATH_CONSTEXPR inline Quaternion<T> operator* (const T scalar) const
 		{
 			Quaternion<T> tmp (m_angle * scalar, m_axis * scalar);
 			return tmp;
@@ -209,7 +201,7 @@ class Quaternion
 		  * Operator =.
 		  * @param rhs Quaternion to set this one equal to.
 		  */
-		inline Quaternion<T> & operator= (const Quaternion &rhs)
+		constexpr inline Quaternion<T> & operator= (const Quaternion &rhs)
 		{
 			if (this != &rhs)
 			{
@@ -242,7 +234,7 @@ class Quaternion
 		/** 
 		  * Get the conjugate of the quaternion. 
 		  */
-		inline Quaternion<T> conjugate (void) const
+		MATH_CONSTEXPR inline Quaternion<T> conjugate (void) const
 		{
 			Quaternion<T> tmp (m_angle, m_axis * (T)-1);
 			return tmp;
@@ -270,7 +262,7 @@ class Quaternion
 		/** 
 		  * Load the identity quaternion into this quaternion. 
 		  */
-		inline void identity (void)
+		constexpr inline void identity (void)
 		{
 			m_angle = 1;
 			m_axis = QVec (0, 0, 0);
@@ -291,7 +283,7 @@ class Quaternion
 		  * Convert the quaternion into a 4x4 matrix for use with OpenGL (ModelViewMatrix).
 		  * @param matrix Result matrix passed in by reference.
 		  */
-		inline void toMatrix (QMatrix &matrix) const
+		constexpr inline void toMatrix (QMatrix &matrix) const
 		{
 			matrix = QMatrix (1 - 2 * (m_axis[1] * m_axis[1] + m_axis[2] * m_axis[2]),
 			                  2 * (m_axis[0] * m_axis[1] - m_axis[2] * m_angle),
@@ -335,7 +327,7 @@ class Quaternion
 		  * Set the axis of rotation. 
 		  * @param axis New axis of rotation.
 		  */
-		inline void setAxis (const QVec axis)
+		constexpr inline void setAxis (const QVec axis)
 		{
 			m_axis = axis;
 		}
@@ -343,7 +335,7 @@ class Quaternion
 		/** 
 		  * Get the angle of rotation. 
 		  */
-		inline T getAngle (void) const
+		constexpr inline T getAngle (void) const
 		{
 			return m_angle;
 		}
@@ -351,7 +343,7 @@ class Quaternion
 		/**
 		  * Get the axis of rotation. 
 		  */
-		inline const QVec & getAxis (void) const
+		constexpr inline const QVec & getAxis (void) const
 		{
 			return m_axis;
 		}
@@ -359,7 +351,7 @@ class Quaternion
 		/**
 		  * Get an axis with 4 components for matrix multiplication. 
 		  */
-		inline Vector <T, 4> getAxis4 (void) const
+		constexpr inline Vector <T, 4> getAxis4 (void) const
 		{
 			Vector <T, 4> tmp = m_axis;
 			tmp[3] = 1;
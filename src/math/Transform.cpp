@@ -1,95 +1,148 @@
 #include <Transform.h>
+#include <Matrix.h>
+
+#include <algorithm>
 
 namespace cavr
 {
 
-Transform::Transform()
+namespace
 {
-	reset();
-}
 
-void Transform::rotate(vec3f axis, double angle)
+/**
+ * Rotates v by the unit quaternion q.
+ */
+::math::vec3d rotateVector(const ::math::quatd& q, const ::math::vec3d& v)
 {
-	mat4f m;
-	m[3][3] = 1;
-	double c = cos(angle);
-	double s = sin(angle);
-	double t = 1.0 - c;
-	double x = axis.x;
-	double y = axis.y;
-	double z = axis.z;
-	double txx = t * x * x;
-	double txy = t * x * y;
-	double txz = t * x * z;
-	double tyy = t * y * y;
-	double tyz = t * y * z;
-	double tzz = t * z * z;
-	double xs = x * s;
-	double ys = y * s;
-	double zs = z * s;
-	m[0][0] = txx + c;	m[0][1] = txy - zs;	m[0][2] = txz + ys;
-	m[1][0] = txy + zs;	m[1][1] = tyy + c;	m[1][2] = tyz - xs;
-	m[2][0] = txz - ys;	m[2][1] = tyz + xs;	m[2][2] = tzz + c;
-	_matrix = m * _matrix;
-	c = cos(-angle);
-	s = sin(-angle);
-	t = 1.0 - c;
-	x = axis.x;
-	y = axis.y;
-	z = axis.z;
-	txx = t * x * x;
-	txy = t * x * y;
-	txz = t * x * z;
-	tyy = t * y * y;
-	tyz = t * y * z;
-	tzz = t * z * z;
-	xs = x * s;
-	ys = y * s;
-	zs = z * s;
-	m[0][0] = txx + c;	m[0][1] = txy - zs;	m[0][2] = txz + ys;
-	m[1][0] = txy + zs;	m[1][1] = tyy + c;	m[1][2] = tyz - xs;
-	m[2][0] = txz - ys;	m[2][1] = tyz + xs;	m[2][2] = tzz + c;
-	_inverse = _inverse * m;
+	// v + 2w (u x v) + 2u x (u x v), with u the vector part of q.
+	const ::math::vec3d& u = q.getAxis();
+	::math::vec3d t = ::math::cross(u, v) * 2.0;
+	return v + t * q.getAngle() + ::math::cross(u, t);
 }
 
-void Transform::translate(vec3f translation)
+/**
+ * Writes x' = scale * (rotation * x) + translation into m.
+ */
+void compose(mat4f& m, const ::math::quatd& rotation, const ::math::vec3d& translation, double scale)
 {
-	mat4f m;
-	for (int i = 0; i < 4; ++i)
+	// Matrix (i, j) is column i, row j; mat4f [i][j] is row i, column j.
+	::math::Matrixd r;
+	rotation.toMatrix(r);
+	for (int i = 0; i < 3; ++i)
 	{
-		m[i][i] = 1;
+		for (int j = 0; j < 3; ++j)
+		{
+			m[i][j] = scale * r(j, i);
+		}
+		m[i][3] = translation[i];
+		m[3][i] = 0;
 	}
-	m[0][3] = -translation.x;
-	m[1][3] = -translation.y;
-	m[2][3] = -translation.z;
-	_matrix = m * _matrix;
-	m[0][3] = translation.x;
-	m[1][3]= translation.y;
-	m[2][3] = translation.z;
-	_inverse = _inverse * m;
+	m[3][3] = 1;
 }
 
-void Transform::reset()
+/**
+ * Copies m into the OpenGL layout the affine math kernels use, by
+ * transforming the unit vectors so that it does not depend on how mat4f
+ * stores its elements.
+ */
+::math::Matrixf toKernelMatrix(const mat4f& m)
 {
-	for (int i = 0; i < 16; ++i)
+	::math::Matrixf result;
+	float* data = result.data();
+	for (int j = 0; j < 4; ++j)
 	{
-		_matrix.v[i] = 0;
-		_inverse.v[i] = 0;
+		vec4f unit;
+		unit.x = j == 0 ? 1.0f : 0.0f;
+		unit.y = j == 1 ? 1.0f : 0.0f;
+		unit.z = j == 2 ? 1.0f : 0.0f;
+		unit.w = j == 3 ? 1.0f : 0.0f;
+		vec4f column = m * unit;
+		data[j * 4 + 0] = column.x;
+		data[j * 4 + 1] = column.y;
+		data[j * 4 + 2] = column.z;
+		data[j * 4 + 3] = column.w;
 	}
-	for (int i = 0; i < 4; ++i)
+	return result;
+}
+
+void transformSpan(const mat4f& m, const_span3f in, span3f out, float w)
+{
+	size_t count = std::min(in.count, out.count);
+	if (count == 0)
 	{
-		_matrix[i][i] = 1;
-		_inverse[i][i] = 1;
+		return;
 	}
+	::math::Matrixf kernel = toKernelMatrix(m);
+	::math::MatrixOps<float>::transformSoA(out.x, out.y, out.z, kernel.data(), in.x, in.y, in.z, w, count);
+}
+
+}
+
+Transform::Transform()
+{
+	reset();
+}
+
+void Transform::rotate(vec3f axis, double angle)
+{
+	// Applied after the current transform: the rotation turns the current
+	// orientation and carries the translation around with it.
+	double half = angle * 0.5;
+	double s = sin(half);
+	::math::quatd r(cos(half), ::math::vec3d(axis.x * s, axis.y * s, axis.z * s));
+	_rotation = r * _rotation;
+	_rotation.normalize();
+	_translation = rotateVector(r, _translation);
+	_matrix_dirty = true;
+	_inverse_dirty = true;
+}
+
+void Transform::translate(vec3f translation)
+{
+	// The matrix moves points by -translation, as it always has.
+	_translation -= ::math::vec3d(translation.x, translation.y, translation.z);
+	_matrix_dirty = true;
+	_inverse_dirty = true;
 }
 
-mat4f& Transform::matrix() 
+void Transform::scale(double factor)
 {
+	_scale *= factor;
+	_translation *= factor;
+	_matrix_dirty = true;
+	_inverse_dirty = true;
+}
+
+void Transform::reset()
+{
+	_rotation.identity();
+	_translation = ::math::vec3d(0.0, 0.0, 0.0);
+	_scale = 1.0;
+	_matrix_dirty = true;
+	_inverse_dirty = true;
+}
+
+const mat4f& Transform::matrix()
+{
+	if (_matrix_dirty)
+	{
+		compose(_matrix, _rotation, _translation, _scale);
+		_matrix_dirty = false;
+	}
 	return _matrix;
 }
 
-mat4f& Transform::inverse()
+const mat4f& Transform::inverse()
 {
+	if (_inverse_dirty)
+	{
+		// x = (1 / scale) * conj(rotation) * (x' - translation).
+		::math::quatd rotation = _rotation.conjugate();
+		double scale = 1.0 / _scale;
+		::math::vec3d translation = rotateVector(rotation, _translation) * -scale;
+		compose(_inverse, rotation, translation, scale);
+		_inverse_dirty = false;
+	}
 	return _inverse;
 }
 
@@ -97,28 +150,48 @@ vec4f Transform::toVirtualPoint(const vec4f& point)
 {
 	vec4f result = point;
 	result.w = 1.0;
-	return _inverse * result;	
+	return inverse() * result;	
 }
 
 vec4f Transform::toVirtualDirection(const vec4f& direction)
 {
 	vec4f result = direction;
 	result.w = 0.0;
-	return _inverse * result;	
+	return inverse() * result;	
 }
 
 vec4f Transform::toRealPoint(const vec4f& point)
 {
 	vec4f result = point;
 	result.w = 1.0;
-	return _matrix * result;	
+	return matrix() * result;	
 }
 
 vec4f Transform::toRealDirection(const vec4f& direction)
 {
 	vec4f result = direction;
 	result.w = 0.0;
-	return _matrix * result;	
+	return matrix() * result;	
+}
+
+void Transform::toVirtualPoints(const_span3f in, span3f out)
+{
+	transformSpan(inverse(), in, out, 1.0f);
+}
+
+void Transform::toVirtualDirections(const_span3f in, span3f out)
+{
+	transformSpan(inverse(), in, out, 0.0f);
+}
+
+void Transform::toRealPoints(const_span3f in, span3f out)
+{
+	transformSpan(matrix(), in, out, 1.0f);
+}
+
+void Transform::toRealDirections(const_span3f in, span3f out)
+{
+	transformSpan(matrix(), in, out, 0.0f);
 }
 
 }
@@ -1,14 +1,37 @@
 #pragma once
 
 #include <cavr/cavr.h>
+#include <Vector.h>
+#include <Quaternion.h>
 
 using namespace cavr::math;
 
 namespace cavr
 {
 
+/**
+ * A batch of points or directions stored as separate x, y and z arrays of
+ * count elements each (structure of arrays).
+ */
+template <typename T>
+struct Span3
+{
+	T* x;
+	T* y;
+	T* z;
+	size_t count;
+};
+
+typedef Span3<float> span3f;
+typedef Span3<const float> const_span3f;
+
 /**
  * Represents affine transformations and their inverse transformations.
+ *
+ * The transformation is stored as a uniform scale, a rotation and a
+ * translation, x' = scale * (rotation * x) + translation, so each edit is a
+ * handful of scalar operations.  The matrix and its inverse are only built
+ * when they are asked for after an edit.
  */
 class Transform
 {
@@ -25,6 +48,11 @@ public:
 	 */
 	void translate(vec3f translation);
 
+	/**
+	 * Scales uniformly about the origin.
+	 */
+	void scale(double factor);
+
 	/**
 	 * Reverts the transformation to an identity matrix.
 	 */
@@ -33,20 +61,35 @@ public:
 	/**
 	 * Returns the transformation in matrix form.
 	 */
-	mat4f& matrix();
+	const mat4f& matrix();
 
 	/**
 	 * Returns the inverse transformation in matrix form.
 	 */
-	mat4f& inverse();
+	const mat4f& inverse();
 
 	vec4f toVirtualPoint(const vec4f& point);
 	vec4f toVirtualDirection(const vec4f& direction);
 	vec4f toRealPoint(const vec4f& point);
 	vec4f toRealDirection(const vec4f& direction);
+
+	/**
+	 * Batch versions of the conversions above.  min(in.count, out.count)
+	 * elements are converted with SIMD kernels; out may be the same arrays
+	 * as in.
+	 */
+	void toVirtualPoints(const_span3f in, span3f out);
+	void toVirtualDirections(const_span3f in, span3f out);
+	void toRealPoints(const_span3f in, span3f out);
+	void toRealDirections(const_span3f in, span3f out);
 private:
+	::math::quatd _rotation; ///Rotation, applied after the scale.
+	::math::vec3d _translation; ///Translation, applied last.
+	double _scale; ///Uniform scale.
 	mat4f _matrix; ///Matrix representation of the transform.
 	mat4f _inverse; ///Matrix representation of the inverse.
+	bool _matrix_dirty; ///_matrix is out of date.
+	bool _inverse_dirty; ///_inverse is out of date.
 };
 
 }
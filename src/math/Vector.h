@@ -5,11 +5,19 @@
 #include <math.h>
 #include <iostream>
 
+#include "VectorOps.h"
+
 //template<typename T, unsigned int R, unsigned int C> struct Matrix;
 
 namespace math
 {
 
+namespace expr
+{
+template <class E, typename T, unsigned int N> struct Expression;
+template <class E, typename T, unsigned int N> void evaluate (T *r, const Expression <E, T, N> &e);
+}
+
 /**
  * Represents a mathematical N-dimensional vector.
  */
@@ -19,16 +27,12 @@ struct Vector
 	T v[N];
 
 	/** Initializes all components to zero. */
-	inline Vector<T,N>()
+	constexpr inline Vector<T,N>() : v()
 	{
-		for (unsigned int i = 0; i < N; ++i)
-		{
-			v[i] = 0;
-		}
 	}
 
 	/** Initialize the first component, set all others to zero. */
-	inline Vector<T,N>(const T x)
+	constexpr inline Vector<T,N>(const T x) : v()
 	{
 		if (N >= 1)
 		{
@@ -41,7 +45,7 @@ struct Vector
 	}
 
 	/** Initialize the first two componenst, set all others to zero. */
-	inline Vector<T,N>(const T x, const T y)
+	constexpr inline Vector<T,N>(const T x, const T y) : v()
 	{
 		if (N >= 1)
 		{
@@ -58,7 +62,7 @@ struct Vector
 	}
 
 	/** Initialize the first three components, set all others to zero. */
-	inline Vector<T,N>(const T x, const T y, const T z)
+	constexpr inline Vector<T,N>(const T x, const T y, const T z) : v()
 	{
 		if (N >= 1)
 		{
@@ -79,7 +83,7 @@ struct Vector
 	}
 
 	/** Initialize the first four components, set all others to zero. */
-	inline Vector<T,N>(const T x, const T y, const T z, const T w)
+	constexpr inline Vector<T,N>(const T x, const T y, const T z, const T w) : v()
 	{
 		if (N >= 1)
 		{
@@ -105,7 +109,7 @@ struct Vector
 
 	/** Costruct a vector from any other vector. */
 	template <typename S, unsigned int M>
-	inline Vector<T,N>(const Vector<S,M>& target)
+	constexpr inline Vector<T,N>(const Vector<S,M>& target) : v()
 	{
 		for (unsigned int i = 0; i < N && i < M; ++i)
 		{
@@ -119,7 +123,7 @@ struct Vector
 
 	/** Costruct a vector from any other vector. */
 	template <typename S>
-	inline Vector<T,N>(const S& target)
+	constexpr inline Vector<T,N>(const S& target) : v()
 	{
 		for (unsigned int i = 0; i < N; ++i)
 		{
@@ -127,104 +131,80 @@ struct Vector
 		}
 	}
 
-	inline Vector<T,N> operator+(const Vector<T,N>& right) const
+	/** Evaluate an expression template (see VectorExpression.h) in place. */
+	template <class E>
+	inline Vector<T,N>& operator=(const expr::Expression<E,T,N>& e)
+	{
+		expr::evaluate(v, e);
+		return *this;
+	}
+
+	MATH_CONSTEXPR inline Vector<T,N> operator+(const Vector<T,N>& right) const
 	{
 		Vector<T,N> result;
-		for (unsigned int i = 0; i < N; ++i)
-		{
-			result.v[i] = v[i] + right.v[i];
-		}
+		VectorOps<T,N>::add(result.v, v, right.v);
 		return result;
 	}
 
-	inline void operator+=(const Vector<T,N>& right)
+	MATH_CONSTEXPR inline void operator+=(const Vector<T,N>& right)
 	{
-		for (unsigned int i = 0; i < N; ++i)
-		{
-			v[i] += right.v[i];
-		}
+		VectorOps<T,N>::add(v, v, right.v);
 	}
 
-	inline Vector<T,N> operator-(const Vector<T,N>& right) const
+	MATH_CONSTEXPR inline Vector<T,N> operator-(const Vector<T,N>& right) const
 	{
 		Vector<T,N> result;
-		for (unsigned int i = 0; i < N; ++i)
-		{
-			result.v[i] = v[i] - right.v[i];
-		}
+		VectorOps<T,N>::sub(result.v, v, right.v);
 		return result;
 	}
 
-	inline void operator-=(const Vector<T,N>& right)
+	MATH_CONSTEXPR inline void operator-=(const Vector<T,N>& right)
 	{
-		for (unsigned int i = 0; i < N; ++i)
-		{
-			v[i] -= right.v[i];
-		}
+		VectorOps<T,N>::sub(v, v, right.v);
 	}
 
-	inline Vector<T,N> operator*(const T& right) const
+	MATH_CONSTEXPR inline Vector<T,N> operator*(const T& right) const
 	{
 		Vector<T,N> result;
-		for (unsigned int i = 0; i < N; ++i)
-		{
-			result.v[i] = v[i] * right;
-		}
+		VectorOps<T,N>::scale(result.v, v, right);
 		return result;
 	}
 
-	inline Vector <T, N> operator* (const Vector <T, N> &right) const
+	MATH_CONSTEXPR inline Vector <T, N> operator* (const Vector <T, N> &right) const
 	{
 		Vector <T, N> result;
-		for (unsigned int i = 0; i < N; ++i)
-		{
-			result.v[i] = v[i] * right[i];
-		}
-
+		VectorOps<T,N>::mul(result.v, v, right.v);
 		return result;
 	}
 
-	inline void operator*=(const T& right)
+	MATH_CONSTEXPR inline void operator*=(const T& right)
 	{
-		for (unsigned int i = 0; i < N; ++i)
-		{
-			v[i] *= right;
-		}
+		VectorOps<T,N>::scale(v, v, right);
 	}
 
-	inline Vector<T,N> operator/(const T& right) const
+	MATH_CONSTEXPR inline Vector<T,N> operator/(const T& right) const
 	{
 		Vector<T,N> result;
 		T tmp = 1 / right;
-		for (unsigned int i = 0; i < N; ++i)
-		{
-			result.v[i] = v[i] * right;
-		}
+		VectorOps<T,N>::scale(result.v, v, tmp);
 		return result;
 	}
 
-	inline Vector <T, N> operator/ (const Vector <T, N> &right) const
+	MATH_CONSTEXPR inline Vector <T, N> operator/ (const Vector <T, N> &right) const
 	{
 		Vector <T, N> result;
-		for (unsigned int i = 0; i < N; ++i)
-		{
-			result.v[i] = v[i] / right.v[i];
-		}
-
+		VectorOps<T,N>::div(result.v, v, right.v);
 		return result;
 	}
 
-	inline Vector<T,N> operator/=(const T& right)
+	MATH_CONSTEXPR inline Vector<T,N> operator/=(const T& right)
 	{
 		T tmp = 1 / right;
-		for (unsigned int i = 0; i < N; ++i)
-		{
-			v[i] *= tmp;
-		}
+		VectorOps<T,N>::scale(v, v, tmp);
 		return *this;
 	}
 
-	inline void operator=(const Vector<T,N>& right)
+	constexpr inline void operator=(const Vector<T,N>& right)
 	{
 		for (unsigned int i = 0; i < N; ++i)
 		{
@@ -234,7 +214,7 @@ struct Vector
 
 	/** Assign any vector to any other vector instantiation. */
 	template <typename S, unsigned int M>
-	inline Vector<T,N>& operator=(const Vector<S,M>& target)
+	constexpr inline Vector<T,N>& operator=(const Vector<S,M>& target)
 	{
 		for (unsigned int i = 0; i < N && i < M; ++i)
 		{
@@ -251,7 +231,7 @@ struct Vector
 
 	/** Assign vector of same type but varying size to this vector. */
 	template<unsigned int M>
-	inline void operator=(const Vector<T,M>& right)
+	constexpr inline void operator=(const Vector<T,M>& right)
 	{
 		for (unsigned int i = 0; i < N & i < M; ++i)
 		{
@@ -259,7 +239,7 @@ struct Vector
 		}
 	}
 
-	inline bool operator==(const Vector<T,N>& right) const
+	constexpr inline bool operator==(const Vector<T,N>& right) const
 	{
 		for (unsigned int i = 0; i < N; ++i)
 		{
@@ -271,7 +251,7 @@ struct Vector
 		return true;
 	}
 
-	inline bool operator!= (const Vector <T, N> &right) const
+	constexpr inline bool operator!= (const Vector <T, N> &right) const
 	{
 		for (unsigned int i = 0; i < N; ++i)
 		{
@@ -285,7 +265,7 @@ struct Vector
 	}
 
 	/*template<unsigned int C>
-	inline Vector<T, C> operator*(const Matrix<T, N, C>& right) const
+	constexpr inline Vector<T, C> operator*(const Matrix<T, N, C>& right) const
 	{
 		Vector<T, C> result;
 		for (unsigned int i = 0; i < N; ++i)
@@ -295,67 +275,67 @@ struct Vector
 		return result;
 	}*/
 
-	inline T& x()
+	constexpr inline T& x()
 	{
 		return v[0];
 	}
 
-	inline T& y()
+	constexpr inline T& y()
 	{
 		return v[1];
 	}
 
-	inline T& z()
+	constexpr inline T& z()
 	{
 		return v[2];
 	}
 
-	inline T& w()
+	constexpr inline T& w()
 	{
 		return v[3];
 	}
 
-	inline T x() const
+	constexpr inline T x() const
 	{
 		return v[0];
 	}
 
-	inline T y() const
+	constexpr inline T y() const
 	{
 		return v[1];
 	}
 
-	inline T z() const
+	constexpr inline T z() const
 	{
 		return v[2];
 	}
 
-	inline T w() const
+	constexpr inline T w() const
 	{
 		return v[3];
 	}
 
-	inline T& r()
+	constexpr inline T& r()
 	{
 		return x();
 	}
 
-	inline T& g()
+	constexpr inline T& g()
 	{
 		return y();
 	}
 
-	inline T& b()
+	constexpr inline T& b()
 	{
 		return z();
 	}
 
-	inline T& a()
+	constexpr inline T& a()
 	{
 		return w();
 	}
 
-	inline Vector <T, 2> xy (void)
+	constexpr inline Vector <T, 2> xy (void)
 	{
 		Vector <T, 2> result;
 		if (N >= 2)
@@ -372,7 +352,7 @@ struct Vector
 		return result;
 	}
 
-	inline Vector <T, 2> xz (void)
+	constexpr inline Vector <T, 2> xz (void)
 	{
 		Vector <T, 2> result;
 		if (N >= 3)
@@ -389,7 +369,7 @@ struct Vector
 		return result;
 	}
 
-	inline Vector <T, 2> yz (void)
+	constexpr inline Vector <T, 2> yz (void)
 	{
 		Vector <T, 2> result;
 		if (N >= 3)
@@ -406,7 +386,7 @@ struct Vector
 		return result;
 	}
 
-	inline Vector <T, 2> yx (void)
+	constexpr inline Vector <T, 2> yx (void)
 	{
 		Vector <T, 2> result;
 		if (N >= 2)
@@ -423,7 +403,7 @@ struct Vector
 		return result;
 	}
 
-	inline Vector <T, 2> zx (void)
+	constexpr inline Vector <T, 2> zx (void)
 	{
 		Vector <T, 2> result;
 		if (N >= 3)
@@ -440,7 +420,7 @@ struct Vector
 		return result;
 	}
 
-	inline Vector <T, 2> zy (void)
+	constexpr inline Vector <T, 2> zy (void)
 	{
 		Vector <T, 2> result;
 		if (N >= 3)
@@ -457,7 +437,7 @@ struct Vector
 		return result;
 	}
 
-	inline Vector <T, 3> xyz (void)
+	constexpr inline Vector <T, 3> xyz (void)
 	{
 		Vector <T, 3> result;
 		if (N >= 3)
@@ -476,7 +456,7 @@ struct Vector
 		return result;
 	}
 
-	inline Vector <T, 3> yxz (void)
+	constexpr inline Vector <T, 3> yxz (void)
 	{
 		Vector <T, 3> result;
 		if (N >= 3)
@@ -495,7 +475,7 @@ struct Vector
 		return result;
 	}
 
-	inline Vector <T, 3> zxy (void)
+	constexpr inline Vector <T, 3> zxy (void)
 	{
 		Vector <T, 3> result;
 		if (N >= 3)
@@ -514,7 +494,7 @@ struct Vector
 		return result;
 	}
 
-	inline Vector <T, 3> zyx (void)
+	constexpr inline Vector <T, 3> zyx (void)
 	{
 		Vector <T, 3> result;
 		if (N >= 3)
@@ -533,7 +513,7 @@ struct Vector
 		return result;
 	}
 
-	inline Vector <T, 4> xyzw (void)
+	constexpr inline Vector <T, 4> xyzw (void)
 	{
 		Vector <T, 4> result;
 		if (N >= 4)
@@ -554,18 +534,18 @@ struct Vector
 		return result;
 	}
 
-	inline T& operator[](int i)
+	constexpr inline T& operator[](int i)
 	{
 		return v[i];
 	}
 
-	inline T operator[](int i) const
+	constexpr inline T operator[](int i) const
 	{
 		return v[i];
 	}
 
 	/** Set all of the components to zero. */
-	static inline Vector<T,N> zero()
+	static constexpr inline Vector<T,N> zero()
 	{
 		Vector<T,N> result;
 		for (unsigned int i = 0; i < N; ++i)
@@ -576,7 +556,7 @@ struct Vector
 	}
 
 	/** Set all of the components to one. */
-	static inline Vector<T,N> one()
+	static constexpr inline Vector<T,N> one()
 	{
 		Vector<T,N> result;
 		for (unsigned int i = 0; i < N; ++i)
@@ -606,45 +586,31 @@ std::ostream& operator<<(std::ostream& out, const Vector<T, N>& p)
 template <typename T, unsigned int N>
 inline T length(const Vector <T, N> &vec) 
 {
-	T l = (T)0;
-	for (unsigned int i = 0; i < N; ++i)
-	{
-		l += vec.v[i] * vec.v[i];
-	}
-	return (T) sqrt(l);
+	return (T) sqrt(VectorOps<T,N>::dot(vec.v, vec.v));
 }
 
 template <typename T, unsigned int N>
-inline T length2(const Vector <T, N> &vec) 
+MATH_CONSTEXPR inline T length2(const Vector <T, N> &vec) 
 {
-	T l = (T)0;
-	for (unsigned int i = 0; i < N; ++i)
-	{
-		l += vec.v[i] * vec.v[i];
-	}
-	return (T) l;
+	return VectorOps<T,N>::dot(vec.v, vec.v);
 }
 
 template <typename T, unsigned int N>
 inline Vector <T, N> normalize (const Vector <T, N> &vec) 
 {
-	Vector <T, N> tmp (vec);
-	return tmp /= length (tmp);
+	Vector <T, N> result;
+	VectorOps<T,N>::normalize(result.v, vec.v);
+	return result;
 }
 
 template <typename T, unsigned int N>
-inline T dot(const Vector <T, N> &left, const Vector<T, N> &right) 
+MATH_CONSTEXPR inline T dot(const Vector <T, N> &left, const Vector<T, N> &right) 
 {
-	T result = 0;
-	for (unsigned int i = 0; i < N; ++i)
-	{
-		result += (left.v[i] * right.v[i]);
-	}
-	return result;
+	return VectorOps<T,N>::dot(left.v, right.v);
 }
 
 template <typename T>
-inline Vector<T,3> cross(const Vector <T, 3> &left, const Vector<T,3> &right) 
+constexpr inline Vector<T,3> cross(const Vector <T, 3> &left, const Vector<T,3> &right) 
 {
 	Vector<T,3>	result;
 	result.x() = left.y() * right.z() - right.y() * left.z();
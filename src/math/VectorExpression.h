@@ -0,0 +1,228 @@
+#pragma once
+
+/**
+ * Optional expression templates for math::Vector.
+ *
+ * Wrapping an operand in math::lazy () turns the arithmetic that follows
+ * into an expression tree which is only evaluated, element by element in a
+ * single unrolled loop, when it is assigned to a Vector:
+ *
+ *    t = (math::lazy (edge1) * s - math::lazy (edge2) * u) * det;
+ *
+ * No intermediate Vector is created or zero-initialized.  Each element goes
+ * through the same operations in the same order as the eager operators, so
+ * the results are identical.  Expressions hold pointers to their Vector
+ * operands: evaluate them within the full expression that built them and do
+ * not store them.
+ */
+
+#include "Vector.h"
+
+namespace math
+{
+
+namespace expr
+{
+
+/**
+  * Keeps scalar operands out of template argument deduction so that, as with
+  * the eager operators, any value convertible to T may be used.
+  */
+template <typename T>
+struct Identity
+{
+	typedef T type;
+};
+
+/**
+  * CRTP base of every expression node.
+  */
+template <class E, typename T, unsigned int N>
+struct Expression
+{
+	inline const E &self (void) const { return static_cast <const E &> (*this); }
+	inline T operator[] (unsigned int i) const { return self ()[i]; }
+};
+
+/**
+  * A Vector operand.
+  */
+template <typename T, unsigned int N>
+struct Leaf : public Expression <Leaf <T, N>, T, N>
+{
+	explicit Leaf (const Vector <T, N> &vec) : m_v (vec.v) {}
+	inline T operator[] (unsigned int i) const { return m_v[i]; }
+
+	const T *m_v;
+};
+
+struct Add { template <typename T> static inline T apply (T a, T b) { return a + b; } };
+struct Sub { template <typename T> static inline T apply (T a, T b) { return a - b; } };
+struct Mul { template <typename T> static inline T apply (T a, T b) { return a * b; } };
+struct Div { template <typename T> static inline T apply (T a, T b) { return a / b; } };
+
+/**
+  * Element-wise operation between two expressions.
+  */
+template <class L, class R, class Op, typename T, unsigned int N>
+struct Binary : public Expression <Binary <L, R, Op, T, N>, T, N>
+{
+	Binary (const L &left, const R &right) : m_left (left), m_right (right) {}
+	inline T operator[] (unsigned int i) const { return Op::apply (m_left[i], m_right[i]); }
+
+	L m_left;
+	R m_right;
+};
+
+/**
+  * Operation between every element of an expression and a scalar.  The
+  * expression is always the left operand of Op.
+  */
+template <class L, class Op, typename T, unsigned int N>
+struct Scalar : public Expression <Scalar <L, Op, T, N>, T, N>
+{
+	Scalar (const L &left, T right) : m_left (left), m_right (right) {}
+	inline T operator[] (unsigned int i) const { return Op::apply (m_left[i], m_right); }
+
+	L m_left;
+	T m_right;
+};
+
+template <class L, typename T, unsigned int N>
+struct Negate : public Expression <Negate <L, T, N>, T, N>
+{
+	explicit Negate (const L &left) : m_left (left) {}
+	inline T operator[] (unsigned int i) const { return -m_left[i]; }
+
+	L m_left;
+};
+
+/**
+  * Unrolled element loop used to evaluate an expression.
+  */
+template <unsigned int I, unsigned int N>
+struct Unroll
+{
+	template <class E, typename T>
+	static inline void assign (T *r, const E &e)
+	{
+		r[I] = e[I];
+		Unroll <I + 1, N>::assign (r, e);
+	}
+};
+
+template <unsigned int N>
+struct Unroll <N, N>
+{
+	template <class E, typename T>
+	static inline void assign (T *, const E &)
+	{
+	}
+};
+
+/**
+  * Write every element of e to r.  Every operation is element-wise, so r
+  * may be one of the Vectors referenced by e.
+  */
+template <class E, typename T, unsigned int N>
+inline void evaluate (T *r, const Expression <E, T, N> &e)
+{
+	Unroll <0, N>::assign (r, e.self ());
+}
+
+// Element-wise operators between expressions and Vectors.  A Vector operand
+// mixed with an expression is wrapped in a Leaf.  The operators live in
+// math::expr so that argument dependent lookup finds them from any namespace.
+#define MATH_EXPRESSION_OPERATOR(OP, NAME)                                                      \
+template <class L, class R, typename T, unsigned int N>                                         \
+inline Binary <L, R, NAME, T, N>                                                                \
+operator OP (const Expression <L, T, N> &left, const Expression <R, T, N> &right)               \
+{                                                                                               \
+	return Binary <L, R, NAME, T, N> (left.self (), right.self ());                             \
+}                                                                                               \
+                                                                                                \
+template <class L, typename T, unsigned int N>                                                  \
+inline Binary <L, Leaf <T, N>, NAME, T, N>                                                      \
+operator OP (const Expression <L, T, N> &left, const Vector <T, N> &right)                      \
+{                                                                                               \
+	return Binary <L, Leaf <T, N>, NAME, T, N> (left.self (), Leaf <T, N> (right));             \
+}                                                                                               \
+                                                                                                \
+template <class R, typename T, unsigned int N>                                                  \
+inline Binary <Leaf <T, N>, R, NAME, T, N>                                                      \
+operator OP (const Vector <T, N> &left, const Expression <R, T, N> &right)                      \
+{                                                                                               \
+	return Binary <Leaf <T, N>, R, NAME, T, N> (Leaf <T, N> (left), right.self ());             \
+}
+
+MATH_EXPRESSION_OPERATOR(+, Add)
+MATH_EXPRESSION_OPERATOR(-, Sub)
+MATH_EXPRESSION_OPERATOR(*, Mul)
+MATH_EXPRESSION_OPERATOR(/, Div)
+
+#undef MATH_EXPRESSION_OPERATOR
+
+template <class L, typename T, unsigned int N>
+inline Scalar <L, Mul, T, N> operator* (const Expression <L, T, N> &left, const typename Identity <T>::type right)
+{
+	return Scalar <L, Mul, T, N> (left.self (), right);
+}
+
+template <class R, typename T, unsigned int N>
+inline Scalar <R, Mul, T, N> operator* (const typename Identity <T>::type left, const Expression <R, T, N> &right)
+{
+	return Scalar <R, Mul, T, N> (right.self (), left);
+}
+
+template <class L, typename T, unsigned int N>
+inline Scalar <L, Div, T, N> operator/ (const Expression <L, T, N> &left, const typename Identity <T>::type right)
+{
+	return Scalar <L, Div, T, N> (left.self (), right);
+}
+
+template <class L, typename T, unsigned int N>
+inline Negate <L, T, N> operator- (const Expression <L, T, N> &left)
+{
+	return Negate <L, T, N> (left.self ());
+}
+
+/**
+  * Dot product of two expressions without evaluating either into a Vector.
+  * Summed in index order, like the scalar VectorOps::dot.
+  */
+template <class L, class R, typename T, unsigned int N>
+inline T dot (const Expression <L, T, N> &left, const Expression <R, T, N> &right)
+{
+	T result = 0;
+	for (unsigned int i = 0; i < N; ++i)
+	{
+		result += left.self ()[i] * right.self ()[i];
+	}
+	return result;
+}
+
+}
+
+using expr::dot;
+
+/**
+  * Start an expression from a Vector.
+  */
+template <typename T, unsigned int N>
+inline expr::Leaf <T, N> lazy (const Vector <T, N> &vec)
+{
+	return expr::Leaf <T, N> (vec);
+}
+
+/**
+  * Evaluate an expression into a Vector.  Useful where a function such as
+  * normalize () needs a real Vector argument.
+  */
+template <class E, typename T, unsigned int N>
+inline Vector <T, N> eval (const expr::Expression <E, T, N> &e)
+{
+	Vector <T, N> result (e.self ());
+	return result;
+}
+
+}
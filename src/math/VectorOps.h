@@ -0,0 +1,257 @@
+#pragma once
+
+/**
+ * Element-wise kernels used by math::Vector.
+ *
+ * VectorOpsScalar<T, N> runs plain loops and is what VectorOps<T, N> uses by
+ * default.  When SSE is available at
+ * compile time (any x86-64 target) VectorOps<float, 4> is specialized with
+ * SSE intrinsics.  float3 stays on the scalar loops: packing three floats in
+ * and out of a register measured slower than the loops the compiler already
+ * keeps in registers.  Define MATH_NO_SIMD to force the scalar kernels
+ * everywhere.
+ *
+ * Everything here is constexpr where the compiler allows it.  The SIMD
+ * kernels detect constant evaluation (MATH_CONSTANT_EVALUATED) and fall back
+ * to the scalar loops at compile time, so Vector and Matrix arithmetic can
+ * be used in constant expressions while still running the SIMD code at run
+ * time.  MATH_CONSTEXPR expands to constexpr only when that detection is
+ * available.
+ */
+
+#include <math.h>
+
+#if !defined(MATH_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+#define MATH_USE_SSE 1
+#include <xmmintrin.h>
+#endif
+
+#if defined(__clang__)
+#  if defined(__has_builtin)
+#    if __has_builtin(__builtin_is_constant_evaluated)
+#      define MATH_HAS_CONSTANT_EVALUATED 1
+#    endif
+#  endif
+#elif defined(__GNUC__) && __GNUC__ >= 9
+#  define MATH_HAS_CONSTANT_EVALUATED 1
+#endif
+
+#ifdef MATH_HAS_CONSTANT_EVALUATED
+#define MATH_CONSTEXPR constexpr
+#define MATH_CONSTANT_EVALUATED() __builtin_is_constant_evaluated ()
+#else
+#define MATH_CONSTEXPR
+#define MATH_CONSTANT_EVALUATED() false
+#endif
+
+// Fully unroll the per-component loops.  GCC leaves N = 3 rolled at -O2,
+// which keeps every result in a stack temporary.
+#if defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 8)
+#define MATH_UNROLL _Pragma ("GCC unroll 4")
+#else
+#define MATH_UNROLL
+#endif
+
+namespace math
+{
+
+template <typename T, unsigned int N>
+struct VectorOpsScalar
+{
+	static constexpr inline void zero (T *r)
+	{
+		MATH_UNROLL
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			r[i] = 0;
+		}
+	}
+
+	static constexpr inline void add (T *r, const T *a, const T *b)
+	{
+		MATH_UNROLL
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			r[i] = a[i] + b[i];
+		}
+	}
+
+	static constexpr inline void sub (T *r, const T *a, const T *b)
+	{
+		MATH_UNROLL
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			r[i] = a[i] - b[i];
+		}
+	}
+
+	static constexpr inline void mul (T *r, const T *a, const T *b)
+	{
+		MATH_UNROLL
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			r[i] = a[i] * b[i];
+		}
+	}
+
+	static constexpr inline void div (T *r, const T *a, const T *b)
+	{
+		MATH_UNROLL
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			r[i] = a[i] / b[i];
+		}
+	}
+
+	static constexpr inline void scale (T *r, const T *a, const T s)
+	{
+		MATH_UNROLL
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			r[i] = a[i] * s;
+		}
+	}
+
+	static constexpr inline T dot (const T *a, const T *b)
+	{
+		T result = 0;
+		MATH_UNROLL
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			result += a[i] * b[i];
+		}
+		return result;
+	}
+
+	static inline void normalize (T *r, const T *a)
+	{
+		const T s = 1 / (T) sqrt (dot (a, a));
+		MATH_UNROLL
+		for (unsigned int i = 0; i < N; ++i)
+		{
+			r[i] = a[i] * s;
+		}
+	}
+};
+
+template <typename T, unsigned int N>
+struct VectorOps : public VectorOpsScalar <T, N>
+{
+};
+
+#ifdef MATH_USE_SSE
+
+namespace sse
+{
+
+/** Store the low three lanes without touching p[3]. */
+inline void store3 (float *p, __m128 v)
+{
+	_mm_storel_pi ((__m64 *)p, v);
+	_mm_store_ss (p + 2, _mm_movehl_ps (v, v));
+}
+
+/** Sum of all four lanes. */
+inline float hsum (__m128 v)
+{
+	__m128 s = _mm_add_ps (v, _mm_movehl_ps (v, v));
+	s = _mm_add_ss (s, _mm_shuffle_ps (s, s, _MM_SHUFFLE (1, 1, 1, 1)));
+	return _mm_cvtss_f32 (s);
+}
+
+}
+
+template <>
+struct VectorOps <float, 4>
+{
+	static MATH_CONSTEXPR inline void zero (float *r)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			VectorOpsScalar <float, 4>::zero (r);
+			return;
+		}
+
+		_mm_storeu_ps (r, _mm_setzero_ps ());
+	}
+
+	static MATH_CONSTEXPR inline void add (float *r, const float *a, const float *b)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			VectorOpsScalar <float, 4>::add (r, a, b);
+			return;
+		}
+
+		_mm_storeu_ps (r, _mm_add_ps (_mm_loadu_ps (a), _mm_loadu_ps (b)));
+	}
+
+	static MATH_CONSTEXPR inline void sub (float *r, const float *a, const float *b)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			VectorOpsScalar <float, 4>::sub (r, a, b);
+			return;
+		}
+
+		_mm_storeu_ps (r, _mm_sub_ps (_mm_loadu_ps (a), _mm_loadu_ps (b)));
+	}
+
+	static MATH_CONSTEXPR inline void mul (float *r, const float *a, const float *b)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			VectorOpsScalar <float, 4>::mul (r, a, b);
+			return;
+		}
+
+		_mm_storeu_ps (r, _mm_mul_ps (_mm_loadu_ps (a), _mm_loadu_ps (b)));
+	}
+
+	static MATH_CONSTEXPR inline void div (float *r, const float *a, const float *b)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			VectorOpsScalar <float, 4>::div (r, a, b);
+			return;
+		}
+
+		_mm_storeu_ps (r, _mm_div_ps (_mm_loadu_ps (a), _mm_loadu_ps (b)));
+	}
+
+	static MATH_CONSTEXPR inline void scale (float *r, const float *a, const float s)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			VectorOpsScalar <float, 4>::scale (r, a, s);
+			return;
+		}
+
+		_mm_storeu_ps (r, _mm_mul_ps (_mm_loadu_ps (a), _mm_set1_ps (s)));
+	}
+
+	static MATH_CONSTEXPR inline float dot (const float *a, const float *b)
+	{
+		if (MATH_CONSTANT_EVALUATED ())
+		{
+			return VectorOpsScalar <float, 4>::dot (a, b);
+		}
+
+		return sse::hsum (_mm_mul_ps (_mm_loadu_ps (a), _mm_loadu_ps (b)));
+	}
+
+	static inline void normalize (float *r, const float *a)
+	{
+		// The squared length ends up in every lane, so the vector never
+		// leaves its register.
+		__m128 v = _mm_loadu_ps (a);
+		__m128 d = _mm_mul_ps (v, v);
+		d = _mm_add_ps (d, _mm_shuffle_ps (d, d, _MM_SHUFFLE (2, 3, 0, 1)));
+		d = _mm_add_ps (d, _mm_shuffle_ps (d, d, _MM_SHUFFLE (1, 0, 3, 2)));
+		_mm_storeu_ps (r, _mm_mul_ps (v, _mm_div_ps (_mm_set1_ps (1.0f), _mm_sqrt_ps (d))));
+	}
+};
+
+#endif
+
+}
@@ -0,0 +1,299 @@
+/*
+   Filename : BoundingVolumeHierarchy.cpp
+   Version  : 1.0
+
+   Purpose  : Dynamic bounding volume hierarchy of axis aligned boxes.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include "BoundingVolumeHierarchy.h"
+#include <algorithm>
+
+namespace
+{
+
+inline math::vec3f minimum (const math::vec3f &a, const math::vec3f &b)
+{
+	return math::vec3f (std::min (a[0], b[0]), std::min (a[1], b[1]), std::min (a[2], b[2]));
+}
+
+inline math::vec3f maximum (const math::vec3f &a, const math::vec3f &b)
+{
+	return math::vec3f (std::max (a[0], b[0]), std::max (a[1], b[1]), std::max (a[2], b[2]));
+}
+
+/**
+  * Half the surface area of a box, the insertion cost.
+  */
+inline float area (const math::vec3f &min, const math::vec3f &max)
+{
+	math::vec3f d = max - min;
+	return d[0] * d[1] + d[1] * d[2] + d[2] * d[0];
+}
+
+inline bool contains (const math::vec3f &outer_min, const math::vec3f &outer_max,
+                      const math::vec3f &min, const math::vec3f &max)
+{
+	return outer_min[0] <= min[0] && outer_min[1] <= min[1] && outer_min[2] <= min[2] &&
+	       max[0] <= outer_max[0] && max[1] <= outer_max[1] && max[2] <= outer_max[2];
+}
+
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy (float margin)
+	: m_root (-1),
+	  m_free (-1),
+	  m_margin (margin)
+{
+}
+
+int BoundingVolumeHierarchy::insert (const math::vec3f &min, const math::vec3f &max, void *data)
+{
+	int leaf = allocate ();
+	math::vec3f margin (m_margin, m_margin, m_margin);
+	m_nodes[leaf].min = min - margin;
+	m_nodes[leaf].max = max + margin;
+	m_nodes[leaf].data = data;
+	m_nodes[leaf].height = 0;
+	insertLeaf (leaf);
+	return leaf;
+}
+
+void BoundingVolumeHierarchy::remove (int proxy)
+{
+	removeLeaf (proxy);
+	release (proxy);
+}
+
+bool BoundingVolumeHierarchy::move (int proxy, const math::vec3f &min, const math::vec3f &max)
+{
+	if (contains (m_nodes[proxy].min, m_nodes[proxy].max, min, max))
+	{
+		return false;
+	}
+
+	removeLeaf (proxy);
+	math::vec3f margin (m_margin, m_margin, m_margin);
+	m_nodes[proxy].min = min - margin;
+	m_nodes[proxy].max = max + margin;
+	insertLeaf (proxy);
+	return true;
+}
+
+void *BoundingVolumeHierarchy::getData (int proxy) const
+{
+	return m_nodes[proxy].data;
+}
+
+int BoundingVolumeHierarchy::getHeight (void) const
+{
+	return m_root == -1 ? 0 : m_nodes[m_root].height + 1;
+}
+
+int BoundingVolumeHierarchy::allocate (void)
+{
+	int node;
+	if (m_free != -1)
+	{
+		node = m_free;
+		m_free = m_nodes[node].parent;
+	}
+	else
+	{
+		node = (int)m_nodes.size ();
+		m_nodes.push_back (Node ());
+	}
+
+	m_nodes[node].data = NULL;
+	m_nodes[node].parent = -1;
+	m_nodes[node].child[0] = -1;
+	m_nodes[node].child[1] = -1;
+	m_nodes[node].height = 0;
+	return node;
+}
+
+void BoundingVolumeHierarchy::release (int node)
+{
+	m_nodes[node].parent = m_free;
+	m_nodes[node].height = -1;
+	m_free = node;
+}
+
+void BoundingVolumeHierarchy::insertLeaf (int leaf)
+{
+	if (m_root == -1)
+	{
+		m_root = leaf;
+		m_nodes[leaf].parent = -1;
+		return;
+	}
+
+	// Walk down to the sibling that grows the total area the least.
+	math::vec3f leaf_min = m_nodes[leaf].min;
+	math::vec3f leaf_max = m_nodes[leaf].max;
+	int index = m_root;
+	while (!m_nodes[index].isLeaf ())
+	{
+		const Node &node = m_nodes[index];
+		float node_area = area (node.min, node.max);
+		float combined_area = area (minimum (node.min, leaf_min), maximum (node.max, leaf_max));
+
+		// Cost of making the leaf and this node siblings, and the cost every
+		// child pays for the growth of this node.
+		float cost = 2.0f * combined_area;
+		float inherited = 2.0f * (combined_area - node_area);
+
+		float child_cost[2];
+		for (int i = 0; i < 2; ++i)
+		{
+			const Node &child = m_nodes[node.child[i]];
+			float grown = area (minimum (child.min, leaf_min), maximum (child.max, leaf_max));
+			child_cost[i] = (child.isLeaf () ? grown : grown - area (child.min, child.max)) + inherited;
+		}
+
+		if (cost < child_cost[0] && cost < child_cost[1])
+		{
+			break;
+		}
+		index = child_cost[0] < child_cost[1] ? node.child[0] : node.child[1];
+	}
+
+	int sibling = index;
+	int old_parent = m_nodes[sibling].parent;
+	int new_parent = allocate ();
+	m_nodes[new_parent].parent = old_parent;
+	m_nodes[new_parent].min = minimum (leaf_min, m_nodes[sibling].min);
+	m_nodes[new_parent].max = maximum (leaf_max, m_nodes[sibling].max);
+	m_nodes[new_parent].height = m_nodes[sibling].height + 1;
+	m_nodes[new_parent].child[0] = sibling;
+	m_nodes[new_parent].child[1] = leaf;
+	m_nodes[sibling].parent = new_parent;
+	m_nodes[leaf].parent = new_parent;
+
+	if (old_parent != -1)
+	{
+		int side = m_nodes[old_parent].child[0] == sibling ? 0 : 1;
+		m_nodes[old_parent].child[side] = new_parent;
+	}
+	else
+	{
+		m_root = new_parent;
+	}
+
+	refit (new_parent);
+}
+
+void BoundingVolumeHierarchy::removeLeaf (int leaf)
+{
+	if (leaf == m_root)
+	{
+		m_root = -1;
+		return;
+	}
+
+	int parent = m_nodes[leaf].parent;
+	int grand_parent = m_nodes[parent].parent;
+	int sibling = m_nodes[parent].child[0] == leaf ? m_nodes[parent].child[1] : m_nodes[parent].child[0];
+
+	if (grand_parent != -1)
+	{
+		int side = m_nodes[grand_parent].child[0] == parent ? 0 : 1;
+		m_nodes[grand_parent].child[side] = sibling;
+		m_nodes[sibling].parent = grand_parent;
+		release (parent);
+		refit (grand_parent);
+	}
+	else
+	{
+		m_root = sibling;
+		m_nodes[sibling].parent = -1;
+		release (parent);
+	}
+}
+
+/**
+  * Rebalance and refit every node from node up to the root.
+  */
+void BoundingVolumeHierarchy::refit (int node)
+{
+	while (node != -1)
+	{
+		node = balance (node);
+
+		Node &current = m_nodes[node];
+		const Node &left = m_nodes[current.child[0]];
+		const Node &right = m_nodes[current.child[1]];
+		current.height = 1 + std::max (left.height, right.height);
+		current.min = minimum (left.min, right.min);
+		current.max = maximum (left.max, right.max);
+
+		node = current.parent;
+	}
+}
+
+/**
+  * If one child of a is more than one level taller than the other, rotate
+  * it up to take a's place.  Returns the node now at a's position.
+  */
+int BoundingVolumeHierarchy::balance (int a)
+{
+	Node &A = m_nodes[a];
+	if (A.isLeaf () || A.height < 2)
+	{
+		return a;
+	}
+
+	int b = A.child[0];
+	int c = A.child[1];
+	Node &B = m_nodes[b];
+	Node &C = m_nodes[c];
+	int difference = C.height - B.height;
+
+	// Rotate up the taller child, x, whose children are x0 and x1; the other
+	// child of a is y.
+	if (difference > 1 || difference < -1)
+	{
+		int x = difference > 1 ? c : b;
+		int x_side = difference > 1 ? 1 : 0;
+		Node &X = m_nodes[x];
+		Node &Y = m_nodes[difference > 1 ? b : c];
+		int x0 = X.child[0];
+		int x1 = X.child[1];
+		Node &X0 = m_nodes[x0];
+		Node &X1 = m_nodes[x1];
+
+		// x takes a's place and a becomes x's first child.
+		X.child[0] = a;
+		X.parent = A.parent;
+		A.parent = x;
+		if (X.parent != -1)
+		{
+			Node &parent = m_nodes[X.parent];
+			parent.child[parent.child[0] == a ? 0 : 1] = x;
+		}
+		else
+		{
+			m_root = x;
+		}
+
+		// The taller grandchild stays with x, the other moves to a.
+		int keep = X0.height > X1.height ? x0 : x1;
+		int give = X0.height > X1.height ? x1 : x0;
+		X.child[1] = keep;
+		A.child[x_side] = give;
+		m_nodes[give].parent = a;
+
+		A.min = minimum (Y.min, m_nodes[give].min);
+		A.max = maximum (Y.max, m_nodes[give].max);
+		A.height = 1 + std::max (Y.height, m_nodes[give].height);
+		X.min = minimum (A.min, m_nodes[keep].min);
+		X.max = maximum (A.max, m_nodes[keep].max);
+		X.height = 1 + std::max (A.height, m_nodes[keep].height);
+		return x;
+	}
+
+	return a;
+}
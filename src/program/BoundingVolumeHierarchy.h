@@ -0,0 +1,158 @@
+/*
+   Filename : BoundingVolumeHierarchy.h
+   Version  : 1.0
+
+   Purpose  : Dynamic bounding volume hierarchy of axis aligned boxes, used
+              to cull the scene.  Leaves are stored with a small margin so
+              that objects moving a little do not touch the tree, and the
+              tree is kept balanced with rotations as leaves come and go.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#pragma once
+
+#include <Vector.h>
+#include <Frustum.h>
+#include <vector>
+#include <utility>
+
+class BoundingVolumeHierarchy
+{
+	public:
+
+		/**
+		  * Constructor.
+		  * @param margin Distance leaf boxes are grown by on every side.
+		  */
+		explicit BoundingVolumeHierarchy (float margin = 0.1f);
+
+		/**
+		  * Add a box and return its proxy id.
+		  * @param data Pointer returned for the box by cull ().
+		  */
+		int insert (const math::vec3f &min, const math::vec3f &max, void *data);
+
+		/**
+		  * Remove a box by its proxy id.
+		  */
+		void remove (int proxy);
+
+		/**
+		  * Move a box.  Returns true if the tree had to change, false if the
+		  * new box still fits in the grown one.
+		  */
+		bool move (int proxy, const math::vec3f &min, const math::vec3f &max);
+
+		/**
+		  * Get the data pointer of a box.
+		  */
+		void *getData (int proxy) const;
+
+		/**
+		  * Call visit (data) for every box that is at least partially inside
+		  * the frustum.  Subtrees completely inside the frustum are taken
+		  * without testing their boxes, and subtrees inside some of the planes
+		  * skip those planes.  Returns the number of boxes visited.
+		  */
+		template <class Visitor>
+		size_t cull (const gfx::Frustum &frustum, Visitor &visit) const;
+
+		/**
+		  * Get the height of the tree, 0 when empty.
+		  */
+		int getHeight (void) const;
+
+	private:
+
+		struct Node
+		{
+			math::vec3f min;
+			math::vec3f max;
+			void *data;
+			int parent;		// Parent node, or the next free node.
+			int child[2];
+			int height;		// Leaves are 0, free nodes -1.
+
+			inline bool isLeaf (void) const { return child[0] == -1; }
+		};
+
+		int allocate (void);
+		void release (int node);
+		void insertLeaf (int leaf);
+		void removeLeaf (int leaf);
+		int balance (int node);
+		void refit (int node);
+
+		std::vector <Node> m_nodes;
+		int m_root;
+		int m_free;
+		float m_margin;
+};
+
+template <class Visitor>
+size_t BoundingVolumeHierarchy::cull (const gfx::Frustum &frustum, Visitor &visit) const
+{
+	if (m_root == -1)
+	{
+		return 0;
+	}
+
+	// Each entry carries the planes its parent was not completely inside.
+	// The tree is kept balanced, so the fixed stack only overflows for
+	// enormous scenes.
+	std::pair <int, unsigned int> stack[64];
+	std::vector <std::pair <int, unsigned int> > overflow;
+	int top = 0;
+	size_t count = 0;
+	stack[top++] = std::make_pair (m_root, (unsigned int)gfx::Frustum::ALL_PLANES);
+
+	while (top > 0 || overflow.size ())
+	{
+		std::pair <int, unsigned int> entry;
+		if (overflow.size ())
+		{
+			entry = overflow.back ();
+			overflow.pop_back ();
+		}
+		else
+		{
+			entry = stack[--top];
+		}
+
+		const Node &node = m_nodes[entry.first];
+		unsigned int mask = entry.second;
+		if (mask)
+		{
+			math::vec3f center = (node.min + node.max) * 0.5f;
+			math::vec3f extent = (node.max - node.min) * 0.5f;
+			if (frustum.isVisible (center, extent, mask) == gfx::Frustum::NONE)
+			{
+				continue;
+			}
+		}
+
+		if (node.isLeaf ())
+		{
+			visit (node.data);
+			++count;
+			continue;
+		}
+
+		for (int i = 0; i < 2; ++i)
+		{
+			if (top < 64)
+			{
+				stack[top++] = std::make_pair (node.child[i], mask);
+			}
+			else
+			{
+				overflow.push_back (std::make_pair (node.child[i], mask));
+			}
+		}
+	}
+
+	return count;
+}
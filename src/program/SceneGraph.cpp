@@ -0,0 +1,326 @@
+/*
+   Filename : SceneGraph.cpp
+   Version  : 1.0
+
+   Purpose  : Lightweight scene graph with bounding volume hierarchy culling.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include "SceneGraph.h"
+#include <GL/glew.h>
+#include <algorithm>
+#include <math.h>
+
+namespace
+{
+
+/**
+  * Visitor for BoundingVolumeHierarchy::cull () collecting scene nodes.
+  */
+struct CollectNodes
+{
+	explicit CollectNodes (std::vector <SceneNode *> &nodes) : m_nodes (nodes) {}
+	inline void operator() (void *data) { m_nodes.push_back (static_cast <SceneNode *> (data)); }
+
+	std::vector <SceneNode *> &m_nodes;
+};
+
+/**
+  * Transform the box (min, max) by the OpenGL layout matrix m and return
+  * the box around the result.
+  */
+void transformBounds (const math::Matrixf &m, const math::vec3f &min, const math::vec3f &max,
+                      math::vec3f &out_min, math::vec3f &out_max)
+{
+	const float *data = m.data ();
+	math::vec3f center = (min + max) * 0.5f;
+	math::vec3f extent = (max - min) * 0.5f;
+	for (int r = 0; r < 3; ++r)
+	{
+		float c = data[12 + r];
+		float e = 0.0f;
+		for (int k = 0; k < 3; ++k)
+		{
+			c += data[k * 4 + r] * center[k];
+			e += fabsf (data[k * 4 + r]) * extent[k];
+		}
+		out_min[r] = c - e;
+		out_max[r] = c + e;
+	}
+}
+
+}
+
+SceneNode::SceneNode (void)
+	: m_graph (NULL),
+	  m_parent (NULL),
+	  m_has_bounds (false),
+	  m_dirty (false),
+	  m_proxy (-1)
+{
+}
+
+SceneNode::~SceneNode (void)
+{
+	if (m_graph)
+	{
+		m_graph->detach (*this);
+	}
+
+	for (size_t i = 0; i < m_children.size (); ++i)
+	{
+		m_children[i]->m_parent = NULL;
+	}
+}
+
+void SceneNode::setLocalTransform (const math::Matrixf &transform)
+{
+	m_local = transform;
+	markDirty ();
+}
+
+const math::Matrixf &SceneNode::getLocalTransform (void) const
+{
+	return m_local;
+}
+
+const math::Matrixf &SceneNode::getWorldTransform (void) const
+{
+	return m_world;
+}
+
+void SceneNode::setLocalBounds (const math::vec3f &min, const math::vec3f &max)
+{
+	m_local_min = min;
+	m_local_max = max;
+	m_has_bounds = true;
+	markDirty ();
+}
+
+bool SceneNode::hasBounds (void) const
+{
+	return m_has_bounds;
+}
+
+const math::vec3f &SceneNode::getWorldMin (void) const
+{
+	return m_world_min;
+}
+
+const math::vec3f &SceneNode::getWorldMax (void) const
+{
+	return m_world_max;
+}
+
+SceneNode *SceneNode::getParent (void) const
+{
+	return m_parent;
+}
+
+void SceneNode::render (int context_id)
+{
+}
+
+void SceneNode::markDirty (void)
+{
+	if (!m_dirty)
+	{
+		m_dirty = true;
+		if (m_graph)
+		{
+			m_graph->m_dirty.push_back (this);
+		}
+	}
+}
+
+SceneGraph::SceneGraph (void)
+{
+	m_root.m_graph = this;
+}
+
+SceneGraph::~SceneGraph (void)
+{
+	while (m_root.m_children.size ())
+	{
+		detach (*m_root.m_children.back ());
+	}
+	m_root.m_graph = NULL;
+}
+
+SceneNode &SceneGraph::getRoot (void)
+{
+	return m_root;
+}
+
+void SceneGraph::attach (SceneNode &node)
+{
+	attach (node, m_root);
+}
+
+void SceneGraph::attach (SceneNode &node, SceneNode &parent)
+{
+	if (node.m_graph)
+	{
+		node.m_graph->detach (node);
+	}
+	else if (node.m_parent)
+	{
+		std::vector <SceneNode *> &siblings = node.m_parent->m_children;
+		siblings.erase (std::find (siblings.begin (), siblings.end (), &node));
+	}
+
+	node.m_parent = &parent;
+	parent.m_children.push_back (&node);
+	if (parent.m_graph == this)
+	{
+		attachSubtree (&node);
+	}
+}
+
+void SceneGraph::detach (SceneNode &node)
+{
+	if (node.m_parent)
+	{
+		std::vector <SceneNode *> &siblings = node.m_parent->m_children;
+		siblings.erase (std::find (siblings.begin (), siblings.end (), &node));
+		node.m_parent = NULL;
+	}
+
+	detachSubtree (&node);
+
+	// Forget the detached nodes so the list never holds a node that has
+	// since been destroyed.
+	size_t kept = 0;
+	for (size_t i = 0; i < m_dirty.size (); ++i)
+	{
+		if (m_dirty[i]->m_graph == this)
+		{
+			m_dirty[kept++] = m_dirty[i];
+		}
+	}
+	m_dirty.resize (kept);
+}
+
+void SceneGraph::update (void)
+{
+	for (size_t i = 0; i < m_dirty.size (); ++i)
+	{
+		if (!m_dirty[i]->m_dirty)
+		{
+			continue;
+		}
+
+		// Start from the highest changed ancestor so that every subtree is
+		// only visited once.
+		SceneNode *top = m_dirty[i];
+		for (SceneNode *node = top->m_parent; node; node = node->m_parent)
+		{
+			if (node->m_dirty)
+			{
+				top = node;
+			}
+		}
+		updateSubtree (top);
+	}
+	m_dirty.clear ();
+}
+
+size_t SceneGraph::cull (const gfx::Frustum &frustum, std::vector <SceneNode *> &visible) const
+{
+	CollectNodes collect (visible);
+	return m_hierarchy.cull (frustum, collect);
+}
+
+void SceneGraph::render (const gfx::Frustum &frustum, std::vector <SceneNode *> &visible, int context_id) const
+{
+	visible.clear ();
+	cull (frustum, visible);
+
+	glMatrixMode (GL_MODELVIEW);
+	for (size_t i = 0; i < visible.size (); ++i)
+	{
+		glPushMatrix ();
+			glMultMatrixf (visible[i]->m_world.data ());
+			visible[i]->render (context_id);
+		glPopMatrix ();
+	}
+}
+
+size_t SceneGraph::render (const gfx::Frustum &frustum, const gfx::OcclusionCuller &occlusion,
+                           std::vector <SceneNode *> &visible, int context_id) const
+{
+	visible.clear ();
+	cull (frustum, visible);
+
+	size_t occluded = 0;
+	glMatrixMode (GL_MODELVIEW);
+	for (size_t i = 0; i < visible.size (); ++i)
+	{
+		if (occlusion.isOccluded (visible[i]->m_world_min, visible[i]->m_world_max))
+		{
+			++occluded;
+			continue;
+		}
+
+		glPushMatrix ();
+			glMultMatrixf (visible[i]->m_world.data ());
+			visible[i]->render (context_id);
+		glPopMatrix ();
+	}
+	return occluded;
+}
+
+void SceneGraph::updateSubtree (SceneNode *node)
+{
+	// Matrix::operator* multiplies the stored arrays, so this is
+	// parent * local in OpenGL terms.
+	node->m_world = node->m_parent ? node->m_local * node->m_parent->m_world : node->m_local;
+	node->m_dirty = false;
+
+	if (node->m_has_bounds)
+	{
+		transformBounds (node->m_world, node->m_local_min, node->m_local_max, node->m_world_min, node->m_world_max);
+		if (node->m_proxy == -1)
+		{
+			node->m_proxy = m_hierarchy.insert (node->m_world_min, node->m_world_max, node);
+		}
+		else
+		{
+			m_hierarchy.move (node->m_proxy, node->m_world_min, node->m_world_max);
+		}
+	}
+
+	for (size_t i = 0; i < node->m_children.size (); ++i)
+	{
+		updateSubtree (node->m_children[i]);
+	}
+}
+
+void SceneGraph::attachSubtree (SceneNode *node)
+{
+	node->m_graph = this;
+	node->m_dirty = false;
+	node->markDirty ();
+	for (size_t i = 0; i < node->m_children.size (); ++i)
+	{
+		attachSubtree (node->m_children[i]);
+	}
+}
+
+void SceneGraph::detachSubtree (SceneNode *node)
+{
+	if (node->m_proxy != -1)
+	{
+		m_hierarchy.remove (node->m_proxy);
+		node->m_proxy = -1;
+	}
+	node->m_graph = NULL;
+	node->m_dirty = false;
+	for (size_t i = 0; i < node->m_children.size (); ++i)
+	{
+		detachSubtree (node->m_children[i]);
+	}
+}
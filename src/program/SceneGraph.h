@@ -0,0 +1,191 @@
+/*
+   Filename : SceneGraph.h
+   Version  : 1.0
+
+   Purpose  : Lightweight scene graph.  Nodes carry a local transform and
+              the bounds of what they draw; world transforms and world
+              bounds are only recomputed below nodes that changed, and the
+              bounds live in a bounding volume hierarchy that is culled
+              against each context's frustum.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#pragma once
+
+#include <Matrix.h>
+#include <Mesh.h>
+#include <Frustum.h>
+#include <OcclusionCuller.h>
+#include "BoundingVolumeHierarchy.h"
+#include <vector>
+
+class SceneGraph;
+
+/**
+  * A node of the scene graph.  Nodes are not owned by the graph; a node
+  * that is destroyed while attached removes itself and its children.
+  */
+class SceneNode
+{
+	public:
+
+		SceneNode (void);
+
+		virtual ~SceneNode (void);
+
+		/**
+		  * Set the transform from this node's space to its parent's, laid out
+		  * as OpenGL expects it (column major).
+		  */
+		void setLocalTransform (const math::Matrixf &transform);
+
+		const math::Matrixf &getLocalTransform (void) const;
+
+		/**
+		  * Get the transform from this node's space to world space, as of the
+		  * last SceneGraph::update ().
+		  */
+		const math::Matrixf &getWorldTransform (void) const;
+
+		/**
+		  * Set the bounds of what render () draws, in this node's space.
+		  * Nodes without bounds are only used for grouping and never drawn.
+		  */
+		void setLocalBounds (const math::vec3f &min, const math::vec3f &max);
+
+		bool hasBounds (void) const;
+
+		/**
+		  * Get the world space bounding box, as of the last update.
+		  */
+		const math::vec3f &getWorldMin (void) const;
+		const math::vec3f &getWorldMax (void) const;
+
+		SceneNode *getParent (void) const;
+
+		/**
+		  * Draw the node.  The modelview matrix already includes the node's
+		  * world transform.
+		  */
+		virtual void render (int context_id);
+
+	private:
+
+		friend class SceneGraph;
+
+		void markDirty (void);
+
+		SceneGraph 				  *m_graph;			// Graph the node is attached to, if any.
+		SceneNode 				  *m_parent;
+		std::vector <SceneNode *>  m_children;
+		math::Matrixf 			   m_local;
+		math::Matrixf 			   m_world;
+		math::vec3f 			   m_local_min;
+		math::vec3f 			   m_local_max;
+		math::vec3f 			   m_world_min;
+		math::vec3f 			   m_world_max;
+		bool 					   m_has_bounds;
+		bool 					   m_dirty;			// The world transform needs to be recomputed.
+		int 					   m_proxy;			// Box in the graph's hierarchy, or -1.
+};
+
+/**
+  * Node drawing a mesh, bounded by the mesh's bounding box.
+  */
+template <class T>
+class MeshNode : public SceneNode
+{
+	public:
+
+		explicit MeshNode (gfx::Mesh <T> &mesh)
+			: m_mesh (mesh)
+		{
+		}
+
+		/**
+		  * Take the bounds from the mesh.  Call once the mesh is loaded.
+		  */
+		void updateBounds (void)
+		{
+			const math::Vector <T, 3> &min = m_mesh.getBoundsMin ();
+			const math::Vector <T, 3> &max = m_mesh.getBoundsMax ();
+			setLocalBounds (math::vec3f ((float)min[0], (float)min[1], (float)min[2]),
+			                math::vec3f ((float)max[0], (float)max[1], (float)max[2]));
+		}
+
+		virtual void render (int context_id)
+		{
+			m_mesh.render (context_id);
+		}
+
+	private:
+
+		gfx::Mesh <T> &m_mesh;
+};
+
+class SceneGraph
+{
+	public:
+
+		SceneGraph (void);
+
+		~SceneGraph (void);
+
+		/**
+		  * Get the root node.  Its transform is the world space.
+		  */
+		SceneNode &getRoot (void);
+
+		/**
+		  * Attach node, and everything below it, under parent (the root by
+		  * default).  A node attached elsewhere is detached first.
+		  */
+		void attach (SceneNode &node);
+		void attach (SceneNode &node, SceneNode &parent);
+
+		/**
+		  * Detach node and everything below it.
+		  */
+		void detach (SceneNode &node);
+
+		/**
+		  * Bring world transforms and bounds up to date.  Only the subtrees
+		  * below nodes changed since the last update are visited.  Must not run
+		  * while a context is culling.
+		  */
+		void update (void);
+
+		/**
+		  * Append the nodes that are at least partially inside frustum to
+		  * visible.  Returns the number appended.
+		  */
+		size_t cull (const gfx::Frustum &frustum, std::vector <SceneNode *> &visible) const;
+
+		/**
+		  * Cull against frustum and draw what is left.  visible is scratch
+		  * space, kept by the caller so it is not reallocated every frame.
+		  */
+		void render (const gfx::Frustum &frustum, std::vector <SceneNode *> &visible, int context_id) const;
+
+		/**
+		  * As above, but also skip nodes occlusion reports as hidden.  Returns
+		  * the number of nodes skipped that way.
+		  */
+		size_t render (const gfx::Frustum &frustum, const gfx::OcclusionCuller &occlusion,
+		               std::vector <SceneNode *> &visible, int context_id) const;
+
+	private:
+
+		friend class SceneNode;
+
+		void updateSubtree (SceneNode *node);
+		void attachSubtree (SceneNode *node);
+		void detachSubtree (SceneNode *node);
+
+		SceneNode 				  m_root;
+		std::vector <SceneNode *> m_dirty;		// Nodes changed since the last update.
+		BoundingVolumeHierarchy   m_hierarchy;
+};
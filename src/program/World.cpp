@@ -17,14 +17,26 @@
 #define MAX_SOUNDS 3
 
 World::World (void)
+	: m_didge_node (m_didge)
 {
-	m_didge.load ("./models/didgeridoo.obj", false);
-	m_skybox.load ("./images/skybox");
+	// Decoding and interleaving happen once, on the loading pool, for all
+	// contexts; initContext () only queues the uploads.
+	m_skybox_decoded = m_skybox.load ("./images/skybox", m_load_pool);
+	m_didge.useAtlas (true);
+	m_didge.load ("./models/didgeridoo.obj", false, &m_load_pool);
+	m_didge.useArena (&m_arena);
+	m_didge.prepareVBOs ();
+	m_didge_staged = m_load_pool.submit ([this] () { m_didge.stageVBOData (); }).share ();
+	m_didge_node.updateBounds ();
+	m_scene.attach (m_didge_node);
+	m_didge_occluder = ::gfx::makeOccluder (m_didge, 256, &m_didge_node.getWorldTransform ());
+	m_occluders.push_back (&m_didge_occluder);
 	m_play_sound = false;
 	m_pitch_offset = 0.0f;
 	m_sound_index = 1;
 	m_play_secondary_sound = false;
 	m_play_tap = false;
+	m_frame = 0;
 }
 
 World::~World (void)
@@ -33,6 +45,20 @@ World::~World (void)
 
 void World::update (const float dt)
 {
+	// A thread that already saw this frame is starting the next one; the
+	// others catch up with it.
+	std::lock_guard <std::mutex> frame_lock (m_frame_mutex);
+	unsigned int &updated = m_updated[std::this_thread::get_id ()];
+	if (updated != m_frame)
+	{
+		updated = m_frame;
+		return;
+	}
+
+	// Renders on other contexts walk the scene and its BVH.
+	std::unique_lock <std::shared_timed_mutex> scene_lock (m_scene_mutex);
+	updated = ++m_frame;
+
 	static float delay = 0.0f;
 	delay -= dt;
 
@@ -54,18 +80,39 @@ void World::update (const float dt)
 
 	m_pitch_offset += input::getButton ("button2")->pressed () ? 0.05f : 0.0f;
 	m_pitch_offset -= input::getButton ("button3")->pressed () ? 0.2f : 0.0f;
+
+	// The instrument follows the wand.
+	::math::Matrixf wand_matrix;
+	memcpy (wand_matrix.data (), cavr::math::mat4f (wand->getMatrix ()).v, 16 * sizeof (float));
+	m_didge_node.setLocalTransform (wand_matrix);
+	m_scene.update ();
 }
 
 void World::render (int context_id) 
 {
+	std::shared_lock <std::shared_timed_mutex> scene_lock (m_scene_mutex);
+
+	::math::Matrixf projection, view;
+	memcpy (projection.data (), cavr::gfx::getProjection ().v, 16 * sizeof (float));
+	memcpy (view.data (), cavr::gfx::getView ().v, 16 * sizeof (float));
+	updateView (context_id, view, projection);
+
+	ContextView &context = m_views[context_id];
+	context.uploads.process ();
+
+	// Rasterize the occluders on the pool while the skybox is drawn.  cavr
+	// renders a stereo frame as one pass per eye, and each pass rasterizes
+	// for its own eye.
+	context.occlusion.begin (context.frustum.modelviewProjection, m_occluders, m_pool);
+
 	glMatrixMode(GL_PROJECTION);
-	glLoadMatrixf(cavr::gfx::getProjection().v);
+	glLoadMatrixf(projection.data ());
 
 
 	glClear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	glClearColor(0,0,0,1);
 	glMatrixMode (GL_MODELVIEW);
-	glLoadMatrixf(cavr::gfx::getView().v);
+	glLoadMatrixf(view.data ());
 
 	const input::SixDOF *wand = input::getSixDOF ("wand");
 	const input::SixDOF *head = input::getSixDOF ("head");
@@ -77,22 +124,59 @@ void World::render (int context_id)
 		cavr::math::vec4f light_pos = m_transform.toVirtualPoint (vec4f(head->getPosition (),1.0 ) );
 		light_pos[3] = 1.0f;
 		glLightfv (GL_LIGHT0, GL_POSITION, light_pos.v);
-		m_didge.render (context_id);
 	glPopMatrix ();
+
+	context.occlusion.finish ();
+	context.occluded = m_scene.render (context.frustum, context.occlusion, context.visible, context_id);
+}
+
+void World::updateView (int context_id, const ::math::Matrixf &view, const ::math::Matrixf &projection)
+{
+	ContextView &context = m_views[context_id];
+	if (context.valid && context.view == view && context.projection == projection)
+	{
+		return;
+	}
+
+	context.view = view;
+	context.projection = projection;
+	context.frustum.update (view, projection);
+	context.valid = true;
+}
+
+const ::gfx::Frustum &World::getFrustum (int context_id)
+{
+	return m_views[context_id].frustum;
+}
+
+size_t World::getOccludedCount (int context_id)
+{
+	return m_views[context_id].occluded;
 }
 
-void World::initContext (int context_id)
+void World::initContext (int context_id, int share_group)
 {
-	m_didge.initializeTextures (context_id);
-	m_didge.createVBO (context_id);
+	if (share_group >= 0)
+	{
+		::gfx::ShareGroup::join (context_id, share_group);
+	}
+	::gfx::TextureCache::getInstance ().registerContext (context_id);
 
-	m_skybox.initContext (context_id);
+	::gfx::UploadQueue &uploads = m_views[context_id].uploads;
+	m_didge.queueVBOs (uploads, context_id, m_didge_staged);
+	m_didge.queueTextures (uploads, context_id);
+	m_skybox.queueUploads (uploads, context_id, m_skybox_decoded);
 }
 
 void World::destroyContext (int context_id)
 {
+	m_views[context_id].uploads.clear ();
+	m_views.remove (context_id);
 	m_skybox.destroyContext (context_id);
 	m_didge.destroyContext (context_id);
+	m_arena.destroyContext (context_id);
+	::gfx::TextureCache::getInstance ().unregisterContext (context_id);
+	::gfx::ShareGroup::leave (context_id);
 }
 
 string getALErrorString(int err) {
@@ -20,11 +20,21 @@
 #include <AL/alut.h>
 #include <AL/al.h>
 //#include <hydra/Transform.h>
+#include <ContextBuffer.h>
+#include <Frustum.h>
+#include <OcclusionCuller.h>
+#include <ThreadPool.h>
+#include <UploadQueue.h>
+#include "SceneGraph.h"
 #include <cavr/cavr.h>
 #include <Transform.h>
 
 #include <cavr/gfx/renderer.h>
 #include <cavr/gfx/shapes.h>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
 
 using namespace gfx;
 using namespace cavr;
@@ -36,11 +46,25 @@ class World
 
 		~World (void);
 
+		/**
+		  * Called by cavr on the thread of each context.  The first call of
+		  * a frame moves the world on; the others only note that their
+		  * context has reached it.
+		  */
 		void update (const float dt);
 
 		void render (int context_id);
 
-		void initContext (int context_id);
+		/**
+		  * Create the GL resources of a context.  Uploads are queued and
+		  * made a few at a time by render ().
+		  * @param context_id ID of the context, different for every window.
+		  * @param share_group Group of contexts created sharing objects with
+		  *        this one (see ::gfx::ShareGroup), or -1.  Contexts of a group
+		  *        upload the meshes and textures once between them; only
+		  *        pass one when the GL contexts really share objects.
+		  */
+		void initContext (int context_id, int share_group = -1);
 
 		void destroyContext (int context_id);
 
@@ -48,10 +72,51 @@ class World
 
 		void initAudio (void);
 
+		/**
+		  * Frustum of the pass last rendered on a context, in world space.
+		  */
+		const ::gfx::Frustum &getFrustum (int context_id);
+
+		/**
+		  * Number of nodes the occlusion culler skipped in the last pass
+		  * rendered on a context.
+		  */
+		size_t getOccludedCount (int context_id);
+
 	private:
 
+		/**
+		  * Culling frustums of one context.  They are computed on the CPU from
+		  * cavr's matrices, and only when those change, so culling never reads
+		  * anything back from the GL.
+		  */
+		struct ContextView
+		{
+			ContextView (void) : occluded (0), valid (false) {}
+
+			::math::Matrixf view;
+			::math::Matrixf projection;
+			::gfx::Frustum frustum;
+			std::vector <SceneNode *> visible;
+			::gfx::OcclusionCuller occlusion;
+			::gfx::UploadQueue uploads;
+			size_t occluded;
+			bool valid;
+		};
+
+		void updateView (int context_id, const ::math::Matrixf &view, const ::math::Matrixf &projection);
+
+		::gfx::BufferArena m_arena;		// Vertex data of the meshes.
 		Mesh <float> m_didge;
 		Skybox m_skybox;
+		SceneGraph m_scene;
+		MeshNode <float> m_didge_node;
+		::gfx::Occluder m_didge_occluder;
+		std::vector <const ::gfx::Occluder *> m_occluders;
+		util::ThreadPool m_pool;		// Occlusion rasterization, every frame.
+		util::ThreadPool m_load_pool;	// Startup decoding and staging, kept off m_pool so a frame never waits behind it.
+		std::shared_future <void> m_didge_staged;		// Vertex data of the VBOs interleaved.
+		std::shared_future <void> m_skybox_decoded;
 		bool m_play_sound;
 		float m_pitch_offset;
 		cavr::math::vec3f m_sound_pos;
@@ -59,6 +124,11 @@ class World
 		int m_sound_index;
 		bool m_play_secondary_sound;
 		bool m_play_tap;
+		::gfx::ContextBuffer <ContextView> m_views;
+		unsigned int m_frame;
+		std::mutex m_frame_mutex;
+		std::map <std::thread::id, unsigned int> m_updated;		// Frame each context's thread last saw in update ().
+		std::shared_timed_mutex m_scene_mutex;		// Shared by render (), exclusive while the scene moves.
 
 		struct SoundData
 		{
@@ -18,6 +18,8 @@
 #include <AL/alut.h>
 #include <AL/al.h>
 #include "World.h"
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
 #include <GL/gl.h>
 #include <GL/glx.h>
@@ -26,6 +28,12 @@ using namespace cavr;
 
 World world;
 
+// cavr calls the GL callbacks of each window on that window's thread, so the
+// thread tells the windows apart: each gets its own context id in
+// initContext ().
+std::atomic <int> next_context_id (1);
+thread_local int context_id = 0;
+
 //const Button *exit_button;
 
 const GLfloat light_ambient[]  = { 0.0f, 0.0f, 0.0f, 1.0f };
@@ -65,7 +73,7 @@ void render (void)
 {
 	glClearColor(1,1,1,1);
 	alrender();
-	world.render (1);
+	world.render (context_id);
 }
 
 
@@ -92,13 +100,18 @@ void initContext (void)
 
 	
 
-	world.initContext (1);
+	// INSTRUMENT_SHARED_CONTEXTS=1 tells the program that the renderer
+	// creates the contexts of its windows sharing objects, so the meshes and
+	// textures are uploaded once for all of them.  Wrong when they do not.
+	const char *shared = getenv ("INSTRUMENT_SHARED_CONTEXTS");
+	context_id = next_context_id++;
+	world.initContext (context_id, shared && atoi (shared) ? 0 : -1);
 	cavr::System::setContextData(&world);
 }
 
 void destroyContext (void)
 {
-	world.destroyContext (1);
+	world.destroyContext (context_id);
 }
 
 int main (int argc, char **argv)
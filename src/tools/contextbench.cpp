@@ -0,0 +1,163 @@
+/*
+   Filename : contextbench.cpp
+   Version  : 1.0
+
+   Purpose  : Contention benchmark for ContextBuffer lookups.  Several
+              threads, one per simulated render context, look up their own
+              entries the way Texture::bind () and VertexBuffer::bind () do,
+              through ContextBuffer and through the mutex and std::map
+              lookup it used to be.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <ContextBuffer.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <pthread.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include <sys/time.h>
+
+using namespace std;
+
+namespace
+{
+
+double now (void)
+{
+	timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+/**
+  * The previous ContextBuffer lookup: a mutex around std::map::operator[].
+  */
+template <class T>
+class LockedBuffer
+{
+	public:
+
+		LockedBuffer (void) { pthread_mutex_init (&m_mutex, 0); }
+		~LockedBuffer (void) { pthread_mutex_destroy (&m_mutex); }
+
+		T &operator[] (int id)
+		{
+			pthread_mutex_lock (&m_mutex);
+			T &result = m_data[id];
+			pthread_mutex_unlock (&m_mutex);
+			return result;
+		}
+
+	private:
+
+		pthread_mutex_t m_mutex;
+		map <int, T> m_data;
+};
+
+/**
+  * Keeps the optimizer from discarding benchmark results.
+  */
+volatile unsigned int g_sink;
+
+/**
+  * Time lookups of objects entries per thread, with every thread using its
+  * own context id.  Returns nanoseconds per lookup as seen by one thread.
+  */
+template <class Buffer>
+double run (vector <Buffer> &buffers, int threads, size_t lookups)
+{
+	// Create the entries up front, as initContext () does.
+	for (size_t i = 0; i < buffers.size (); ++i)
+	{
+		for (int t = 0; t < threads; ++t)
+		{
+			buffers[i][t] = (unsigned int)(i + t);
+		}
+	}
+
+	vector <thread> workers;
+	double start = now ();
+	for (int t = 0; t < threads; ++t)
+	{
+		workers.push_back (thread ([&buffers, t, lookups] ()
+		{
+			unsigned int sum = 0;
+			size_t count = buffers.size ();
+			for (size_t i = 0; i < lookups; ++i)
+			{
+				sum += buffers[i % count][t];
+			}
+			g_sink = sum;
+		}));
+	}
+	for (size_t i = 0; i < workers.size (); ++i)
+	{
+		workers[i].join ();
+	}
+	return (now () - start) * 1.0e9 / lookups;
+}
+
+void usage (void)
+{
+	fprintf (stderr,
+	         "Usage: contextbench [-t max_threads] [-n lookups] [-o objects]\n"
+	         "  -t  Largest number of render threads (default 8).\n"
+	         "  -n  Lookups per thread (default 10000000).\n"
+	         "  -o  Number of buffers looked up in turn, like textures and\n"
+	         "      VBOs of a scene (default 64).\n");
+}
+
+}
+
+int main (int argc, char **argv)
+{
+	int max_threads = 8;
+	size_t lookups = 10000000;
+	size_t objects = 64;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!strcmp (argv[i], "-t") && i + 1 < argc)
+		{
+			max_threads = atoi (argv[++i]);
+		}
+		else if (!strcmp (argv[i], "-n") && i + 1 < argc)
+		{
+			lookups = strtoul (argv[++i], NULL, 10);
+		}
+		else if (!strcmp (argv[i], "-o") && i + 1 < argc)
+		{
+			objects = strtoul (argv[++i], NULL, 10);
+		}
+		else
+		{
+			usage ();
+			return 1;
+		}
+	}
+
+	if (max_threads < 1 || lookups == 0 || objects == 0)
+	{
+		usage ();
+		return 1;
+	}
+
+	printf ("%zu lookups per thread over %zu buffers\n", lookups, objects);
+	for (int threads = 1; threads <= max_threads; threads *= 2)
+	{
+		vector <LockedBuffer <unsigned int> > locked (objects);
+		vector <gfx::ContextBuffer <unsigned int> > buffers (objects);
+		double locked_time = run (locked, threads, lookups);
+		double buffer_time = run (buffers, threads, lookups);
+		printf ("  %2d threads  ContextBuffer %7.2f ns/lookup  (mutex + map %7.2f ns/lookup, %6.2fx)\n",
+		        threads, buffer_time, locked_time, buffer_time > 0.0 ? locked_time / buffer_time : 0.0);
+	}
+
+	return 0;
+}
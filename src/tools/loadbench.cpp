@@ -0,0 +1,237 @@
+/*
+   Filename : loadbench.cpp
+   Version  : 1.0
+
+   Purpose  : Times the mesh loaders and their post-processing passes on
+              .obj files (see objgen for generating them) and reports
+              throughput and peak resident memory.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <Mesh.h>
+#include <OBJ.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+
+double now (void)
+{
+	timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+/**
+  * Peak resident set size of this process in megabytes, since it started.
+  */
+double peakRSS (void)
+{
+	rusage usage;
+	getrusage (RUSAGE_SELF, &usage);
+	return usage.ru_maxrss / 1024.0;
+}
+
+void report (const char *stage, double seconds, double bytes, unsigned long long triangles)
+{
+	printf ("  %-24s %10.3f s %10.1f MB/s %14.0f tris/s %10.1f MB peak\n",
+	        stage,
+	        seconds,
+	        seconds > 0.0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0,
+	        seconds > 0.0 ? triangles / seconds : 0.0,
+	        peakRSS ());
+	fflush (stdout);
+}
+
+/**
+  * Stages timed on each file.
+  */
+enum Stage
+{
+	MESH_LOAD,
+	OBJ_READ,
+	REMOVE_DUPLICATES,
+	SMOOTH_NORMALS,
+	STAGE_COUNT
+};
+
+/**
+  * Run one stage on a file, after the untimed stages it depends on.  This is
+  * done in a child process of its own, since the peak RSS is a high-water
+  * mark for the whole process: the peak reported for a stage is then that
+  * of the stage and its inputs, not of whatever ran before it.
+  */
+int benchmarkStage (const char *filename, double bytes, Stage stage, unsigned long long max_weld_triangles)
+{
+	unsigned long long triangles = 0;
+	double start = 0.0;
+
+	if (stage == MESH_LOAD)
+	{
+		// Mesh::load prints its own statistics, keep them out of the table.
+		std::ostringstream sink;
+		std::streambuf *saved = std::cout.rdbuf (sink.rdbuf ());
+
+		gfx::Mesh <float> mesh;
+		start = now ();
+		bool loaded = mesh.load (filename, false);
+		double elapsed = now () - start;
+
+		std::cout.rdbuf (saved);
+
+		for (gfx::Mesh <float>::TriangleIterator iter = mesh.begin (); iter != mesh.end (); ++iter)
+		{
+			triangles += iter->second.size ();
+		}
+
+		if (!loaded)
+		{
+			fprintf (stderr, "loadbench: Error: Mesh::load failed on %s\n", filename);
+			return 1;
+		}
+
+		report ("Mesh<float>::load", elapsed, bytes, triangles);
+		return 0;
+	}
+
+	OBJ obj;
+	start = now ();
+	obj.read (filename);
+	if (stage == OBJ_READ)
+	{
+		report ("OBJ::read", now () - start, bytes, obj.vertexIndices ().size () / 3);
+		return 0;
+	}
+
+	const char *name = stage == REMOVE_DUPLICATES ? "OBJ::removeDuplicates" : "OBJ::smoothNormals";
+	triangles = obj.vertexIndices ().size () / 3;
+	if (triangles > max_weld_triangles)
+	{
+		// Both passes are quadratic in the vertex count.
+		printf ("  %-24s skipped (%llu triangles > -w %llu)\n", name, triangles, max_weld_triangles);
+		return 0;
+	}
+
+	size_t vertices = obj.vertices ().size ();
+	start = now ();
+	obj.removeDuplicateVertices ();
+	if (stage == REMOVE_DUPLICATES)
+	{
+		report (name, now () - start, bytes, triangles);
+		printf ("  %-24s %zu -> %zu vertices\n", "", vertices, obj.vertices ().size ());
+		return 0;
+	}
+
+	start = now ();
+	obj.smoothNormals ();
+	report (name, now () - start, bytes, triangles);
+	return 0;
+}
+
+/**
+  * Run every stage on one file, each in a child process.  Stops at the
+  * first stage that fails.
+  */
+int benchmarkFile (const char *filename, unsigned long long max_weld_triangles)
+{
+	struct stat info;
+	if (stat (filename, &info) != 0)
+	{
+		fprintf (stderr, "loadbench: Error: Could not stat %s\n", filename);
+		return 1;
+	}
+
+	double bytes = (double)info.st_size;
+	printf ("%s (%.1f MB)\n", filename, bytes / (1024.0 * 1024.0));
+
+	for (int stage = 0; stage < STAGE_COUNT; ++stage)
+	{
+		fflush (stdout);
+		pid_t pid = fork ();
+		if (pid < 0)
+		{
+			fprintf (stderr, "loadbench: Error: Could not fork: %s\n", strerror (errno));
+			return 1;
+		}
+		if (pid == 0)
+		{
+			exit (benchmarkStage (filename, bytes, (Stage)stage, max_weld_triangles));
+		}
+
+		int status = 0;
+		if (waitpid (pid, &status, 0) != pid || !WIFEXITED (status) || WEXITSTATUS (status) != 0)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+void usage (const char *program)
+{
+	fprintf (stderr,
+	         "usage: %s [-w max_weld_triangles] file.obj [file.obj ...]\n"
+	         "  -w <count>   skip removeDuplicateVertices/smoothNormals above this many triangles (default 20000)\n",
+	         program);
+	exit (1);
+}
+
+}
+
+int main (int argc, char **argv)
+{
+	unsigned long long max_weld_triangles = 20000;
+	vector <const char *> files;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		string arg = argv[i];
+		if (arg == "-w" && i + 1 < argc)
+		{
+			max_weld_triangles = strtoull (argv[++i], NULL, 10);
+		}
+		else if (arg[0] != '-')
+		{
+			files.push_back (argv[i]);
+		}
+		else
+		{
+			usage (argv[0]);
+		}
+	}
+
+	if (files.empty ())
+	{
+		usage (argv[0]);
+	}
+
+	int failures = 0;
+	for (size_t i = 0; i < files.size (); ++i)
+	{
+		if (benchmarkFile (files[i], max_weld_triangles) != 0)
+		{
+			++failures;
+		}
+	}
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,30 @@
+#!/bin/sh
+#
+# Generates assets of increasing size with objgen and runs loadbench on them.
+#
+# usage: loadsweep.sh [build_dir] [output_dir]
+#
+# SIZES, LAYOUTS, MATERIALS and TEXTURES may be overridden from the
+# environment, e.g. SIZES="1000 1000000" LAYOUTS="v vtvn" ./loadsweep.sh
+
+BUILD=${1:-.}
+OUT=${2:-./bench_assets}
+SIZES=${SIZES:-"1000 10000 100000 1000000 10000000 50000000"}
+LAYOUTS=${LAYOUTS:-"v vt vn vtvn"}
+MATERIALS=${MATERIALS:-8}
+TEXTURES=${TEXTURES:-4}
+
+mkdir -p "$OUT" || exit 1
+
+for layout in $LAYOUTS
+do
+	for size in $SIZES
+	do
+		file="$OUT/synthetic_${layout}_${size}.obj"
+		if [ ! -f "$file" ]
+		then
+			"$BUILD/objgen" -t "$size" -a "$layout" -m "$MATERIALS" -x "$TEXTURES" "$file" || exit 1
+		fi
+		"$BUILD/loadbench" "$file"
+	done
+done
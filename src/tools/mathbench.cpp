@@ -0,0 +1,480 @@
+/*
+   Filename : mathbench.cpp
+   Version  : 1.0
+
+   Purpose  : Microbenchmarks for the math library kernels.  Every kernel
+              is timed next to a plain scalar loop computing the same thing
+              and the largest difference between the two is reported.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <Matrix.h>
+#include <VectorExpression.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <sys/time.h>
+
+using namespace std;
+
+namespace
+{
+
+double now (void)
+{
+	timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+float randomFloat (void)
+{
+	return (float)rand () / (float)RAND_MAX * 2.0f - 1.0f;
+}
+
+template <unsigned int N>
+void fill (vector <math::Vector <float, N> > &data, size_t count)
+{
+	data.resize (count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		for (unsigned int j = 0; j < N; ++j)
+		{
+			data[i][j] = randomFloat ();
+		}
+	}
+}
+
+void report (const char *name, double kernel, double scalar, size_t count, double max_error)
+{
+	printf ("  %-28s %8.2f ns/op  (plain loop %8.2f ns/op, %5.2fx)  max diff %g\n",
+	        name,
+	        kernel * 1.0e9 / count,
+	        scalar * 1.0e9 / count,
+	        kernel > 0.0 ? scalar / kernel : 0.0,
+	        max_error);
+}
+
+/**
+  * Keeps the optimizer from discarding benchmark results.
+  */
+volatile float g_sink;
+
+template <unsigned int N>
+void benchmarkVectors (size_t count, int repeat)
+{
+	typedef math::Vector <float, N> Vec;
+	vector <Vec> a, b, out, ref;
+	fill (a, count);
+	fill (b, count);
+	out.resize (count);
+	ref.resize (count);
+
+	printf ("Vector<float, %u> x %zu, %d passes\n", N, count, repeat);
+
+	// a + b
+	double start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			out[i] = a[i] + b[i];
+	double kernel = now () - start;
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			for (unsigned int j = 0; j < N; ++j)
+				ref[i].v[j] = a[i].v[j] + b[i].v[j];
+	double scalar = now () - start;
+
+	double error = 0.0;
+	for (size_t i = 0; i < count; ++i)
+		for (unsigned int j = 0; j < N; ++j)
+			error = max (error, (double)fabs (out[i][j] - ref[i][j]));
+	report ("operator+", kernel, scalar, count * repeat, error);
+
+	// (a - b) * s
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			out[i] = (a[i] - b[i]) * 0.5f;
+	kernel = now () - start;
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			for (unsigned int j = 0; j < N; ++j)
+				ref[i].v[j] = (a[i].v[j] - b[i].v[j]) * 0.5f;
+	scalar = now () - start;
+
+	error = 0.0;
+	for (size_t i = 0; i < count; ++i)
+		for (unsigned int j = 0; j < N; ++j)
+			error = max (error, (double)fabs (out[i][j] - ref[i][j]));
+	report ("(a - b) * s", kernel, scalar, count * repeat, error);
+
+	// dot
+	float sum = 0.0f;
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			sum += math::dot (a[i], b[i]);
+	kernel = now () - start;
+	g_sink = sum;
+
+	float ref_sum = 0.0f;
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			float d = 0.0f;
+			for (unsigned int j = 0; j < N; ++j)
+				d += a[i].v[j] * b[i].v[j];
+			ref_sum += d;
+		}
+	}
+	scalar = now () - start;
+	g_sink = ref_sum;
+
+	error = 0.0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		float d = 0.0f;
+		for (unsigned int j = 0; j < N; ++j)
+			d += a[i].v[j] * b[i].v[j];
+		error = max (error, (double)fabs (math::dot (a[i], b[i]) - d));
+	}
+	report ("dot", kernel, scalar, count * repeat, error);
+
+	// normalize
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			out[i] = math::normalize (a[i]);
+	kernel = now () - start;
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			float l = 0.0f;
+			for (unsigned int j = 0; j < N; ++j)
+				l += a[i].v[j] * a[i].v[j];
+			float inv = 1.0f / sqrtf (l);
+			for (unsigned int j = 0; j < N; ++j)
+				ref[i].v[j] = a[i].v[j] * inv;
+		}
+	}
+	scalar = now () - start;
+
+	error = 0.0;
+	for (size_t i = 0; i < count; ++i)
+		for (unsigned int j = 0; j < N; ++j)
+			error = max (error, (double)fabs (out[i][j] - ref[i][j]));
+	report ("normalize", kernel, scalar, count * repeat, error);
+
+	// (a * s - b * t) * d, as in Triangle::getTangent.  The eager operators
+	// and the expression templates must agree exactly.
+	const float s = 0.75f, t = -1.25f, d = 0.5f;
+	vector <Vec> fused (count);
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			out[i] = ((a[i] * s) - (b[i] * t)) * d;
+	kernel = now () - start;
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			fused[i] = ((math::lazy (a[i]) * s) - (math::lazy (b[i]) * t)) * d;
+	double lazy = now () - start;
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			for (unsigned int j = 0; j < N; ++j)
+				ref[i].v[j] = ((a[i].v[j] * s) - (b[i].v[j] * t)) * d;
+	scalar = now () - start;
+
+	error = 0.0;
+	double lazy_error = 0.0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		for (unsigned int j = 0; j < N; ++j)
+		{
+			error = max (error, (double)fabs (out[i][j] - ref[i][j]));
+			lazy_error = max (lazy_error, (double)fabs (fused[i][j] - out[i][j]));
+		}
+	}
+	report ("(a * s - b * t) * d", kernel, scalar, count * repeat, error);
+	report ("  lazy (vs eager)", lazy, scalar, count * repeat, lazy_error);
+}
+
+/**
+  * Reference 4x4 product on the raw arrays, r(i, j) = sum_k a(i, k) * b(k, j).
+  */
+void plainMultiply (float *r, const float *a, const float *b)
+{
+	for (int i = 0; i < 4; ++i)
+	{
+		for (int j = 0; j < 4; ++j)
+		{
+			float sum = 0.0f;
+			for (int k = 0; k < 4; ++k)
+				sum += a[k + i * 4] * b[j + k * 4];
+			r[j + i * 4] = sum;
+		}
+	}
+}
+
+double maxDifference (const math::Matrixf &a, const math::Matrixf &b)
+{
+	double error = 0.0;
+	for (int i = 0; i < 16; ++i)
+		error = max (error, (double)fabs (a(i) - b(i)));
+	return error;
+}
+
+/**
+  * Largest difference of each inverse from a double precision inverse,
+  * relative to the magnitude of the element so that near-singular inputs
+  * do not dominate.
+  */
+double inverseError (const vector <math::Matrixf> &input, const vector <math::Matrixf> &inverse)
+{
+	double error = 0.0;
+	for (size_t i = 0; i < input.size (); ++i)
+	{
+		math::Matrixd m, inv;
+		for (int j = 0; j < 16; ++j)
+			m(j) = input[i](j);
+		if (!math::inverse (m, inv))
+			continue;
+
+		for (int j = 0; j < 16; ++j)
+			error = max (error, fabs (inverse[i](j) - inv(j)) / (1.0 + fabs (inv(j))));
+	}
+	return error;
+}
+
+void benchmarkMatrices (size_t count, int repeat)
+{
+	// Random affine matrices: a rotation-ish upper 3x3 plus translation.
+	vector <math::Matrixf> a (count), b (count), out (count), ref (count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		for (int j = 0; j < 16; ++j)
+		{
+			a[i](j) = randomFloat ();
+			b[i](j) = randomFloat ();
+		}
+		a[i](3) = a[i](7) = a[i](11) = 0.0f;
+		a[i](15) = 1.0f;
+		a[i](0) += 2.0f; a[i](5) += 2.0f; a[i](10) += 2.0f;
+	}
+
+	printf ("Matrix<float> x %zu, %d passes\n", count, repeat);
+
+	// a * b
+	double start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			out[i] = a[i] * b[i];
+	double kernel = now () - start;
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			plainMultiply (ref[i].data (), a[i].data (), b[i].data ());
+	double scalar = now () - start;
+
+	double error = 0.0;
+	for (size_t i = 0; i < count; ++i)
+		error = max (error, maxDifference (out[i], ref[i]));
+	report ("operator*", kernel, scalar, count * repeat, error);
+
+	// transpose
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			out[i] = b[i].transpose ();
+	kernel = now () - start;
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			for (int j = 0; j < 4; ++j)
+				for (int k = 0; k < 4; ++k)
+					ref[i](j, k) = b[i](k, j);
+	scalar = now () - start;
+
+	error = 0.0;
+	for (size_t i = 0; i < count; ++i)
+		error = max (error, maxDifference (out[i], ref[i]));
+	report ("transpose", kernel, scalar, count * repeat, error);
+
+	// General inverse.
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			math::inverse (b[i], out[i]);
+	kernel = now () - start;
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			math::MatrixOpsScalar <float>::inverse (ref[i].data (), b[i].data ());
+	scalar = now () - start;
+	report ("inverse", kernel, scalar, count * repeat, inverseError (b, out));
+
+	// Affine inverse, timed against the general scalar inverse it replaces.
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			math::affineInverse (a[i], out[i]);
+	kernel = now () - start;
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			math::MatrixOpsScalar <float>::inverse (ref[i].data (), a[i].data ());
+	scalar = now () - start;
+	report ("affineInverse", kernel, scalar, count * repeat, inverseError (a, out));
+
+	// Batched points through one matrix.
+	vector <math::vec4f> points, transformed (count), expected (count);
+	fill (points, count);
+	const math::Matrixf &m = a[0];
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		math::transformPoints (m, &points[0], &transformed[0], count);
+	kernel = now () - start;
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		for (size_t i = 0; i < count; ++i)
+			for (int j = 0; j < 4; ++j)
+				expected[i].v[j] = m(j, 0) * points[i].v[0] + m(j, 1) * points[i].v[1] +
+				                   m(j, 2) * points[i].v[2] + m(j, 3) * points[i].v[3];
+	scalar = now () - start;
+
+	error = 0.0;
+	for (size_t i = 0; i < count; ++i)
+		for (int j = 0; j < 4; ++j)
+			error = max (error, (double)fabs (transformed[i][j] - expected[i][j]));
+	report ("transformPoints (vec4)", kernel, scalar, count * repeat, error);
+
+	// The same points as separate x, y and z arrays.
+	vector <float> x (count), y (count), z (count);
+	vector <float> tx (count), ty (count), tz (count);
+	vector <float> ex (count), ey (count), ez (count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		x[i] = points[i][0];
+		y[i] = points[i][1];
+		z[i] = points[i][2];
+	}
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+		math::transformPoints (m, &x[0], &y[0], &z[0], &tx[0], &ty[0], &tz[0], count);
+	kernel = now () - start;
+
+	start = now ();
+	for (int r = 0; r < repeat; ++r)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			// OpenGL layout, translation in data[12..14].
+			ex[i] = m(0, 0) * x[i] + m(1, 0) * y[i] + m(2, 0) * z[i] + m(3, 0);
+			ey[i] = m(0, 1) * x[i] + m(1, 1) * y[i] + m(2, 1) * z[i] + m(3, 1);
+			ez[i] = m(0, 2) * x[i] + m(1, 2) * y[i] + m(2, 2) * z[i] + m(3, 2);
+		}
+	}
+	scalar = now () - start;
+
+	error = 0.0;
+	for (size_t i = 0; i < count; ++i)
+	{
+		error = max (error, (double)fabs (tx[i] - ex[i]));
+		error = max (error, (double)fabs (ty[i] - ey[i]));
+		error = max (error, (double)fabs (tz[i] - ez[i]));
+	}
+	report ("transformPoints (x, y, z)", kernel, scalar, count * repeat, error);
+}
+
+/**
+  * The affine kernels must agree with glTranslate: T(5, 6, 7) moves
+  * (1, 2, 3) to (6, 8, 10), leaves directions alone, and its
+  * affineInverse moves the point back.
+  */
+bool checkAffineLayout (void)
+{
+	math::Matrixf t;
+	t.data ()[12] = 5.0f;
+	t.data ()[13] = 6.0f;
+	t.data ()[14] = 7.0f;
+
+	math::vec3f points[5];
+	for (int i = 0; i < 5; ++i)
+	{
+		points[i] = math::vec3f (1.0f, 2.0f, 3.0f);
+	}
+	float x[5] = { 1, 1, 1, 1, 1 }, y[5] = { 2, 2, 2, 2, 2 }, z[5] = { 3, 3, 3, 3, 3 };
+	float dx[5], dy[5], dz[5];
+
+	math::transformPoints (t, points, points, 5);
+	math::transformDirections (t, x, y, z, dx, dy, dz, 5);
+	math::transformPoints (t, x, y, z, x, y, z, 5);
+
+	bool ok = true;
+	for (int i = 0; i < 5; ++i)
+	{
+		ok = ok && points[i][0] == 6.0f && points[i][1] == 8.0f && points[i][2] == 10.0f;
+		ok = ok && x[i] == 6.0f && y[i] == 8.0f && z[i] == 10.0f;
+		ok = ok && dx[i] == 1.0f && dy[i] == 2.0f && dz[i] == 3.0f;
+	}
+
+	math::transformPoints (math::affineInverse (t), points, points, 5);
+	for (int i = 0; i < 5; ++i)
+	{
+		ok = ok && points[i][0] == 1.0f && points[i][1] == 2.0f && points[i][2] == 3.0f;
+	}
+
+	printf ("affine layout (GL translation): %s\n", ok ? "ok" : "FAILED");
+	return ok;
+}
+
+}
+
+int main (int argc, char **argv)
+{
+	size_t count = argc > 1 ? (size_t)atol (argv[1]) : 100000;
+	int repeat = argc > 2 ? atoi (argv[2]) : 20;
+
+#ifdef MATH_USE_SSE
+	printf ("math kernels: SSE\n");
+#else
+	printf ("math kernels: scalar\n");
+#endif
+
+	if (!checkAffineLayout ())
+	{
+		return 1;
+	}
+
+	srand (1);
+	benchmarkVectors <3> (count, repeat);
+	benchmarkVectors <4> (count, repeat);
+	benchmarkMatrices (count, repeat);
+
+	return 0;
+}
@@ -0,0 +1,403 @@
+/*
+   Filename : objgen.cpp
+   Version  : 1.0
+
+   Purpose  : Generates synthetic .obj/.mtl assets of arbitrary size for
+              benchmarking the mesh loaders.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace std;
+
+namespace
+{
+
+/**
+  * Attribute layout of the generated faces.
+  */
+enum Layout
+{
+	LAYOUT_V,		// f v v v
+	LAYOUT_VT,		// f v/vt v/vt v/vt
+	LAYOUT_VN,		// f v//vn v//vn v//vn
+	LAYOUT_VTVN		// f v/vt/vn v/vt/vn v/vt/vn
+};
+
+struct Options
+{
+	Options (void)
+	{
+		triangles = 1000;
+		layout    = LAYOUT_VTVN;
+		materials = 1;
+		textures  = 0;
+		soup      = false;
+	}
+
+	unsigned long long triangles;	// Number of triangles to emit.
+	Layout layout;					// Face attribute layout.
+	unsigned int materials;			// Number of materials to split the faces across.
+	unsigned int textures;			// Number of distinct map_Kd images referenced by the materials.
+	bool soup;						// Emit three unique vertices per triangle instead of a welded grid.
+	string output;					// Path to the .obj file.
+};
+
+void usage (const char *program)
+{
+	fprintf (stderr,
+	         "usage: %s [options] output.obj\n"
+	         "  -t <count>   number of triangles (default 1000)\n"
+	         "  -a <layout>  face attributes: v, vt, vn or vtvn (default vtvn)\n"
+	         "  -m <count>   number of materials (default 1)\n"
+	         "  -x <count>   number of distinct textures referenced by map_Kd (default 0)\n"
+	         "  -s           write a triangle soup (no shared vertices)\n",
+	         program);
+	exit (1);
+}
+
+bool parseLayout (const char *value, Layout &layout)
+{
+	if      (!strcmp (value, "v"))    layout = LAYOUT_V;
+	else if (!strcmp (value, "vt"))   layout = LAYOUT_VT;
+	else if (!strcmp (value, "vn"))   layout = LAYOUT_VN;
+	else if (!strcmp (value, "vtvn")) layout = LAYOUT_VTVN;
+	else return false;
+
+	return true;
+}
+
+/**
+  * Strip the directory and extension from a path.
+  */
+string baseName (const string &path)
+{
+	size_t slash = path.find_last_of ("/");
+	string name = (slash == string::npos) ? path : path.substr (slash + 1);
+	size_t dot = name.find_last_of (".");
+	return (dot == string::npos) ? name : name.substr (0, dot);
+}
+
+string directoryOf (const string &path)
+{
+	return path.substr (0, path.find_last_of ("/") + 1);
+}
+
+void writeLittleEndian (FILE *file, unsigned int value, int bytes)
+{
+	for (int i = 0; i < bytes; ++i)
+	{
+		fputc ((value >> (8 * i)) & 0xff, file);
+	}
+}
+
+/**
+  * Write a small 24-bit checkerboard BMP so that map_Kd references resolve.
+  */
+bool writeCheckerBMP (const string &filename, unsigned int seed)
+{
+	const int size = 64;
+	const int row_bytes = size * 3;
+	FILE *file = fopen (filename.c_str (), "wb");
+	if (!file)
+	{
+		return false;
+	}
+
+	fputc ('B', file);
+	fputc ('M', file);
+	writeLittleEndian (file, 54 + row_bytes * size, 4);
+	writeLittleEndian (file, 0, 4);
+	writeLittleEndian (file, 54, 4);
+	writeLittleEndian (file, 40, 4);
+	writeLittleEndian (file, size, 4);
+	writeLittleEndian (file, size, 4);
+	writeLittleEndian (file, 1, 2);
+	writeLittleEndian (file, 24, 2);
+	writeLittleEndian (file, 0, 4);
+	writeLittleEndian (file, row_bytes * size, 4);
+	writeLittleEndian (file, 2835, 4);
+	writeLittleEndian (file, 2835, 4);
+	writeLittleEndian (file, 0, 4);
+	writeLittleEndian (file, 0, 4);
+
+	unsigned char tint = (unsigned char)((seed * 97) & 0xff);
+	for (int y = 0; y < size; ++y)
+	{
+		for (int x = 0; x < size; ++x)
+		{
+			bool on = ((x / 8) + (y / 8)) & 1;
+			fputc (on ? 255 : tint, file);
+			fputc (on ? 255 : 64, file);
+			fputc (on ? 255 : (unsigned char)(255 - tint), file);
+		}
+	}
+
+	fclose (file);
+	return true;
+}
+
+bool writeMaterials (const Options &options, const string &mtl_path)
+{
+	FILE *file = fopen (mtl_path.c_str (), "w");
+	if (!file)
+	{
+		return false;
+	}
+
+	string dir = directoryOf (options.output);
+	string base = baseName (options.output);
+
+	for (unsigned int i = 0; i < options.textures; ++i)
+	{
+		char name[256];
+		snprintf (name, sizeof (name), "%s_tex%u.bmp", base.c_str (), i);
+		if (!writeCheckerBMP (dir + name, i))
+		{
+			fclose (file);
+			return false;
+		}
+	}
+
+	for (unsigned int i = 0; i < options.materials; ++i)
+	{
+		float shade = (float)(i + 1) / (float)options.materials;
+		fprintf (file, "newmtl mat%u\n", i);
+		fprintf (file, "Ns 32\n");
+		fprintf (file, "Ka 0 0 0\n");
+		fprintf (file, "Kd %g %g %g\n", shade, 1.0f - shade, 0.5f);
+		fprintf (file, "Ks 0.5 0.5 0.5\n");
+		fprintf (file, "Ni 1\n");
+		fprintf (file, "d 1\n");
+		fprintf (file, "illum 2\n");
+
+		if (options.textures)
+		{
+			fprintf (file, "map_Kd %s_tex%u.bmp\n", base.c_str (), i % options.textures);
+		}
+
+		fprintf (file, "\n");
+	}
+
+	fclose (file);
+	return true;
+}
+
+/**
+  * Height field used to give the grid some curvature so normals and
+  * tangents are not all identical.
+  */
+inline double height (double u, double v)
+{
+	return 0.1 * sin (u * 6.2831853 * 4.0) * cos (v * 6.2831853 * 4.0);
+}
+
+inline void writeFaceCorner (FILE *file, Layout layout, unsigned long long v, unsigned long long vt, unsigned long long vn)
+{
+	switch (layout)
+	{
+		case LAYOUT_V:    fprintf (file, " %llu", v); break;
+		case LAYOUT_VT:   fprintf (file, " %llu/%llu", v, vt); break;
+		case LAYOUT_VN:   fprintf (file, " %llu//%llu", v, vn); break;
+		case LAYOUT_VTVN: fprintf (file, " %llu/%llu/%llu", v, vt, vn); break;
+	}
+}
+
+/**
+  * Write the vertex attributes of one grid point.
+  */
+void writeVertex (FILE *file, Layout layout, double u, double v)
+{
+	fprintf (file, "v %.6f %.6f %.6f\n", u * 2.0 - 1.0, height (u, v), v * 2.0 - 1.0);
+
+	if (layout == LAYOUT_VT || layout == LAYOUT_VTVN)
+	{
+		fprintf (file, "vt %.6f %.6f\n", u, v);
+	}
+
+	if (layout == LAYOUT_VN || layout == LAYOUT_VTVN)
+	{
+		const double e = 1.0e-3;
+		double dx = (height (u + e, v) - height (u - e, v)) / (4.0 * e);
+		double dz = (height (u, v + e) - height (u, v - e)) / (4.0 * e);
+		double length = sqrt (dx * dx + 1.0 + dz * dz);
+		fprintf (file, "vn %.6f %.6f %.6f\n", -dx / length, 1.0 / length, -dz / length);
+	}
+}
+
+bool writeOBJ (const Options &options, const string &mtl_name)
+{
+	FILE *file = fopen (options.output.c_str (), "w");
+	if (!file)
+	{
+		return false;
+	}
+
+	static char buffer[1 << 20];
+	setvbuf (file, buffer, _IOFBF, sizeof (buffer));
+
+	fprintf (file, "# objgen: %llu triangles, %u materials, %u textures%s\n",
+	         options.triangles, options.materials, options.textures, options.soup ? ", soup" : "");
+	fprintf (file, "mtllib %s\n", mtl_name.c_str ());
+	fprintf (file, "o generated\n");
+
+	// Lay the triangles out on a roughly square grid of quads.
+	unsigned long long quads = (options.triangles + 1) / 2;
+	unsigned long long cols = (unsigned long long)ceil (sqrt ((double)quads));
+	if (cols == 0)
+	{
+		cols = 1;
+	}
+	unsigned long long rows = (quads + cols - 1) / cols;
+
+	if (options.soup)
+	{
+		// Every triangle owns its three vertices, so the attribute index
+		// of corner k of triangle t is simply 3t + k + 1.
+		for (unsigned long long t = 0; t < options.triangles; ++t)
+		{
+			unsigned long long quad = t / 2;
+			double u0 = (double)(quad % cols) / cols, u1 = (double)(quad % cols + 1) / cols;
+			double v0 = (double)(quad / cols) / rows, v1 = (double)(quad / cols + 1) / rows;
+
+			if (t & 1)
+			{
+				writeVertex (file, options.layout, u1, v0);
+				writeVertex (file, options.layout, u1, v1);
+				writeVertex (file, options.layout, u0, v1);
+			}
+			else
+			{
+				writeVertex (file, options.layout, u0, v0);
+				writeVertex (file, options.layout, u1, v0);
+				writeVertex (file, options.layout, u0, v1);
+			}
+		}
+	}
+	else
+	{
+		for (unsigned long long r = 0; r <= rows; ++r)
+		{
+			for (unsigned long long c = 0; c <= cols; ++c)
+			{
+				writeVertex (file, options.layout, (double)c / cols, (double)r / rows);
+			}
+		}
+	}
+
+	unsigned long long per_material = (options.triangles + options.materials - 1) / options.materials;
+	for (unsigned long long t = 0; t < options.triangles; ++t)
+	{
+		if (t % per_material == 0)
+		{
+			fprintf (file, "usemtl mat%llu\n", t / per_material);
+		}
+
+		unsigned long long corners[3];
+		if (options.soup)
+		{
+			corners[0] = 3 * t + 1;
+			corners[1] = 3 * t + 2;
+			corners[2] = 3 * t + 3;
+		}
+		else
+		{
+			unsigned long long quad = t / 2;
+			unsigned long long r = quad / cols, c = quad % cols;
+			unsigned long long i00 = r * (cols + 1) + c + 1;
+			unsigned long long i10 = i00 + 1;
+			unsigned long long i01 = i00 + cols + 1;
+			unsigned long long i11 = i01 + 1;
+
+			corners[0] = (t & 1) ? i10 : i00;
+			corners[1] = (t & 1) ? i11 : i10;
+			corners[2] = i01;
+		}
+
+		fprintf (file, "f");
+		for (int k = 0; k < 3; ++k)
+		{
+			writeFaceCorner (file, options.layout, corners[k], corners[k], corners[k]);
+		}
+		fprintf (file, "\n");
+	}
+
+	fclose (file);
+	return true;
+}
+
+}
+
+int main (int argc, char **argv)
+{
+	Options options;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		string arg = argv[i];
+		if (arg == "-t" && i + 1 < argc)
+		{
+			options.triangles = strtoull (argv[++i], NULL, 10);
+		}
+		else if (arg == "-a" && i + 1 < argc)
+		{
+			if (!parseLayout (argv[++i], options.layout))
+			{
+				usage (argv[0]);
+			}
+		}
+		else if (arg == "-m" && i + 1 < argc)
+		{
+			options.materials = (unsigned int)atoi (argv[++i]);
+		}
+		else if (arg == "-x" && i + 1 < argc)
+		{
+			options.textures = (unsigned int)atoi (argv[++i]);
+		}
+		else if (arg == "-s")
+		{
+			options.soup = true;
+		}
+		else if (arg[0] != '-' && options.output.empty ())
+		{
+			options.output = arg;
+		}
+		else
+		{
+			usage (argv[0]);
+		}
+	}
+
+	if (options.output.empty () || options.triangles == 0)
+	{
+		usage (argv[0]);
+	}
+
+	if (options.materials == 0)
+	{
+		options.materials = 1;
+	}
+
+	string mtl_name = baseName (options.output) + ".mtl";
+	if (!writeMaterials (options, directoryOf (options.output) + mtl_name))
+	{
+		fprintf (stderr, "objgen: Error: Could not write the material file for %s\n", options.output.c_str ());
+		return 1;
+	}
+
+	if (!writeOBJ (options, mtl_name))
+	{
+		fprintf (stderr, "objgen: Error: Could not write %s\n", options.output.c_str ());
+		return 1;
+	}
+
+	return 0;
+}
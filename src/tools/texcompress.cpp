@@ -0,0 +1,169 @@
+/*
+   Filename : texcompress.cpp
+   Version  : 1.0
+
+   Purpose  : Encodes images into the block-compressed DDS files that
+              Texture::load () caches, or the tile files VirtualTexture
+              streams from, ahead of the first run, and reports the time
+              taken and the memory saved.
+
+   Change List:
+
+      - 10/18/2026  - Created
+*/
+
+#include <Texture.h>
+#include <VirtualTexture.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+using namespace std;
+
+namespace
+{
+
+double now (void)
+{
+	timeval tv;
+	gettimeofday (&tv, NULL);
+	return tv.tv_sec + tv.tv_usec * 1.0e-6;
+}
+
+void usage (const char *program)
+{
+	fprintf (stderr,
+	         "usage: %s [-a] [-f box|kaiser|lanczos] [-o dir] [-t] image [image ...]\n"
+	         "  -a         encode as BC3, keeping alpha (default BC1)\n"
+	         "  -f <name>  filter to build the mipmap chain with (default box)\n"
+	         "  -o <dir>   write the DDS files to dir rather than next to the images\n"
+	         "  -t         cut the images into tile files for VirtualTexture instead\n",
+	         program);
+	exit (1);
+}
+
+}
+
+int main (int argc, char **argv)
+{
+	gfx::Texture::Params params;
+	params.compressedFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	vector <const char *> files;
+	bool tiles = false;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		string arg = argv[i];
+		if (arg == "-a")
+		{
+			params.internalFormat = GL_RGBA8;
+			params.compressedFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		}
+		else if (arg == "-f" && i + 1 < argc)
+		{
+			string filter = argv[++i];
+			if (filter == "box")
+			{
+				params.mipmapFilter = gfx::mipmap::BOX;
+			}
+			else if (filter == "kaiser")
+			{
+				params.mipmapFilter = gfx::mipmap::KAISER;
+			}
+			else if (filter == "lanczos")
+			{
+				params.mipmapFilter = gfx::mipmap::LANCZOS;
+			}
+			else
+			{
+				usage (argv[0]);
+			}
+		}
+		else if (arg == "-t")
+		{
+			tiles = true;
+		}
+		else if (arg == "-o" && i + 1 < argc)
+		{
+			gfx::Texture::setCacheDirectory (argv[++i]);
+		}
+		else if (arg[0] != '-')
+		{
+			files.push_back (argv[i]);
+		}
+		else
+		{
+			usage (argv[0]);
+		}
+	}
+
+	if (files.empty ())
+	{
+		usage (argv[0]);
+	}
+
+	int failures = 0;
+	for (size_t i = 0; i < files.size () && tiles; ++i)
+	{
+		string tile_name = gfx::VirtualTexture::getTileFileName (files[i]);
+		double start = now ();
+		gfx::VirtualTexture texture;
+		try
+		{
+			gfx::VirtualTexture::build (files[i], tile_name, 120, 4, params.mipmapFilter);
+			texture.open (tile_name);
+		}
+		catch (runtime_error &error)
+		{
+			fprintf (stderr, "%s", error.what ());
+			++failures;
+			continue;
+		}
+		double seconds = now () - start;
+
+		struct stat file;
+		stat (tile_name.c_str (), &file);
+		printf ("%-40s %5dx%-5d %8.3f s  %2d levels  %8.2f MB\n",
+		        files[i], texture.width (), texture.height (), seconds,
+		        texture.getLevelCount (), file.st_size / 1048576.0);
+	}
+
+	for (size_t i = 0; i < files.size () && !tiles; ++i)
+	{
+		gfx::Texture texture;
+		texture.setParams (params);
+		double start = now ();
+		try
+		{
+			texture.load (files[i]);
+		}
+		catch (runtime_error &error)
+		{
+			fprintf (stderr, "%s", error.what ());
+			++failures;
+			continue;
+		}
+		double seconds = now () - start;
+
+		// Compare against the BGRA chain the texture would otherwise use.
+		string cache_name = texture.getCacheName (files[i]);
+		struct stat cache;
+		if (stat (cache_name.c_str (), &cache) != 0)
+		{
+			fprintf (stderr, "%s: could not write \"%s\"\n", files[i], cache_name.c_str ());
+			++failures;
+			continue;
+		}
+		double uncompressed = texture.width () * (double)texture.height () * 4.0 * 4.0 / 3.0;
+		printf ("%-40s %5dx%-5d %8.3f s  %8.2f MB -> %6.2f MB (%.1fx)\n",
+		        files[i], texture.width (), texture.height (), seconds,
+		        uncompressed / 1048576.0, cache.st_size / 1048576.0, uncompressed / cache.st_size);
+	}
+
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,89 @@
+#include <ThreadPool.h>
+
+using namespace std;
+
+namespace util
+{
+
+namespace
+{
+
+thread_local bool worker = false;
+
+}
+
+ThreadPool::ThreadPool(unsigned int count)
+	: _stopping(false)
+{
+	if (count == 0)
+	{
+		unsigned int hardware = thread::hardware_concurrency();
+		count = hardware > 1 ? hardware - 1 : 1;
+	}
+
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		_workers.push_back(thread(&ThreadPool::run, this));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		lock_guard<mutex> lock(_mutex);
+		_stopping = true;
+	}
+	_wake.notify_all();
+
+	for (size_t i = 0; i < _workers.size(); ++i)
+	{
+		_workers[i].join();
+	}
+}
+
+future<void> ThreadPool::submit(function<void()> job)
+{
+	packaged_task<void()> task(job);
+	future<void> result = task.get_future();
+	{
+		lock_guard<mutex> lock(_mutex);
+		_jobs.push_back(move(task));
+	}
+	_wake.notify_one();
+	return result;
+}
+
+unsigned int ThreadPool::size() const
+{
+	return (unsigned int)_workers.size();
+}
+
+bool ThreadPool::isWorker()
+{
+	return worker;
+}
+
+void ThreadPool::run()
+{
+	worker = true;
+	for (;;)
+	{
+		packaged_task<void()> task;
+		{
+			unique_lock<mutex> lock(_mutex);
+			while (!_stopping && _jobs.empty())
+			{
+				_wake.wait(lock);
+			}
+			if (_jobs.empty())
+			{
+				return;
+			}
+			task = move(_jobs.front());
+			_jobs.pop_front();
+		}
+		task();
+	}
+}
+
+}
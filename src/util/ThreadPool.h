@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util
+{
+
+/**
+ * Fixed set of worker threads running queued jobs in submission order.
+ */
+class ThreadPool
+{
+public:
+	/**
+	 * Start count workers, or one per hardware thread (less the caller's)
+	 * when count is 0.
+	 */
+	explicit ThreadPool(unsigned int count = 0);
+
+	/**
+	 * Finish the queued jobs and join the workers.
+	 */
+	~ThreadPool();
+
+	/**
+	 * Queue a job.  The future becomes ready when it has run, and rethrows
+	 * anything it threw.
+	 */
+	std::future<void> submit(std::function<void()> job);
+
+	/**
+	 * Number of worker threads.
+	 */
+	unsigned int size() const;
+
+	/**
+	 * Returns whether the calling thread is a worker of any pool.  Its
+	 * pool already keeps the hardware threads busy, so a job should not
+	 * start threads of its own.
+	 */
+	static bool isWorker();
+
+private:
+	ThreadPool(const ThreadPool&);
+	ThreadPool& operator=(const ThreadPool&);
+
+	void run();
+
+	std::vector<std::thread> _workers;
+	std::deque<std::packaged_task<void()> > _jobs;
+	std::mutex _mutex;
+	std::condition_variable _wake;
+	bool _stopping;
+};
+
+}